@@ -1,12 +1,15 @@
 #include "DataFlashFileReader.h"
 #include <AP_Filesystem/AP_Filesystem.h>
 
+#include <errno.h>
 #include <fcntl.h>
 #include <string.h>
 #include <sys/types.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <time.h>
+#include <stdlib.h>
+#include <sys/stat.h>
 #include <cinttypes>
 
 #ifndef PRIu64
@@ -19,6 +22,8 @@ AP_LoggerFileReader::AP_LoggerFileReader()
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+    free(log_data);
+    free(log_msg_ofs);
 }
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
@@ -30,6 +35,104 @@ bool AP_LoggerFileReader::open_log(const char *logfile)
     return true;
 }
 
+/*
+  load the complete log into memory and find the start of each
+  message. This allows the same log to be replayed by several
+  processes (see Replay --sweep) with only a single read and framing
+  pass over the file
+ */
+bool AP_LoggerFileReader::load_log(const char *logfile)
+{
+    struct stat st;
+    if (AP::FS().stat(logfile, &st) != 0 || st.st_size <= 0) {
+        return false;
+    }
+    if (uint64_t(st.st_size) > UINT32_MAX) {
+        // offsets into the in-memory copy are 32 bit
+        errno = EFBIG;
+        return false;
+    }
+    if (!open_log(logfile)) {
+        return false;
+    }
+    log_data = (uint8_t *)malloc(st.st_size);
+    if (log_data == nullptr) {
+        AP::FS().close(fd);
+        fd = -1;
+        return false;
+    }
+    uint32_t ofs = 0;
+    while (ofs < (uint32_t)st.st_size) {
+        const int32_t n = AP::FS().read(fd, &log_data[ofs], st.st_size - ofs);
+        if (n <= 0) {
+            break;
+        }
+        ofs += n;
+    }
+    AP::FS().close(fd);
+    fd = -1;
+    if (ofs != (uint32_t)st.st_size) {
+        // a short read would silently drop the end of the log
+        ::printf("Short read of log: %u of %u bytes\n", unsigned(ofs), unsigned(st.st_size));
+        errno = EIO;
+        return false;
+    }
+    log_data_len = ofs;
+    return index_log();
+}
+
+/*
+  find the offset of each message of the in-memory log. As when
+  reading from a file, the log ends at a bad header or a truncated
+  message
+ */
+bool AP_LoggerFileReader::index_log()
+{
+    uint8_t lengths[LOGREADER_MAX_FORMATS+1] {};
+    uint32_t space = 0;
+    uint32_t ofs = 0;
+    log_msg_count = 0;
+    log_msg_next = 0;
+    while (log_data_len - ofs >= 3) {
+        const uint8_t *hdr = &log_data[ofs];
+        if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+            printf("bad log header\n");
+            break;
+        }
+        uint32_t length;
+        if (hdr[2] == LOG_FORMAT_MSG) {
+            length = sizeof(struct log_Format);
+            if (log_data_len - ofs >= length) {
+                struct log_Format f;
+                memcpy(&f, hdr, sizeof(f));
+                lengths[f.type] = f.length;
+            }
+        } else {
+            length = lengths[hdr[2]];
+            if (length < 3) {
+                ::printf("No format defined for type (%d)\n", hdr[2]);
+                errno = EINVAL;
+                return false;
+            }
+        }
+        if (log_data_len - ofs < length) {
+            break;
+        }
+        if (log_msg_count == space) {
+            space = MAX(space * 2, 4096U);
+            uint32_t *new_ofs = (uint32_t *)realloc(log_msg_ofs, space * sizeof(uint32_t));
+            if (new_ofs == nullptr) {
+                errno = ENOMEM;
+                return false;
+            }
+            log_msg_ofs = new_ofs;
+        }
+        log_msg_ofs[log_msg_count++] = ofs;
+        ofs += length;
+    }
+    return true;
+}
+
 ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
     uint64_t ret = AP::FS().read(fd, buffer, count);
@@ -51,8 +154,39 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
     memcpy(dest, packet_counts, sizeof(packet_counts));
 }
 
+/*
+  pass the next message of the in-memory log to the handlers. The
+  messages were framed by load_log(), so they are used in place
+ */
+bool AP_LoggerFileReader::update_from_index()
+{
+    if (log_msg_next >= log_msg_count) {
+        return false;
+    }
+    const uint32_t ofs = log_msg_ofs[log_msg_next++];
+    uint8_t *msg = &log_data[ofs];
+    packet_counts[msg[2]]++;
+    message_count++;
+
+    if (msg[2] == LOG_FORMAT_MSG) {
+        struct log_Format f;
+        memcpy(&f, msg, sizeof(f));
+        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        bytes_read += sizeof(f);
+        return handle_log_format_msg(f);
+    }
+
+    const struct log_Format &f = formats[msg[2]];
+    bytes_read += f.length;
+    return handle_msg(f, msg);
+}
+
 bool AP_LoggerFileReader::update()
 {
+    if (log_data != nullptr) {
+        return update_from_index();
+    }
+
     uint8_t hdr[3];
     if (read_input(hdr, 3) != 3) {
         return false;
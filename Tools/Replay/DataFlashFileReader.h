@@ -12,6 +12,9 @@ public:
     ~AP_LoggerFileReader();
 
     bool open_log(const char *logfile);
+    // read the whole log into memory and split it into messages, so
+    // it can be replayed without further filesystem access or framing
+    bool load_log(const char *logfile);
     bool update();
 
     virtual bool handle_log_format_msg(const struct log_Format &f) = 0;
@@ -27,6 +30,16 @@ protected:
 
 private:
     ssize_t read_input(void *buf, size_t count);
+    bool index_log();
+    bool update_from_index();
+
+    // in-memory copy of the log and the offset of each message in it,
+    // if load_log() was used
+    uint8_t *log_data = nullptr;
+    uint32_t log_data_len = 0;
+    uint32_t *log_msg_ofs = nullptr;
+    uint32_t log_msg_count = 0;
+    uint32_t log_msg_next = 0;
 
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
@@ -39,6 +39,10 @@ void LR_MsgHandler_RFRF::process_message(uint8_t *msgbytes)
     }
 #undef MAP_FLAG
     AP::dal().handle_message(msg, ekf2, ekf3);
+    if (replay_innovation_stats.enabled() &&
+        (msg.frame_types & uint8_t(AP_DAL::FrameType::UpdateFilterEKF3))) {
+        replay_innovation_stats.update(ekf3);
+    }
 }
 
 void LR_MsgHandler_RFRN::process_message(uint8_t *msgbytes)
@@ -20,6 +20,13 @@
 #include <stdio.h>
 #include <AP_HAL/utility/getopt_cpp.h>
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include <AP_Vehicle/AP_Vehicle.h>
 
 #include <GCS_MAVLink/GCS_Dummy.h>
@@ -38,6 +45,7 @@ static ReplayVehicle replayvehicle;
 user_parameter *user_parameters;
 bool replay_force_ekf2;
 bool replay_force_ekf3;
+ReplayInnovationStats replay_innovation_stats;
 
 #define GSCALAR(v, name, def) { replayvehicle.g.v.vtype, name, Parameters::k_param_ ## v, &replayvehicle.g.v, {def_value : def} }
 #define GOBJECT(v, name, class) { AP_PARAM_GROUP, name, Parameters::k_param_ ## v, &replayvehicle.v, {group_info : class::var_info} }
@@ -131,11 +139,17 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    ::printf("\t--sweep FILENAME  replay once per line of NAME=VALUE parameter sets\n");
+    ::printf("\t--jobs N  number of parallel replays for --sweep\n");
+#endif
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    SWEEP,
+    JOBS,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -147,6 +161,8 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"sweep",           true,   0, param_key::SWEEP},
+        {"jobs",            true,   0, param_key::JOBS},
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -182,6 +198,21 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             replay_force_ekf3 = true;
             break;
 
+        case param_key::SWEEP:
+            sweep_filename = gopt.optarg;
+            break;
+
+        case param_key::JOBS: {
+            char *endptr = nullptr;
+            const long jobs = strtol(gopt.optarg, &endptr, 10);
+            if (endptr == gopt.optarg || *endptr != 0 || jobs <= 0 || jobs > UINT16_MAX) {
+                ::printf("Bad --jobs value %s\n", gopt.optarg);
+                exit(1);
+            }
+            sweep_jobs = jobs;
+            break;
+        }
+
         case 'h':
         default:
             usage();
@@ -210,6 +241,11 @@ void Replay::setup()
         _parse_command_line(argc, argv);
     }
 
+    if (sweep_filename != nullptr) {
+        // returns only in the child processes
+        run_sweep();
+    }
+
     _vehicle.setup();
 
     set_user_parameters();
@@ -236,7 +272,7 @@ void Replay::setup()
 #endif
     }
     // LogReader reader = LogReader(log_structure);
-    if (!reader.open_log(filename)) {
+    if (!in_sweep && !reader.open_log(filename)) {
         ::printf("open(%s): %m\n", filename);
         exit(1);
     }
@@ -245,6 +281,9 @@ void Replay::setup()
 void Replay::loop()
 {
     if (!reader.update()) {
+        if (in_sweep) {
+            replay_innovation_stats.print(sweep_set);
+        }
 #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     // If we don't tear down the threads then they continue to access
     // global state during object destruction.
@@ -320,6 +359,213 @@ void Replay::load_param_file(const char *pfilename)
     fclose(f);
 }
 
+/*
+  parse one line of a sweep file, adding its NAME=VALUE pairs to the
+  user parameters. Returns false for blank and comment lines
+ */
+bool Replay::parse_sweep_line(char *line)
+{
+    if (line[0] == '#') {
+        return false;
+    }
+    bool found = false;
+    char *saveptr = nullptr;
+    for (char *tok = strtok_r(line, " ,\t\r\n", &saveptr);
+         tok != nullptr;
+         tok = strtok_r(nullptr, " ,\t\r\n", &saveptr)) {
+        const char *eq = strchr(tok, '=');
+        if (eq == nullptr || eq - tok > AP_MAX_NAME_SIZE) {
+            ::printf("Bad sweep entry %s\n", tok);
+            exit(1);
+        }
+        struct user_parameter *u = new user_parameter;
+        memset(u->name, 0, sizeof(u->name));
+        strncpy(u->name, tok, eq-tok);
+        u->value = atof(eq+1);
+        u->next = user_parameters;
+        user_parameters = u;
+        found = true;
+    }
+    return found;
+}
+
+/*
+  run a parameter sweep. The log is read into memory once, then a
+  child process is forked for each line of the sweep file, with at
+  most sweep_jobs running at a time. Each child works in its own
+  sweepNNN directory so logs and storage do not collide, and prints
+  the innovation statistics for its parameter set on completion. The
+  log is split into messages before forking, so the children share
+  one copy of it and of the message offsets. Exits with status 1 if
+  any set failed
+ */
+void Replay::run_sweep(void)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    if (filename == nullptr) {
+        ::printf("You must supply a log filename\n");
+        exit(1);
+    }
+    if (!reader.load_log(filename)) {
+        ::printf("load(%s): %m\n", filename);
+        exit(1);
+    }
+    FILE *f = fopen(sweep_filename, "r");
+    if (f == nullptr) {
+        ::printf("Failed to open sweep file: %s\n", sweep_filename);
+        exit(1);
+    }
+    if (sweep_jobs == 0) {
+        sweep_jobs = MAX(sysconf(_SC_NPROCESSORS_ONLN), 1);
+    }
+    sweep_child *children = new sweep_child[sweep_jobs];
+    if (children == nullptr) {
+        ::printf("Out of memory for %u sweep jobs\n", unsigned(sweep_jobs));
+        exit(1);
+    }
+
+    char line[1024];
+    uint32_t line_number = 0;
+    uint16_t set_number = 0;
+    uint16_t running = 0;
+    uint16_t failed = 0;
+    fflush(stdout);
+    while (fgets(line, sizeof(line), f)) {
+        line_number++;
+        if (strchr(line, '\n') == nullptr && !feof(f)) {
+            // don't split a long line into two parameter sets
+            ::printf("Sweep file line %u too long\n", unsigned(line_number));
+            exit(1);
+        }
+        char *line_copy = strdup(line);
+        if (line_copy == nullptr) {
+            ::printf("Out of memory for sweep line\n");
+            exit(1);
+        }
+        const bool empty = (strtok(line_copy, " ,\t\r\n") == nullptr) || line_copy[0] == '#';
+        free(line_copy);
+        if (empty) {
+            continue;
+        }
+        if (set_number == UINT16_MAX) {
+            ::printf("Too many sweep sets\n");
+            exit(1);
+        }
+        if (running >= sweep_jobs && !wait_sweep_child(children, running)) {
+            failed++;
+        }
+        const pid_t pid = fork();
+        if (pid == -1) {
+            ::printf("fork failed: %m\n");
+            exit(1);
+        }
+        if (pid == 0) {
+            fclose(f);
+            delete[] children;
+            parse_sweep_line(line);
+            char dirname[16];
+            snprintf(dirname, sizeof(dirname), "sweep%03u", set_number);
+            mkdir(dirname, 0755);
+            if (chdir(dirname) != 0) {
+                ::printf("chdir(%s): %m\n", dirname);
+                exit(1);
+            }
+            in_sweep = true;
+            sweep_set = set_number;
+            replay_innovation_stats.enable();
+            return;
+        }
+        children[running].pid = pid;
+        children[running].set_number = set_number;
+        running++;
+        set_number++;
+    }
+    if (ferror(f)) {
+        ::printf("Failed to read sweep file: %s\n", sweep_filename);
+        exit(1);
+    }
+    fclose(f);
+    while (running > 0) {
+        if (!wait_sweep_child(children, running)) {
+            failed++;
+        }
+    }
+    delete[] children;
+    if (failed > 0) {
+        ::printf("SWEEP: %u of %u sets failed\n", unsigned(failed), unsigned(set_number));
+        exit(1);
+    }
+    exit(0);
+#else
+    ::printf("--sweep is only supported on SITL\n");
+    exit(1);
+#endif
+}
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+/*
+  wait for one sweep child to finish, reporting it if it failed.
+  Returns false if the child failed
+ */
+bool Replay::wait_sweep_child(sweep_child *children, uint16_t &running)
+{
+    int status = 0;
+    pid_t pid;
+    while ((pid = wait(&status)) == -1) {
+        if (errno != EINTR) {
+            ::printf("wait failed: %m\n");
+            exit(1);
+        }
+    }
+    uint16_t set_number = 0;
+    for (uint16_t i=0; i<running; i++) {
+        if (children[i].pid == pid) {
+            set_number = children[i].set_number;
+            children[i] = children[--running];
+            break;
+        }
+    }
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        return true;
+    }
+    if (WIFSIGNALED(status)) {
+        ::printf("SWEEP %u: killed by signal %d\n", unsigned(set_number), WTERMSIG(status));
+    } else {
+        ::printf("SWEEP %u: failed with exit status %d\n", unsigned(set_number), WEXITSTATUS(status));
+    }
+    fflush(stdout);
+    return false;
+}
+#endif
+
+void ReplayInnovationStats::update(const NavEKF3 &ekf3)
+{
+    float ratio[NUM_RATIOS] {};
+    Vector3f mag_var;
+    Vector2f offset;
+    ekf3.getVariances(-1, ratio[VEL], ratio[POS], ratio[HGT], mag_var, ratio[TAS], offset);
+    ratio[MAG] = mag_var.length();
+    for (uint8_t i=0; i<NUM_RATIOS; i++) {
+        sum_sq[i] += sq(ratio[i]);
+        max_ratio[i] = MAX(max_ratio[i], ratio[i]);
+    }
+    count++;
+}
+
+void ReplayInnovationStats::print(uint16_t set_number) const
+{
+    static const char *names[NUM_RATIOS] { "vel", "pos", "hgt", "mag", "tas" };
+    char buf[256];
+    int ofs = snprintf(buf, sizeof(buf), "SWEEP %u: frames=%u", set_number, count);
+    for (uint8_t i=0; i<NUM_RATIOS && ofs < (int)sizeof(buf); i++) {
+        const float rms = count>0 ? sqrtf(sum_sq[i] / count) : 0;
+        ofs += snprintf(&buf[ofs], sizeof(buf)-ofs, " %s=%.4f/%.4f", names[i], rms, max_ratio[i]);
+    }
+    // a single write per set so output from parallel children is not interleaved
+    ::printf("%s\n", buf);
+    fflush(stdout);
+}
+
 Replay replay(replayvehicle);
 AP_Vehicle& vehicle = replayvehicle;
 
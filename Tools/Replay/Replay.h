@@ -27,6 +27,36 @@ extern user_parameter *user_parameters;
 extern bool replay_force_ekf2;
 extern bool replay_force_ekf3;
 
+/*
+  accumulated EKF3 innovation test ratios, used to compare the
+  parameter sets of a --sweep run
+ */
+class ReplayInnovationStats {
+public:
+    // only gathered in the children of a --sweep run
+    void enable() { _enabled = true; }
+    bool enabled() const { return _enabled; }
+
+    void update(const NavEKF3 &ekf3);
+    void print(uint16_t set_number) const;
+
+private:
+    bool _enabled;
+    enum {
+        VEL = 0,
+        POS,
+        HGT,
+        MAG,
+        TAS,
+        NUM_RATIOS
+    };
+    uint32_t count;
+    float sum_sq[NUM_RATIOS];
+    float max_ratio[NUM_RATIOS];
+};
+
+extern ReplayInnovationStats replay_innovation_stats;
+
 class ReplayVehicle : public AP_Vehicle {
 public:
     friend class Replay;
@@ -84,6 +114,21 @@ private:
     const char *filename;
     ReplayVehicle &_vehicle;
 
+    // parameter sweep: each line of the sweep file is replayed in its
+    // own process against a single in-memory copy of the log
+    const char *sweep_filename;
+    uint16_t sweep_jobs;
+    // set number of this process, if it is a sweep child
+    bool in_sweep;
+    uint16_t sweep_set;
+    void run_sweep(void);
+    struct sweep_child {
+        pid_t pid;
+        uint16_t set_number;
+    };
+    bool wait_sweep_child(sweep_child *children, uint16_t &running);
+    bool parse_sweep_line(char *line);
+
     LogReader reader{_vehicle.log_structure, _vehicle.ekf2, _vehicle.ekf3};
 
     void _parse_command_line(uint8_t argc, char * const argv[]);
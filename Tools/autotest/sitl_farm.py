@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+
+'''
+Run many SITL instances in parallel, each pinned to its own CPU and
+running free of the wall clock, and report the simulated seconds each
+achieves per wall clock second
+
+e.g. to run 8 copters for 600 simulated seconds each:
+  ./Tools/autotest/sitl_farm.py build/sitl/bin/arducopter -n 8 --sim-time 600 \
+      --defaults Tools/autotest/default_params/copter.parm
+
+AP_FLAKE8_CLEAN
+'''
+
+import optparse
+import os
+import re
+import select
+import shlex
+import subprocess
+import sys
+import time
+
+SPEEDUP_RE = re.compile(r'SITL speedup: sim=([0-9.]+)s wall=([0-9.]+)s speedup=([0-9.]+) last=([0-9.]+)')
+
+
+def parse_cpu_list(cpus):
+    '''parse a cpu list such as "0-3,6" into a list of cpu numbers'''
+    ret = []
+    for part in cpus.split(','):
+        if '-' in part:
+            (first, last) = part.split('-')
+            ret.extend(range(int(first), int(last)+1))
+        else:
+            ret.append(int(part))
+    return ret
+
+
+class Instance(object):
+    def __init__(self, index, cpu, cmd, workdir):
+        self.index = index
+        self.cpu = cpu
+        self.cmd = cmd
+        self.workdir = workdir
+        self.process = None
+        self.logfile = None
+        self.partial = ""
+        self.sim_s = 0.0
+        self.wall_s = 0.0
+        self.speedup = 0.0
+        self.last = 0.0
+        self.returncode = None
+
+    def start(self):
+        if not os.path.exists(self.workdir):
+            os.makedirs(self.workdir)
+        self.logfile = open(os.path.join(self.workdir, "sitl.log"), "w")
+        cpu = self.cpu
+
+        def pin():
+            if cpu is not None:
+                os.sched_setaffinity(0, [cpu])
+
+        self.process = subprocess.Popen(self.cmd,
+                                        cwd=self.workdir,
+                                        stdin=subprocess.DEVNULL,
+                                        stdout=subprocess.PIPE,
+                                        stderr=subprocess.STDOUT,
+                                        close_fds=True,
+                                        preexec_fn=pin)
+
+    def fileno(self):
+        return self.process.stdout.fileno()
+
+    def read(self):
+        '''read available output, returning False at EOF'''
+        data = os.read(self.fileno(), 65536)
+        if len(data) == 0:
+            return False
+        text = data.decode('utf-8', 'replace')
+        self.logfile.write(text)
+        lines = (self.partial + text).split('\n')
+        self.partial = lines.pop()
+        for line in lines:
+            m = SPEEDUP_RE.search(line)
+            if m is not None:
+                (self.sim_s, self.wall_s, self.speedup, self.last) = [float(x) for x in m.groups()]
+        return True
+
+    def stop(self):
+        if self.process.poll() is None:
+            self.process.terminate()
+            try:
+                self.process.wait(5)
+            except subprocess.TimeoutExpired:
+                self.process.kill()
+                self.process.wait()
+        self.returncode = self.process.returncode
+        self.logfile.close()
+
+
+class SITLFarm(object):
+    def __init__(self, opts, binary, extra_args):
+        self.opts = opts
+        cpus = parse_cpu_list(opts.cpus) if opts.cpus else sorted(os.sched_getaffinity(0))
+        self.instances = []
+        for i in range(opts.instances):
+            cpu = cpus[i % len(cpus)] if opts.pin else None
+            cmd = [
+                binary,
+                "--model", opts.model,
+                "-I", str(opts.base_instance + i),
+                "--free-run",
+                "--speedup-report", str(opts.report_interval),
+                "--start-time", str(opts.start_time),
+                "--uartA", "tcp:0",
+            ]
+            if opts.max_speed:
+                cmd.append("--max-speed")
+            if opts.home is not None:
+                cmd.extend(["--home", opts.home])
+            if opts.defaults is not None:
+                cmd.extend(["--defaults", os.path.abspath(opts.defaults)])
+            if opts.wipe:
+                cmd.append("-w")
+            cmd.extend(extra_args)
+            workdir = os.path.join(opts.workdir, "instance%u" % i)
+            self.instances.append(Instance(i, cpu, cmd, workdir))
+
+    def progress(self, message):
+        print("PROGRESS: %s" % (message,))
+
+    def print_table(self):
+        print("%-8s %-4s %10s %10s %8s %8s" % ("Instance", "CPU", "Sim(s)", "Wall(s)", "Speedup", "Last"))
+        total_sim = 0.0
+        max_wall = 0.0
+        for inst in self.instances:
+            print("%-8u %-4s %10.1f %10.1f %8.2f %8.2f" % (
+                inst.index,
+                "-" if inst.cpu is None else str(inst.cpu),
+                inst.sim_s, inst.wall_s, inst.speedup, inst.last))
+            total_sim += inst.sim_s
+            max_wall = max(max_wall, inst.wall_s)
+        if max_wall > 0:
+            print("Farm throughput: %.1f simulated seconds per wall second" % (total_sim / max_wall))
+
+    def run(self):
+        for inst in self.instances:
+            self.progress("Starting instance %u on CPU %s: %s" % (
+                inst.index, inst.cpu, " ".join(shlex.quote(x) for x in inst.cmd)))
+            inst.start()
+
+        start = time.time()
+        last_table = start
+        running = list(self.instances)
+        try:
+            while len(running) > 0:
+                (readable, _, _) = select.select(running, [], [], 1.0)
+                for inst in readable:
+                    if not inst.read() or (self.opts.sim_time and inst.sim_s >= self.opts.sim_time):
+                        inst.stop()
+                        running.remove(inst)
+                now = time.time()
+                if self.opts.duration and now - start >= self.opts.duration:
+                    break
+                if now - last_table >= self.opts.table_interval:
+                    self.print_table()
+                    last_table = now
+        except KeyboardInterrupt:
+            self.progress("Interrupted")
+        for inst in running:
+            inst.stop()
+
+        self.print_table()
+
+        failed = [inst for inst in self.instances
+                  if inst.returncode not in (0, -15) or inst.sim_s == 0]
+        for inst in failed:
+            self.progress("Instance %u failed (returncode %s), see %s" % (
+                inst.index, inst.returncode, os.path.join(inst.workdir, "sitl.log")))
+        return len(failed) == 0
+
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser(
+        "sitl_farm.py [options] SITL_BINARY [-- extra SITL arguments]")
+    parser.add_option("-n", "--instances", type='int', default=os.cpu_count(),
+                      help="number of instances to run")
+    parser.add_option("--base-instance", type='int', default=0,
+                      help="SITL instance number of the first instance, sets its ports")
+    parser.add_option("--model", default="quad", help="simulation model")
+    parser.add_option("--defaults", default=None, help="defaults file for all instances")
+    parser.add_option("--home", default=None, help="start location")
+    parser.add_option("--start-time", type='int', default=1577836800,
+                      help="simulated UNIX start time, fixed for repeatable runs")
+    parser.add_option("--cpus", default=None,
+                      help="CPUs to pin instances to, e.g. 0-3,6 (default all available)")
+    parser.add_option("--no-pin", dest='pin', action='store_false', default=True,
+                      help="do not pin instances to CPUs")
+    parser.add_option("--sim-time", type='float', default=0,
+                      help="stop each instance after this many simulated seconds")
+    parser.add_option("--duration", type='float', default=0,
+                      help="stop all instances after this many wall clock seconds")
+    parser.add_option("--report-interval", type='float', default=1.0,
+                      help="wall clock seconds between speedup reports from each instance")
+    parser.add_option("--table-interval", type='float', default=10.0,
+                      help="wall clock seconds between progress tables")
+    parser.add_option("--workdir", default="sitl_farm",
+                      help="directory for per-instance working directories and logs")
+    parser.add_option("--max-speed", action='store_true', default=False,
+                      help="run instances headless with all threads stepped on simulated time")
+    parser.add_option("--wipe", action='store_true', default=False,
+                      help="wipe parameters of each instance on start")
+
+    (opts, args) = parser.parse_args()
+    if len(args) < 1:
+        parser.print_help()
+        sys.exit(1)
+    if opts.sim_time == 0 and opts.duration == 0:
+        print("One of --sim-time or --duration is needed")
+        sys.exit(1)
+
+    farm = SITLFarm(opts, os.path.abspath(args[0]), args[1:])
+    sys.exit(0 if farm.run() else 1)
@@ -3,11 +3,12 @@
 unpack a param.pck file from @PARAM/param.pck via mavlink FTP
 '''
 
-import struct, sys
+import struct, sys, zlib
 
 from argparse import ArgumentParser
 parser = ArgumentParser(description=__doc__)
 parser.add_argument("file", metavar="LOG")
+parser.add_argument("--hash", action='store_true', help="print the CRC of the parameter set as given by @PARAM/param.hash")
 
 args = parser.parse_args()
 
@@ -41,6 +42,7 @@ if sys.version_info.major < 3:
     pad_byte = chr(0)
 
 count = 0
+crc = 0xFFFFFFFF
 
 while True:
     # skip pad bytes
@@ -66,10 +68,14 @@ while True:
     last_name = name
     data = data[2+name_len+type_len:]
     v, = struct.unpack("<" + type_format, vdata)
+    crc = zlib.crc32(name.encode('utf-8') + struct.pack("<BB", 0, ptype) + vdata, crc)
     count += 1
     print("%-16s %f" % (name, float(v)))
 
 if count != num_params or count > total_params:
     print("Error: Got %u params expected %u/%u" % (count, num_params, total_params))
     sys.exit(1)
+if args.hash:
+    # zlib applies an initial and final inversion that param.hash does not
+    print("CRC 0x%08x" % (crc ^ 0xFFFFFFFF))
 sys.exit(0)
@@ -62,12 +62,18 @@ bool AC_CASS_HYT271::_measure()
 bool AC_CASS_HYT271::_collect(float &hum, float &temp)
 {
     uint8_t data[4];
-    int16_t raw;
     // Read sensors
     if (!_dev->transfer(nullptr, 0, data, sizeof(data))) {
         return false;
     }
 
+    return _convert(data, hum, temp);
+}
+
+bool AC_CASS_HYT271::_convert(uint8_t data[4], float &hum, float &temp)
+{
+    int16_t raw;
+
     // Verify data with the checksum
     if ((data[0] & 0x40) == 0x40){
         return false;
@@ -89,6 +95,20 @@ bool AC_CASS_HYT271::_collect(float &hum, float &temp)
 
 void AC_CASS_HYT271::_timer(void)
 {
-    _healthy = _collect(_humidity, _temperature);   // Retreive data from the sensor
-    _measure();                                     // Request a new measurement to the sensor
+    // Retreive data from the sensor and request a new measurement in one transaction
+    uint8_t data[4];
+    const uint8_t cmd = 0x00;
+    const AP_HAL::I2CDevice::Segment segments[] {
+        { nullptr, data, sizeof(data) },
+        { &cmd, nullptr, sizeof(cmd) },
+    };
+    if (_dev->transfer_batch(segments, ARRAY_SIZE(segments))) {
+        _healthy = _convert(data, _humidity, _temperature);
+        return;
+    }
+
+    // Only retry the read. The measurement request may already have
+    // reached the sensor, and a second one would restart the conversion.
+    // The next batch requests a measurement anyway
+    _healthy = _collect(_humidity, _temperature);
 }
\ No newline at end of file
@@ -27,5 +27,6 @@ private:
     bool _healthy; // we have a valid temperature reading to report
     bool _measure(void);
     bool _collect(float &hum, float &temp);
+    bool _convert(uint8_t data[4], float &hum, float &temp);
     void _timer(void); // update the temperature, called at 20Hz
 };
\ No newline at end of file
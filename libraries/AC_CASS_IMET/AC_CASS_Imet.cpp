@@ -115,6 +115,22 @@ bool AC_CASS_Imet::_read_adc(float &value)
     uint8_t status[2];
     uint8_t data[2];
 
+    // The conversion has normally finished by the time we get here, so read
+    // the status and the result in one transaction and only poll if it hasn't
+    const uint8_t config_reg = ADS1115_REG_POINTER_CONFIG;
+    const uint8_t convert_reg = ADS1115_REG_POINTER_CONVERT;
+    const AP_HAL::I2CDevice::Segment segments[] {
+        { &config_reg, nullptr, sizeof(config_reg) },
+        { nullptr, status, sizeof(status) },
+        { &convert_reg, nullptr, sizeof(convert_reg) },
+        { nullptr, data, sizeof(data) },
+    };
+    if (_dev->transfer_batch(segments, ARRAY_SIZE(segments)) &&
+        (status[0] & ADS1115_REG_CONFIG_OS_MASK) != ADS1115_REG_CONFIG_OS_BUSY) {
+        value = (float)((data[0] << 8) | data[1]);
+        return true;
+    }
+
     // Check if ADC is ready to deliver, timeout if it takes too long
     uint32_t now = AP_HAL::millis();
     uint8_t cmd = ADS1115_REG_POINTER_CONFIG;   // Config. reg. address
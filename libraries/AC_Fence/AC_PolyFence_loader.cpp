@@ -178,6 +178,33 @@ bool AC_PolyFence_loader::load_point_from_eeprom(uint16_t i, Vector2l& point) co
     return true;
 }
 
+// meters per 1e-7 degree of latitude and longitude at loc
+static Vector2f meters_per_latlon_unit(const Location &loc)
+{
+    Location ref = loc;
+    ref.lat += 1;
+    ref.lng += 1;
+    return loc.get_distance_NE(ref);
+}
+
+// bounding box of count points
+static void bounding_box(const Vector2l *points, uint8_t count, Vector2l &min_lla, Vector2l &max_lla)
+{
+    min_lla = max_lla = points[0];
+    for (uint8_t i=1; i<count; i++) {
+        min_lla.x = MIN(min_lla.x, points[i].x);
+        min_lla.y = MIN(min_lla.y, points[i].y);
+        max_lla.x = MAX(max_lla.x, points[i].x);
+        max_lla.y = MAX(max_lla.y, points[i].y);
+    }
+}
+
+static bool in_bounding_box(const Vector2l &pos, const Vector2l &min_lla, const Vector2l &max_lla)
+{
+    return pos.x >= min_lla.x && pos.x <= max_lla.x &&
+        pos.y >= min_lla.y && pos.y <= max_lla.y;
+}
+
 bool AC_PolyFence_loader::breached() const
 {
     struct Location loc;
@@ -203,27 +230,30 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
     // check we are inside each inclusion zone:
     for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
         const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
-        if (Polygon_outside(pos, boundary.points_lla, boundary.count)) {
+        if (!in_bounding_box(pos, boundary.min_lla, boundary.max_lla) ||
+            Polygon_outside(pos, boundary.points_lla, boundary.count)) {
             return true;
         }
     }
 
     // check we are outside each exclusion zone:
-    for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
-        const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
-        if (!Polygon_outside(pos, boundary.points_lla, boundary.count)) {
-            return true;
+    if (_exclusion_grid_start != nullptr) {
+        // only the zones overlapping our cell; outside the grid there
+        // are no exclusion zones
+        uint16_t cell;
+        if (exclusion_grid_cell(pos, cell)) {
+            for (uint16_t i=_exclusion_grid_start[cell]; i<_exclusion_grid_start[cell+1]; i++) {
+                if (exclusion_zone_contains(_exclusion_grid_zones[i], loc, pos)) {
+                    return true;
+                }
+            }
         }
-    }
-
-    for (uint8_t i=0; i<_num_loaded_circle_exclusion_boundaries; i++) {
-        const ExclusionCircle &circle = _loaded_circle_exclusion_boundary[i];
-        Location circle_center;
-        circle_center.lat = circle.point.x;
-        circle_center.lng = circle.point.y;
-        const float diff_cm = loc.get_distance(circle_center)*100.0f;
-        if (diff_cm < circle.radius * 100.0f) {
-            return true;
+    } else {
+        const uint16_t num_zones = _num_loaded_exclusion_boundaries + _num_loaded_circle_exclusion_boundaries;
+        for (uint16_t i=0; i<num_zones; i++) {
+            if (exclusion_zone_contains(i, loc, pos)) {
+                return true;
+            }
         }
     }
 
@@ -242,6 +272,149 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
     return false;
 }
 
+void AC_PolyFence_loader::exclusion_zone_bounds(uint16_t zone, Vector2l &min_lla, Vector2l &max_lla) const
+{
+    if (zone < _num_loaded_exclusion_boundaries) {
+        const ExclusionBoundary &boundary = _loaded_exclusion_boundary[zone];
+        min_lla = boundary.min_lla;
+        max_lla = boundary.max_lla;
+        return;
+    }
+    const ExclusionCircle &circle = _loaded_circle_exclusion_boundary[zone - _num_loaded_exclusion_boundaries];
+    Location circle_center;
+    circle_center.lat = circle.point.x;
+    circle_center.lng = circle.point.y;
+    // pad the box so rounding can't leave part of the circle outside it
+    const Vector2f scale = meters_per_latlon_unit(circle_center);
+    const int32_t half_lat = circle.radius * 1.01f / scale.x + 1;
+    const int32_t half_lng = circle.radius * 1.01f / scale.y + 1;
+    min_lla = Vector2l(circle.point.x - half_lat, circle.point.y - half_lng);
+    max_lla = Vector2l(circle.point.x + half_lat, circle.point.y + half_lng);
+}
+
+bool AC_PolyFence_loader::exclusion_zone_contains(uint16_t zone, const Location &loc, const Vector2l &pos) const
+{
+    if (zone < _num_loaded_exclusion_boundaries) {
+        const ExclusionBoundary &boundary = _loaded_exclusion_boundary[zone];
+        return in_bounding_box(pos, boundary.min_lla, boundary.max_lla) &&
+            !Polygon_outside(pos, boundary.points_lla, boundary.count);
+    }
+    const ExclusionCircle &circle = _loaded_circle_exclusion_boundary[zone - _num_loaded_exclusion_boundaries];
+    Location circle_center;
+    circle_center.lat = circle.point.x;
+    circle_center.lng = circle.point.y;
+    const float diff_cm = loc.get_distance(circle_center)*100.0f;
+    return diff_cm < circle.radius * 100.0f;
+}
+
+bool AC_PolyFence_loader::exclusion_grid_cell(const Vector2l &pos, uint16_t &cell) const
+{
+    if (pos.x < _exclusion_grid_min.x || pos.y < _exclusion_grid_min.y) {
+        return false;
+    }
+    // 64 bit so longitudes far apart can't overflow
+    const int64_t x = (int64_t(pos.x) - _exclusion_grid_min.x) / _exclusion_grid_cell.x;
+    const int64_t y = (int64_t(pos.y) - _exclusion_grid_min.y) / _exclusion_grid_cell.y;
+    if (x >= _exclusion_grid_size || y >= _exclusion_grid_size) {
+        return false;
+    }
+    cell = x * _exclusion_grid_size + y;
+    return true;
+}
+
+void AC_PolyFence_loader::index_exclusion_zones()
+{
+    const uint16_t num_zones = _num_loaded_exclusion_boundaries + _num_loaded_circle_exclusion_boundaries;
+    if (num_zones < AC_POLYFENCE_GRID_MIN_ZONES) {
+        // few enough to test them all
+        return;
+    }
+
+    // the grid covers the bounding boxes of all zones
+    Vector2l min_lla, max_lla;
+    exclusion_zone_bounds(0, min_lla, max_lla);
+    for (uint16_t z=1; z<num_zones; z++) {
+        Vector2l zmin, zmax;
+        exclusion_zone_bounds(z, zmin, zmax);
+        min_lla.x = MIN(min_lla.x, zmin.x);
+        min_lla.y = MIN(min_lla.y, zmin.y);
+        max_lla.x = MAX(max_lla.x, zmax.x);
+        max_lla.y = MAX(max_lla.y, zmax.y);
+    }
+
+    // about two cells per zone along each side
+    const uint8_t size = constrain_int16(2 * sqrtf(num_zones), 1, AC_POLYFENCE_GRID_MAX_SIZE);
+    _exclusion_grid_min = min_lla;
+    _exclusion_grid_cell.x = (int64_t(max_lla.x) - min_lla.x) / size + 1;
+    _exclusion_grid_cell.y = (int64_t(max_lla.y) - min_lla.y) / size + 1;
+    _exclusion_grid_size = size;
+
+    const uint16_t num_cells = size * size;
+    uint16_t *start = new uint16_t[num_cells+1];
+    if (start == nullptr) {
+        return;
+    }
+
+    // count the zones overlapping each cell into start[cell+1]
+    uint32_t total = 0;
+    for (uint16_t z=0; z<num_zones; z++) {
+        Vector2l zmin, zmax;
+        exclusion_zone_bounds(z, zmin, zmax);
+        uint16_t cmin, cmax;
+        if (!exclusion_grid_cell(zmin, cmin) || !exclusion_grid_cell(zmax, cmax)) {
+            INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
+            delete[] start;
+            return;
+        }
+        for (uint16_t x=cmin/size; x<=cmax/size; x++) {
+            for (uint16_t y=cmin%size; y<=cmax%size; y++) {
+                start[x*size+y+1]++;
+                total++;
+            }
+        }
+    }
+    if (total > AC_POLYFENCE_GRID_MAX_ENTRIES) {
+        // zones overlap too much for a grid to help
+        delete[] start;
+        return;
+    }
+    for (uint16_t c=0; c<num_cells; c++) {
+        start[c+1] += start[c];
+    }
+
+    uint16_t *zones = new uint16_t[total];
+    if (zones == nullptr) {
+        delete[] start;
+        return;
+    }
+
+    // fill each cell, using start[cell] as the fill position.  This
+    // leaves start[cell] at the beginning of the next cell, so shift
+    // it back afterwards
+    for (uint16_t z=0; z<num_zones; z++) {
+        Vector2l zmin, zmax;
+        exclusion_zone_bounds(z, zmin, zmax);
+        uint16_t cmin, cmax;
+        if (!exclusion_grid_cell(zmin, cmin) || !exclusion_grid_cell(zmax, cmax)) {
+            continue;
+        }
+        for (uint16_t x=cmin/size; x<=cmax/size; x++) {
+            for (uint16_t y=cmin%size; y<=cmax%size; y++) {
+                zones[start[x*size+y]++] = z;
+            }
+        }
+    }
+    for (uint16_t c=num_cells; c>0; c--) {
+        start[c] = start[c-1];
+    }
+    start[0] = 0;
+
+    _exclusion_grid_start = start;
+    _exclusion_grid_zones = zones;
+    Debug("Fence: %u exclusion zones in %ux%u grid, %u entries",
+          (unsigned)num_zones, (unsigned)size, (unsigned)size, (unsigned)total);
+}
+
 bool AC_PolyFence_loader::formatted() const
 {
     return (fence_storage.read_uint8(0) == new_fence_storage_magic &&
@@ -560,6 +733,11 @@ void AC_PolyFence_loader::unload()
     _loaded_circle_exclusion_boundary = nullptr;
     _num_loaded_circle_exclusion_boundaries = 0;
 
+    delete[] _exclusion_grid_start;
+    _exclusion_grid_start = nullptr;
+    delete[] _exclusion_grid_zones;
+    _exclusion_grid_zones = nullptr;
+
     _loaded_return_point = nullptr;
     _loaded_return_point_lla = nullptr;
     _load_time_ms = 0;
@@ -618,6 +796,19 @@ bool AC_PolyFence_loader::load_from_eeprom()
         return false;
     }
 
+    return load_from_eeprom(ekf_origin);
+}
+
+bool AC_PolyFence_loader::load_from_eeprom(const Location &ekf_origin)
+{
+    if (!check_indexed()) {
+        return false;
+    }
+
+    if (_load_attempted) {
+        return _load_time_ms != 0;
+    }
+
     // find indexes of each fence:
     if (!get_loaded_fence_semaphore().take_nonblocking()) {
         return false;
@@ -732,6 +923,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
+            bounding_box(boundary.points_lla, boundary.count, boundary.min_lla, boundary.max_lla);
             _num_loaded_inclusion_boundaries++;
             break;
         }
@@ -751,6 +943,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
+            bounding_box(boundary.points_lla, boundary.count, boundary.min_lla, boundary.max_lla);
             _num_loaded_exclusion_boundaries++;
             break;
         }
@@ -834,6 +1027,8 @@ bool AC_PolyFence_loader::load_from_eeprom()
         return false;
     }
 
+    index_exclusion_zones();
+
     _load_time_ms = AP_HAL::millis();
 
     get_loaded_fence_semaphore().give();
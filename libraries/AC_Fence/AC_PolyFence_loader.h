@@ -7,6 +7,14 @@
 
 #define AC_POLYFENCE_FENCE_POINT_PROTOCOL_SUPPORT 1
 
+// exclusion zones are only indexed in a grid when there are at least
+// this many of them
+#define AC_POLYFENCE_GRID_MIN_ZONES 8
+// maximum number of cells along each side of the exclusion zone grid
+#define AC_POLYFENCE_GRID_MAX_SIZE 16
+// maximum number of zone entries in the exclusion zone grid
+#define AC_POLYFENCE_GRID_MAX_ENTRIES 2048
+
 enum class AC_PolyFenceType {
     END_OF_STORAGE    = 99,
     POLYGON_INCLUSION = 98,
@@ -152,6 +160,8 @@ public:
     // _loaded_offsets_from_origin and perform validation.  returns
     // true if load successfully completed
     bool load_from_eeprom() WARN_IF_UNUSED;
+    // as above, with the offsets taken from the supplied EKF origin
+    bool load_from_eeprom(const Location &ekf_origin) WARN_IF_UNUSED;
 
     // allow threads to lock against AHRS update
     HAL_Semaphore &get_loaded_fence_semaphore(void) {
@@ -273,6 +283,8 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla array
         uint8_t count; // count of points in the boundary
+        Vector2l min_lla; // south-west corner of the bounding box of points_lla
+        Vector2l max_lla; // north-east corner of the bounding box of points_lla
     };
     InclusionBoundary *_loaded_inclusion_boundary;
 
@@ -283,6 +295,8 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla_lla array
         uint8_t count; // count of points in the boundary
+        Vector2l min_lla; // south-west corner of the bounding box of points_lla
+        Vector2l max_lla; // north-east corner of the bounding box of points_lla
     };
     ExclusionBoundary *_loaded_exclusion_boundary;
 
@@ -315,6 +329,33 @@ private:
 
     uint8_t _num_loaded_circle_inclusion_boundaries;
 
+    /*
+     * Exclusion zone index - a uniform grid over the exclusion
+     * polygons and circles, so breached() only tests the zones whose
+     * bounding boxes overlap the cell containing the vehicle.  Zones
+     * are numbered with the polygons first, then the circles
+     */
+    // index_exclusion_zones - build the grid from the loaded
+    // exclusion zones.  The grid is left empty if there are too few
+    // zones or it would be too large, in which case every zone is
+    // tested
+    void index_exclusion_zones();
+    // exclusion_zone_bounds - fills in the lat/lng bounding box of a zone
+    void exclusion_zone_bounds(uint16_t zone, Vector2l &min_lla, Vector2l &max_lla) const;
+    // exclusion_zone_contains - returns true if loc (pos in lat/lng) is inside a zone
+    bool exclusion_zone_contains(uint16_t zone, const Location &loc, const Vector2l &pos) const WARN_IF_UNUSED;
+    // exclusion_grid_cell - returns the grid cell for a lat/lng,
+    // false if it is outside the grid
+    bool exclusion_grid_cell(const Vector2l &pos, uint16_t &cell) const WARN_IF_UNUSED;
+
+    Vector2l _exclusion_grid_min;  // south-west corner of the grid
+    Vector2l _exclusion_grid_cell; // size of a grid cell
+    uint8_t _exclusion_grid_size;  // cells along each side of the grid
+    // index into _exclusion_grid_zones of the first zone for each
+    // cell, with one extra entry for the end of the last cell
+    uint16_t *_exclusion_grid_start;
+    uint16_t *_exclusion_grid_zones;
+
     // _load_attempted - true if we have attempted to load the fences
     // from storage into _loaded_circle_exclusion_boundary,
     // _loaded_offsets_from_origin etc etc
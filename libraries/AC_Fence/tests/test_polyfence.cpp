@@ -0,0 +1,194 @@
+#include <AP_gtest.h>
+
+#include <AC_Fence/AC_PolyFence_loader.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+static GCS_Dummy _gcs;
+
+// like the fence in a vehicle, the loader relies on zeroed static
+// storage for its initial state
+static AP_Int8 fence_total;
+static AC_PolyFence_loader loader{fence_total};
+
+static const int32_t origin_lat = -353632610;
+static const int32_t origin_lng = 1491652300;
+
+// test offsets from the origin are in 1e-6 degrees, about 0.1m
+static const int32_t unit = 10;
+
+/*
+  a fence described by its upload items
+ */
+class TestFence {
+public:
+    AC_PolyFenceItem items[64];
+    uint16_t count;
+
+    void add_polygon(AC_PolyFenceType type, const int32_t (*points)[2], uint8_t n) {
+        for (uint8_t i=0; i<n; i++) {
+            AC_PolyFenceItem &item = items[count++];
+            item.type = type;
+            item.loc = Vector2l(origin_lat + points[i][0]*unit, origin_lng + points[i][1]*unit);
+            item.vertex_count = n;
+            item.radius = 0;
+        }
+    }
+    void add_triangle(AC_PolyFenceType type, int32_t lat, int32_t lng, int32_t size) {
+        const int32_t points[3][2] { { lat, lng }, { lat, lng + size }, { lat + size, lng + size/2 } };
+        add_polygon(type, points, 3);
+    }
+    void add_circle(AC_PolyFenceType type, int32_t lat, int32_t lng, float radius) {
+        AC_PolyFenceItem &item = items[count++];
+        item.type = type;
+        item.loc = Vector2l(origin_lat + lat*unit, origin_lng + lng*unit);
+        item.vertex_count = 0;
+        item.radius = radius;
+    }
+};
+
+/*
+  the breach test as it was before exclusion zones were indexed,
+  checking every fence
+ */
+static bool breached_brute_force(const TestFence &fence, const Location &loc)
+{
+    const Vector2l pos(loc.lat, loc.lng);
+    for (uint16_t i=0; i<fence.count; ) {
+        const AC_PolyFenceItem &item = fence.items[i];
+        switch (item.type) {
+        case AC_PolyFenceType::POLYGON_INCLUSION:
+        case AC_PolyFenceType::POLYGON_EXCLUSION: {
+            Vector2l points[16];
+            for (uint8_t j=0; j<item.vertex_count; j++) {
+                points[j] = fence.items[i+j].loc;
+            }
+            const bool outside = Polygon_outside(pos, points, item.vertex_count);
+            if (outside == (item.type == AC_PolyFenceType::POLYGON_INCLUSION)) {
+                return true;
+            }
+            i += item.vertex_count;
+            continue;
+        }
+        case AC_PolyFenceType::CIRCLE_INCLUSION:
+        case AC_PolyFenceType::CIRCLE_EXCLUSION: {
+            Location center;
+            center.lat = item.loc.x;
+            center.lng = item.loc.y;
+            const float diff_cm = loc.get_distance(center)*100.0f;
+            const float radius_cm = uint32_t(item.radius) * 100.0f;
+            if (item.type == AC_PolyFenceType::CIRCLE_INCLUSION ? diff_cm > radius_cm : diff_cm < radius_cm) {
+                return true;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        i++;
+    }
+    return false;
+}
+
+static Location test_location(int32_t lat, int32_t lng)
+{
+    Location loc;
+    loc.lat = origin_lat + lat*unit;
+    loc.lng = origin_lng + lng*unit;
+    return loc;
+}
+
+/*
+  upload and load a fence, then compare breached() with the brute
+  force test on a grid of points and on every vertex and edge
+ */
+static void check_fence(const TestFence &fence)
+{
+    ASSERT_TRUE(loader.write_fence(fence.items, fence.count));
+    ASSERT_TRUE(loader.load_from_eeprom(test_location(0, 0)));
+
+    uint32_t num_breached = 0;
+    uint32_t num_points = 0;
+    for (int32_t lat=-1500; lat<=4500; lat+=37) {
+        for (int32_t lng=-1500; lng<=4500; lng+=41) {
+            const Location loc = test_location(lat, lng);
+            const bool breached = breached_brute_force(fence, loc);
+            EXPECT_EQ(loader.breached(loc), breached) << "lat=" << lat << " lng=" << lng;
+            num_breached += breached;
+            num_points++;
+        }
+    }
+    // the fence must give a mix of results to test anything
+    EXPECT_GT(num_breached, num_points / 10);
+    EXPECT_LT(num_breached, num_points * 9 / 10);
+
+    // points on the vertices and edges of polygons, where rounding
+    // in the zone bounds would show up
+    for (uint16_t start=0; start<fence.count; ) {
+        const AC_PolyFenceItem &first = fence.items[start];
+        if (first.type != AC_PolyFenceType::POLYGON_INCLUSION &&
+            first.type != AC_PolyFenceType::POLYGON_EXCLUSION) {
+            start++;
+            continue;
+        }
+        for (uint8_t j=0; j<first.vertex_count; j++) {
+            const Vector2l &a = fence.items[start+j].loc;
+            const Vector2l &b = fence.items[start+(j+1)%first.vertex_count].loc;
+            for (uint8_t k=0; k<4; k++) {
+                Location loc;
+                loc.lat = a.x + (int64_t(b.x) - a.x) * k / 4;
+                loc.lng = a.y + (int64_t(b.y) - a.y) * k / 4;
+                EXPECT_EQ(loader.breached(loc), breached_brute_force(fence, loc))
+                    << "polygon=" << start << " edge=" << unsigned(j) << " k=" << unsigned(k);
+            }
+        }
+        start += first.vertex_count;
+    }
+}
+
+TEST(AC_PolyFence_loader, ExclusionGridMatchesBruteForce)
+{
+    loader.init();
+
+    // a concave inclusion polygon overlapping a rectangular one, with
+    // enough exclusion zones in them to be indexed
+    TestFence fence {};
+    const int32_t u_shape[8][2] {
+        {    0,    0 }, {    0, 3000 }, { 3000, 3000 }, { 3000, 2000 },
+        { 1000, 2000 }, { 1000, 1000 }, { 3000, 1000 }, { 3000,    0 },
+    };
+    fence.add_polygon(AC_PolyFenceType::POLYGON_INCLUSION, u_shape, 8);
+    const int32_t rectangle[4][2] {
+        { -500, -500 }, { -500, 3500 }, { 2500, 3500 }, { 2500, -500 },
+    };
+    fence.add_polygon(AC_PolyFenceType::POLYGON_INCLUSION, rectangle, 4);
+    for (uint8_t i=0; i<6; i++) {
+        fence.add_triangle(AC_PolyFenceType::POLYGON_EXCLUSION, 100 + i*450, 150 + (i%3)*1000, 400);
+    }
+    fence.add_circle(AC_PolyFenceType::CIRCLE_EXCLUSION, 500, 2500, 20);
+    fence.add_circle(AC_PolyFenceType::CIRCLE_EXCLUSION, 2000, 500, 15);
+    fence.add_circle(AC_PolyFenceType::CIRCLE_EXCLUSION, 2800, 2800, 10);
+    check_fence(fence);
+
+    // upload a different fence and check the grid is rebuilt for it
+    TestFence fence2 {};
+    const int32_t l_shape[6][2] {
+        { -1000, -1000 }, { -1000, 4000 }, { 1000, 4000 },
+        {  1000,     0 }, {  4000,    0 }, { 4000, -1000 },
+    };
+    fence2.add_polygon(AC_PolyFenceType::POLYGON_INCLUSION, l_shape, 6);
+    fence2.add_circle(AC_PolyFenceType::CIRCLE_INCLUSION, 1500, 1500, 250);
+    for (uint8_t i=0; i<8; i++) {
+        fence2.add_triangle(AC_PolyFenceType::POLYGON_EXCLUSION, -800 + (i%4)*1200, -800 + (i/4)*1500, 500);
+    }
+    fence2.add_circle(AC_PolyFenceType::CIRCLE_EXCLUSION, 3000, -500, 25);
+    fence2.add_circle(AC_PolyFenceType::CIRCLE_EXCLUSION, 0, 3000, 30);
+    check_fence(fence2);
+}
+
+AP_GTEST_MAIN()
@@ -372,16 +372,30 @@ void AP_ADSB::determine_furthest_aircraft(void)
     float max_distance = 0;
     uint16_t max_distance_index = 0;
 
-    for (uint16_t index = 0; index < in_state.vehicle_count; index++) {
-        if (is_special_vehicle(in_state.vehicle_list[index].info.ICAO_address)) {
-            continue;
+    // work out the distances a chunk of vehicles at a time, so the
+    // longitude scale is only calculated once per chunk
+    const uint8_t chunk_size = 16;
+    Location locs[chunk_size];
+    float distances[chunk_size];
+
+    for (uint16_t start = 0; start < in_state.vehicle_count; start += chunk_size) {
+        const uint16_t count = MIN(uint16_t(in_state.vehicle_count - start), uint16_t(chunk_size));
+        for (uint16_t i = 0; i < count; i++) {
+            locs[i] = get_location(in_state.vehicle_list[start + i]);
         }
-        const float distance = _my_loc.get_distance(get_location(in_state.vehicle_list[index]));
-        if (max_distance < distance || index == 0) {
-            max_distance = distance;
-            max_distance_index = index;
+        _my_loc.get_distance_batch(locs, distances, count);
+
+        for (uint16_t i = 0; i < count; i++) {
+            const uint16_t index = start + i;
+            if (is_special_vehicle(in_state.vehicle_list[index].info.ICAO_address)) {
+                continue;
+            }
+            if (max_distance < distances[i] || index == 0) {
+                max_distance = distances[i];
+                max_distance_index = index;
+            }
         }
-    } // for index
+    }
 
     in_state.furthest_vehicle_index = max_distance_index;
     in_state.furthest_vehicle_distance = max_distance;
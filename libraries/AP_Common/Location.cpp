@@ -252,6 +252,83 @@ void Location::offset(float ofs_north, float ofs_east)
     lng += dlng;
 }
 
+/*
+  batch calculation of N/E distances in meters to an array of locations
+ */
+void Location::get_distance_NE_batch(const Location *locs, Vector2f *ret, uint16_t count) const
+{
+    const float lng_scale = LOCATION_SCALING_FACTOR * longitude_scale();
+    for (uint16_t i=0; i<count; i++) {
+        ret[i].x = (locs[i].lat - lat) * LOCATION_SCALING_FACTOR;
+        ret[i].y = (locs[i].lng - lng) * lng_scale;
+    }
+}
+
+/*
+  longitude scale at a latitude dlat from a point with the given cosine
+  and sine of latitude. The angle sum expansion avoids a cosf() per
+  point, and is within float precision of longitude_scale() for points
+  within 100km
+ */
+static inline float longitude_scale_offset(float cos_lat, float sin_lat, int32_t dlat)
+{
+    const float dlat_rad = dlat * (1.0e-7f * DEG_TO_RAD);
+    const float scale = cos_lat * (1 - 0.5f * sq(dlat_rad)) - sin_lat * dlat_rad;
+    return MAX(scale, 0.01f);
+}
+
+/*
+  batch calculation of distances in meters to an array of locations
+ */
+void Location::get_distance_batch(const Location *locs, float *ret, uint16_t count) const
+{
+    const float lat_rad = lat * (1.0e-7f * DEG_TO_RAD);
+    const float cos_lat = cosf(lat_rad);
+    const float sin_lat = sinf(lat_rad);
+    for (uint16_t i=0; i<count; i++) {
+        // scaled at the far location, as in get_distance()
+        const float lng_scale = longitude_scale_offset(cos_lat, sin_lat, locs[i].lat - lat);
+        const float dlat = (float)(locs[i].lat - lat);
+        const float dlng = ((float)(locs[i].lng - lng)) * lng_scale;
+        ret[i] = sqrtf(sq(dlat) + sq(dlng)) * LOCATION_SCALING_FACTOR;
+    }
+}
+
+/*
+  batch calculation of bearings in centi-degrees to an array of locations
+ */
+void Location::get_bearing_to_batch(const Location *locs, int32_t *ret_cd, uint16_t count) const
+{
+    const float lat_rad = lat * (1.0e-7f * DEG_TO_RAD);
+    const float cos_lat = cosf(lat_rad);
+    const float sin_lat = sinf(lat_rad);
+    for (uint16_t i=0; i<count; i++) {
+        // scaled at the far location, as in get_bearing_to()
+        const float lng_scale = longitude_scale_offset(cos_lat, sin_lat, locs[i].lat - lat);
+        const float off_x = (locs[i].lng - lng) * lng_scale;
+        const float off_y = locs[i].lat - lat;
+        int32_t bearing = 9000 + fast_atan2f(-off_y, off_x) * DEGX100;
+        if (bearing < 0) {
+            bearing += 36000;
+        }
+        ret_cd[i] = bearing;
+    }
+}
+
+/*
+  batch extrapolation of locations given north/east offsets in meters
+  from this location
+ */
+void Location::offset_batch(const Vector2f *ofs_ne, Location *ret, uint16_t count) const
+{
+    const float lng_scale_inv = LOCATION_SCALING_FACTOR_INV / longitude_scale();
+    for (uint16_t i=0; i<count; i++) {
+        ret[i] = *this;
+        ret[i].lat += (int32_t)(ofs_ne[i].x * LOCATION_SCALING_FACTOR_INV);
+        ret[i].lng += (int32_t)(ofs_ne[i].y * lng_scale_inv);
+    }
+}
+
 /*
  *  extrapolate latitude/longitude given bearing and distance
  * Note that this function is accurate to about 1mm at a distance of
@@ -71,6 +71,21 @@ public:
     // extrapolate latitude/longitude given distances (in meters) north and east
     void offset(float ofs_north, float ofs_east);
 
+    /*
+      batch versions of get_distance_NE(), get_distance(),
+      get_bearing_to() and offset() for an array of locations relative
+      to this one. Like the single point functions, distance and
+      bearing scale longitude at each of the locations, and the N/E
+      distance and offset at this one. The trigonometry is only done
+      once for this location, and the bearing uses a polynomial atan2,
+      so results match the single point functions to within 0.001% of
+      the distance and 0.01 degrees of bearing for points within 100km
+     */
+    void get_distance_NE_batch(const Location *locs, Vector2f *ret, uint16_t count) const;
+    void get_distance_batch(const Location *locs, float *ret, uint16_t count) const;
+    void get_bearing_to_batch(const Location *locs, int32_t *ret_cd, uint16_t count) const;
+    void offset_batch(const Vector2f *ofs_ne, Location *ret, uint16_t count) const;
+
     // extrapolate latitude/longitude given bearing and distance
     void offset_bearing(float bearing, float distance);
     
@@ -0,0 +1,75 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/Location.h>
+
+#define NUM_POINTS 256
+
+static void fill_points(const Location &origin, Location *locs)
+{
+    for (uint16_t i = 0; i < NUM_POINTS; i++) {
+        locs[i] = origin;
+        locs[i].lat += (i % 16) * 5000;
+        locs[i].lng += (i / 16) * 7000;
+    }
+}
+
+static const Location origin{-353632610, 1491652370, 0, Location::AltFrame::ABSOLUTE};
+
+static void BM_LocationDistance(benchmark::State& state)
+{
+    Location locs[NUM_POINTS];
+    float dist[NUM_POINTS];
+    fill_points(origin, locs);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < NUM_POINTS; i++) {
+            dist[i] = origin.get_distance(locs[i]);
+        }
+        gbenchmark_escape(dist);
+    }
+}
+
+static void BM_LocationDistanceBatch(benchmark::State& state)
+{
+    Location locs[NUM_POINTS];
+    float dist[NUM_POINTS];
+    fill_points(origin, locs);
+
+    while (state.KeepRunning()) {
+        origin.get_distance_batch(locs, dist, NUM_POINTS);
+        gbenchmark_escape(dist);
+    }
+}
+
+static void BM_LocationBearing(benchmark::State& state)
+{
+    Location locs[NUM_POINTS];
+    int32_t bearing[NUM_POINTS];
+    fill_points(origin, locs);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < NUM_POINTS; i++) {
+            bearing[i] = origin.get_bearing_to(locs[i]);
+        }
+        gbenchmark_escape(bearing);
+    }
+}
+
+static void BM_LocationBearingBatch(benchmark::State& state)
+{
+    Location locs[NUM_POINTS];
+    int32_t bearing[NUM_POINTS];
+    fill_points(origin, locs);
+
+    while (state.KeepRunning()) {
+        origin.get_bearing_to_batch(locs, bearing, NUM_POINTS);
+        gbenchmark_escape(bearing);
+    }
+}
+
+BENCHMARK(BM_LocationDistance);
+BENCHMARK(BM_LocationDistanceBatch);
+BENCHMARK(BM_LocationBearing);
+BENCHMARK(BM_LocationBearingBatch);
+
+BENCHMARK_MAIN();
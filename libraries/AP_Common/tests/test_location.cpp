@@ -0,0 +1,97 @@
+#include <AP_gtest.h>
+
+#include <AP_Common/Location.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const int32_t test_lats[] { 0, -353632610, 450000000, 700000000 };
+
+/*
+  fill an array with points on a 20x20 grid around origin, within about
+  1km for a spacing of 1 and 100km for a spacing of 100
+ */
+static uint16_t fill_test_locations(const Location &origin, Location *locs, int32_t spacing)
+{
+    uint16_t n = 0;
+    for (int32_t i=-10; i<10; i++) {
+        for (int32_t j=-10; j<10; j++) {
+            locs[n] = origin;
+            locs[n].lat += (i * 6000 + 17) * spacing;
+            locs[n].lng += (j * 9000 - 31) * spacing;
+            n++;
+        }
+    }
+    return n;
+}
+
+static const int32_t test_spacings[] { 1, 10, 100 };
+
+TEST(Location, DistanceBatch)
+{
+    Location locs[400];
+    float dist[400];
+    Vector2f ne[400];
+    for (const int32_t lat : test_lats) {
+        for (const int32_t spacing : test_spacings) {
+            const Location origin{lat, 1491652370, 0, Location::AltFrame::ABSOLUTE};
+            const uint16_t n = fill_test_locations(origin, locs, spacing);
+            origin.get_distance_batch(locs, dist, n);
+            origin.get_distance_NE_batch(locs, ne, n);
+            for (uint16_t i=0; i<n; i++) {
+                const float d = origin.get_distance(locs[i]);
+                EXPECT_NEAR(d, dist[i], MAX(d * 1.0e-5, 1.0e-3)) << "spacing=" << spacing;
+                const Vector2f ne1 = origin.get_distance_NE(locs[i]);
+                EXPECT_FLOAT_EQ(ne1.x, ne[i].x);
+                EXPECT_FLOAT_EQ(ne1.y, ne[i].y);
+            }
+        }
+    }
+}
+
+TEST(Location, BearingBatch)
+{
+    Location locs[400];
+    int32_t bearing[400];
+    for (const int32_t lat : test_lats) {
+        for (const int32_t spacing : test_spacings) {
+            const Location origin{lat, 1491652370, 0, Location::AltFrame::ABSOLUTE};
+            const uint16_t n = fill_test_locations(origin, locs, spacing);
+            origin.get_bearing_to_batch(locs, bearing, n);
+            for (uint16_t i=0; i<n; i++) {
+                if (origin.get_distance(locs[i]) < 10) {
+                    // single point bearings are quantised at short range
+                    continue;
+                }
+                int32_t diff = origin.get_bearing_to(locs[i]) - bearing[i];
+                if (diff > 18000) {
+                    diff -= 36000;
+                } else if (diff < -18000) {
+                    diff += 36000;
+                }
+                EXPECT_LE(abs(diff), 1) << "spacing=" << spacing;
+            }
+        }
+    }
+}
+
+TEST(Location, OffsetBatch)
+{
+    Vector2f ofs[400];
+    Location locs[400];
+    for (uint16_t i=0; i<400; i++) {
+        ofs[i] = Vector2f((i % 20) * 500.0f - 5000, (i / 20) * 500.0f - 5000);
+    }
+    for (const int32_t lat : test_lats) {
+        const Location origin{lat, 1491652370, 0, Location::AltFrame::ABSOLUTE};
+        origin.offset_batch(ofs, locs, 400);
+        for (uint16_t i=0; i<400; i++) {
+            Location loc = origin;
+            loc.offset(ofs[i].x, ofs[i].y);
+            EXPECT_EQ(loc.lat, locs[i].lat);
+            // the longitude scale division is done in a different order
+            EXPECT_LE(abs(loc.lng - locs[i].lng), 1);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
@@ -373,10 +373,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
         case Status::NOT_STARTED:
             reset_state();
             _status = Status::NOT_STARTED;
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
             return true;
 
         case Status::WAITING_TO_START:
@@ -398,7 +395,10 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
             if (_sample_buffer == nullptr) {
                 _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
             }
-            if (_sample_buffer != nullptr) {
+            if (_ellipsoid_work == nullptr) {
+                _ellipsoid_work = (EllipsoidFitWork*)calloc(1, sizeof(EllipsoidFitWork));
+            }
+            if (_sample_buffer != nullptr && _ellipsoid_work != nullptr) {
                 initialize_fit();
                 _status = Status::RUNNING_STEP_ONE;
                 return true;
@@ -419,10 +419,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return false;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
 
             _status = Status::SUCCESS;
             return true;
@@ -446,10 +443,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return true;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
 
             _status = status;
             return true;
@@ -459,6 +453,15 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
     };
 }
 
+// free the sample buffer and fit scratch space
+void CompassCalibrator::free_buffers()
+{
+    free(_sample_buffer);
+    _sample_buffer = nullptr;
+    free(_ellipsoid_work);
+    _ellipsoid_work = nullptr;
+}
+
 bool CompassCalibrator::fit_acceptable() const
 {
     if (!isnan(_fitness) &&
@@ -729,7 +732,7 @@ void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param
 
 void CompassCalibrator::run_ellipsoid_fit()
 {
-    if (_sample_buffer == nullptr) {
+    if (_sample_buffer == nullptr || _ellipsoid_work == nullptr) {
         return;
     }
 
@@ -741,8 +744,10 @@ void CompassCalibrator::run_ellipsoid_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+    float *JTJ = _ellipsoid_work->JTJ;
+    float *JTJ2 = _ellipsoid_work->JTJ2;
+    memset(JTJ, 0, sizeof(_ellipsoid_work->JTJ));
+    memset(JTJ2, 0, sizeof(_ellipsoid_work->JTJ2));
     float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
 
     // Gauss Newton Part common for all kind of extensions including LM
@@ -771,11 +776,11 @@ void CompassCalibrator::run_ellipsoid_fit()
         JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda/lma_damping;
     }
 
-    if (!mat_inverse(JTJ, JTJ, 9)) {
+    if (!mat_inverse(JTJ, JTJ, 9, _ellipsoid_work->inverse)) {
         return;
     }
 
-    if (!mat_inverse(JTJ2, JTJ2, 9)) {
+    if (!mat_inverse(JTJ2, JTJ2, 9, _ellipsoid_work->inverse)) {
         return;
     }
 
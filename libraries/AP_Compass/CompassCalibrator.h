@@ -150,6 +150,9 @@ private:
     // clear sample buffer and reset offsets and scaling to their defaults
     void reset_state();
 
+    // free the sample buffer and fit scratch space
+    void free_buffers();
+
     // initialize fitness before starting a fit
     void initialize_fit();
 
@@ -215,7 +218,16 @@ private:
     uint16_t _samples_collected;            // number of samples in buffer
     uint16_t _samples_thinned;              // number of samples removed by the thin_samples() call (called before step 2 begins)
 
+    // scratch space for the ellipsoid fit, allocated with the sample
+    // buffer as it is too large for the calibration thread's stack
+    struct EllipsoidFitWork {
+        float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        float inverse[MAT_INVERSE_WORK_SIZE(COMPASS_CAL_NUM_ELLIPSOID_PARAMS)];
+    };
+
     // fit state
+    EllipsoidFitWork *_ellipsoid_work;      // ellipsoid fit scratch space
     class param_t _params;                  // latest calibration outputs
     uint16_t _fit_step;                     // step during RUNNING_STEP_ONE/TWO which performs sphere fit and ellipsoid fit
     float _fitness;                         // fitness (mean squared residuals) of current parameters
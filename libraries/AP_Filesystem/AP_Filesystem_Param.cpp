@@ -19,9 +19,11 @@
 #include "AP_Filesystem_Param.h"
 #include <AP_Param/AP_Param.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
 #include <ctype.h>
 
 #define PACKED_NAME "param.pck"
+#define HASH_NAME "param.hash"
 
 extern const AP_HAL::HAL& hal;
 extern int errno;
@@ -44,6 +46,27 @@ int AP_Filesystem_Param::open(const char *fname, int flags)
         return -1;
     }
     struct rfile &r = file[idx];
+    if (is_hash_file(fname)) {
+        if (!read_only) {
+            errno = EROFS;
+            return -1;
+        }
+        r.hash = new hash_file;
+        if (r.hash == nullptr) {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (!calculate_hash(*r.hash)) {
+            delete r.hash;
+            r.hash = nullptr;
+            errno = EAGAIN;
+            return -1;
+        }
+        r.file_ofs = 0;
+        r.open = true;
+        r.writebuf = nullptr;
+        return idx;
+    }
     if (read_only) {
         r.cursors = new cursor[num_cursors];
         if (r.cursors == nullptr) {
@@ -120,9 +143,57 @@ int AP_Filesystem_Param::close(int fd)
     r.cursors = nullptr;
     delete r.writebuf;
     r.writebuf = nullptr;
+    delete r.hash;
+    r.hash = nullptr;
     return ret;
 }
 
+/*
+  param.hash holds a CRC32 of the full parameter set, so a GCS with a
+  cached copy of the parameters can skip downloading param.pck when
+  nothing has changed. The CRC covers, for each parameter in order,
+  the name, a zero byte, the type byte and the little-endian value
+  bytes, as unpacked from param.pck
+ */
+bool AP_Filesystem_Param::calculate_hash(struct hash_file &h)
+{
+    AP_Param::ParamToken token {};
+    enum ap_var_type ptype;
+    uint32_t crc = 0;
+    uint16_t count = 0;
+
+    for (AP_Param *ap = AP_Param::first(&token, &ptype);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &ptype)) {
+        char name[AP_MAX_NAME_SIZE+1] {};
+        ap->copy_name_token(token, name, AP_MAX_NAME_SIZE, true);
+        crc = crc_crc32(crc, (const uint8_t *)name, strlen(name)+1);
+        const uint8_t type = ptype;
+        crc = crc_crc32(crc, &type, 1);
+        crc = crc_crc32(crc, (const uint8_t *)ap, AP_Param::type_size(ptype));
+        count++;
+    }
+
+    if (count != AP_Param::count_parameters()) {
+        // parameters were enabled or disabled while we hashed them
+        return false;
+    }
+    h.total_params = count;
+    h.crc = crc;
+    return true;
+}
+
+int32_t AP_Filesystem_Param::read_hash(struct rfile &r, void *buf, uint32_t count)
+{
+    if (r.file_ofs >= sizeof(hash_file)) {
+        return 0;
+    }
+    const uint32_t n = MIN(count, sizeof(hash_file) - r.file_ofs);
+    memcpy(buf, &((const uint8_t *)r.hash)[r.file_ofs], n);
+    r.file_ofs += n;
+    return n;
+}
+
 /*
   packed format:
     file header:
@@ -263,6 +334,9 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
         errno = EINVAL;
         return -1;
     }
+    if (r.hash != nullptr) {
+        return read_hash(r, buf, count);
+    }
     size_t header_total = 0;
 
     /*
@@ -405,6 +479,10 @@ int AP_Filesystem_Param::stat(const char *name, struct stat *stbuf)
         return -1;
     }
     memset(stbuf, 0, sizeof(*stbuf));
+    if (is_hash_file(name)) {
+        stbuf->st_size = sizeof(hash_file);
+        return 0;
+    }
     // give fixed size to avoid needing to scan entire file
     stbuf->st_size = 1024*1024;
     return 0;
@@ -420,7 +498,12 @@ bool AP_Filesystem_Param::check_file_name(const char *name)
         (name[packed_len] == 0 || name[packed_len] == '?')) {
         return true;
     }
-    return false;
+    return is_hash_file(name);
+}
+
+bool AP_Filesystem_Param::is_hash_file(const char *name)
+{
+    return strcmp(name, HASH_NAME) == 0;
 }
 
 /*
@@ -44,6 +44,13 @@ private:
 
     static constexpr uint16_t pmagic = 0x671b;
 
+    // contents of param.hash
+    struct PACKED hash_file {
+        uint16_t magic = pmagic;
+        uint16_t total_params;
+        uint32_t crc;
+    };
+
     // header at front of the file
     struct header {
         uint16_t magic = pmagic;
@@ -69,11 +76,15 @@ private:
         uint32_t file_size;
         struct cursor *cursors;
         ExpandingString *writebuf; // for upload
+        struct hash_file *hash;    // for param.hash
     } file[max_open_file];
 
     bool token_seek(const struct rfile &r, const uint32_t data_ofs, struct cursor &c);
     uint8_t pack_param(const struct rfile &r, struct cursor &c, uint8_t *buf);
     bool check_file_name(const char *fname);
+    bool is_hash_file(const char *fname);
+    bool calculate_hash(struct hash_file &h);
+    int32_t read_hash(struct rfile &r, void *buf, uint32_t count);
 
     // finish uploading parameters
     bool finish_upload(const rfile &r);
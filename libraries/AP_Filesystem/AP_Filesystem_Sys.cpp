@@ -36,6 +36,9 @@ static const SysFileList sysfs_file_list[] = {
     {"dma.txt"},
     {"memory.txt"},
     {"uarts.txt"},
+    {"trace.json"},
+    {"semaphores.txt"},
+    {"storage.txt"},
 #if HAL_MAX_CAN_PROTOCOL_DRIVERS
     {"can_log.txt"},
     {"can0_stats.txt"},
@@ -102,6 +105,15 @@ int AP_Filesystem_Sys::open(const char *fname, int flags)
     if (strcmp(fname, "uarts.txt") == 0) {
         hal.util->uart_info(*r.str);
     }
+    if (strcmp(fname, "trace.json") == 0) {
+        hal.util->trace_info(*r.str);
+    }
+    if (strcmp(fname, "semaphores.txt") == 0) {
+        hal.util->semaphore_info(*r.str);
+    }
+    if (strcmp(fname, "storage.txt") == 0) {
+        hal.storage->storage_info(*r.str);
+    }
 #if HAL_MAX_CAN_PROTOCOL_DRIVERS
     int8_t can_stats_num = -1;
     if (strcmp(fname, "can_log.txt") == 0) {
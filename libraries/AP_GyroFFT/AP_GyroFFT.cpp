@@ -53,6 +53,11 @@ extern const AP_HAL::HAL& hal;
 #define FFT_HARMONIC_FIT_MULT       200.0f
 #define FFT_HARMONIC_FIT_TRACK_ROLL    4
 #define FFT_HARMONIC_FIT_TRACK_PITCH   5
+#define FFT_ENGINE_SLIDING_DFT      1
+#ifndef FFT_SDFT_HOP_DIVISOR
+#define FFT_SDFT_HOP_DIVISOR        4   // sliding DFT tracker outputs per FFT frame
+#endif
+#define FFT_SDFT_REACQUIRE_FRAMES   4   // FFT frames between full FFT re-acquisitions while tracking
 
 // table of user settable parameters
 const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
@@ -155,6 +160,14 @@ const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("HMNC_PEAK", 13, AP_GyroFFT, _harmonic_peak, 0),
 
+    // @Param: ENGINE
+    // @DisplayName: FFT frequency tracking engine
+    // @Description: Engine used to track the noise frequency. The FFT engine analyses a complete window every frame. The sliding DFT engine uses the FFT to acquire the tracked noise peak and then follows it with a sliding DFT over only the bins either side of the peak, updated every sample. This gives more frequent frequency updates for considerably less CPU on larger windows. The FFT is re-run periodically, or whenever the peak is lost, to re-acquire the peak and refresh the remaining noise peaks and bandwidth. Takes effect on reboot.
+    // @Values: 0:FFT,1:Sliding DFT tracker
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("ENGINE", 14, AP_GyroFFT, _engine, 0),
+
     AP_GROUPEND
 };
 
@@ -280,10 +293,21 @@ void AP_GyroFFT::init(uint32_t target_looptime_us)
         return;
     }
 
+    // the sliding DFT tracker outputs several times a frame, only running the FFT to re-acquire the peak
+    if (_engine == FFT_ENGINE_SLIDING_DFT) {
+        _sdft_window = new float[_window_size + _samples_per_frame];
+        if (_sdft_window == nullptr) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "AP_GyroFFT: sliding DFT disabled, required %u bytes", (unsigned int)(sizeof(float) * (_window_size + _samples_per_frame)));
+        } else {
+            _sdft_hop = MAX(1, _samples_per_frame / FFT_SDFT_HOP_DIVISOR);
+            _sdft_reacquire_cycles = FFT_SDFT_REACQUIRE_FRAMES * _samples_per_frame / _sdft_hop;
+        }
+    }
+
     // per-axis frame time
     _frame_time_ms = _samples_per_frame * 1000 / _fft_sampling_rate_hz;
     // The update rate for the output, defaults are 1Khz / (1 - 0.5) * 32 == 62hz
-    const float output_rate = _fft_sampling_rate_hz / _samples_per_frame;
+    const float output_rate = _fft_sampling_rate_hz / (_sdft_hop > 0 ? _sdft_hop : _samples_per_frame);
     // establish suitable defaults for the detected values
     for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         _thread_state._center_freq_hz[axis] = _fft_min_hz;
@@ -406,20 +430,34 @@ uint16_t AP_GyroFFT::run_cycle()
 
     // get the appropriate gyro buffer
     FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(_update_axis) : _downsampled_gyro_data[_update_axis]);
-    // if we have many more samples than the window size then we are struggling to 
-    // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
-    if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
-        gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
-    }
-    // let's go!
-    hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
 
-    // calculate FFT and update filters outside the semaphore
-    uint16_t bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    if (sdft_tracking(_update_axis)) {
+        // follow the locked peak with the sliding DFT, re-acquiring with the FFT periodically or if the peak is lost
+        if (run_tracker(gyro_buffer, config)) {
+            _sdft_cycles[_update_axis]--;
+        } else {
+            _sdft_cycles[_update_axis] = 0;
+        }
+    } else {
+        // if we have many more samples than the window size then we are struggling to
+        // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
+        if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
+            gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
+        }
+        // let's go!
+        hal.dsp->fft_start(_state, gyro_buffer, _sdft_hop > 0 ? _sdft_hop : _samples_per_frame);
+
+        // calculate FFT and update filters outside the semaphore
+        uint16_t bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
 
-    // something has been detected, update the peak frequency and associated metrics
-    update_ref_energy(bin_max);
-    calculate_noise(false, config);
+        // something has been detected, update the peak frequency and associated metrics
+        update_ref_energy(bin_max);
+        calculate_noise(false, config);
+
+        if (_sdft_hop > 0) {
+            update_tracker_lock(gyro_buffer, config);
+        }
+    }
 
     // record how we are doing
     _thread_state._last_output_us[_update_axis] = AP_HAL::micros();
@@ -448,7 +486,7 @@ bool AP_GyroFFT::start_analysis() {
         return false;
     }
 
-    if (get_available_samples(_update_axis) >= _state->_window_size) {
+    if (get_available_samples(_update_axis) >= get_required_samples(_update_axis)) {
         _thread_state._analysis_started = true;
         return true;
     }
@@ -486,7 +524,7 @@ void AP_GyroFFT::update_thread(void)
         // this is to stop us burning CPU while waiting for samples, the reduction by _samples_per_frame is a heuristic to prevent waiting too long
         // and missing frames (easy to see in SITL because the noise will keep calibrating)
         // we always delay by at least 1us to give logging a chance to run at the same priority
-        uint32_t delay = constrain_int32((int16_t)_state->_window_size - (int16_t)remaining_samples, 0, _samples_per_frame)
+        uint32_t delay = constrain_int32((int16_t)get_required_samples(_update_axis) - (int16_t)remaining_samples, 0, _samples_per_frame)
             * 1e6 / _fft_sampling_rate_hz;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         // in SITL the gyros do not run in a different thread
@@ -1039,6 +1077,83 @@ bool AP_GyroFFT::calculate_filtered_noise(FrequencyPeak target_peak, FrequencyPe
     return false;
 }
 
+// lock the sliding DFT tracker onto the tracked peak found by the FFT, if there is nothing
+// to track then drop the rest of the frame so that the FFT continues at its normal rate
+// called from FFT thread
+void AP_GyroFFT::update_tracker_lock(FloatBuffer& gyro_buffer, const EngineConfig& config)
+{
+    const FrequencyPeak peak = FrequencyPeak(_thread_state._tracked_peak[_update_axis]);
+
+    if (!_thread_state._noise_needs_calibration && _thread_state._health_ms[_update_axis] != 0
+        && peak < FrequencyPeak::MAX_TRACKED_PEAKS && _missed_cycles[_update_axis][peak] == 0) {
+        // the filtered frequency is the one that the swapping algorithm has decided is continuous
+        const uint16_t bin = lrintf(get_tl_noise_center_freq_hz(peak, _update_axis) / _state->_bin_resolution);
+        _sdft[_update_axis].reset(constrain_int16(bin, MAX(config._fft_start_bin, 2), MIN(config._fft_end_bin, _state->_bin_count - 2)));
+        _sdft_peak[_update_axis] = peak;
+        _sdft_cycles[_update_axis] = _sdft_reacquire_cycles;
+        return;
+    }
+
+    gyro_buffer.advance(_samples_per_frame - _sdft_hop);
+}
+
+// follow the tracked peak with the sliding DFT, returns false if the peak has been lost
+// called from FFT thread
+bool AP_GyroFFT::run_tracker(FloatBuffer& gyro_buffer, const EngineConfig& config)
+{
+    const uint16_t window_size = _state->_window_size;
+    SlidingDFT& sdft = _sdft[_update_axis];
+
+    // if we are struggling to stay ahead of the gyro loop then drop samples, the window is no longer contiguous so re-seed
+    if (gyro_buffer.available() > uint32_t(window_size + _sdft_hop + uint16_t(_samples_per_frame >> 1))) {
+        gyro_buffer.advance(gyro_buffer.available() - window_size - _sdft_hop);
+        sdft.reset(sdft.get_center_bin());
+    }
+
+    const uint16_t count = gyro_buffer.peek(_sdft_window, MIN(gyro_buffer.available(), uint32_t(window_size + _samples_per_frame)));
+    if (count < window_size) {
+        return false;
+    }
+
+    // seeding costs a full pass over the window per bin, but only happens once per acquisition
+    if (!sdft.is_seeded()) {
+        sdft.seed(_sdft_window, window_size);
+    }
+    for (uint16_t i = window_size; i < count; i++) {
+        sdft.update(_sdft_window[i - window_size], _sdft_window[i]);
+    }
+    gyro_buffer.advance(count - window_size);
+
+    float power;
+    const float peak_bin = sdft.find_peak(&_sdft_window[count - window_size], window_size,
+        MAX(config._fft_start_bin, 2), MIN(config._fft_end_bin, _state->_bin_count - 2), power);
+    // scale the power to match the FFT output
+    power *= _state->_window_scale;
+
+    const uint16_t bin = sdft.get_center_bin();
+    const float ref_energy = MAX(1.0f, _ref_energy[_update_axis][bin]);
+    const float snr = 10.f * (log10f(MAX(1.0f, power)) - log10f(ref_energy));
+
+    if (!isfinite(power) || snr <= config._snr_threshold_db) {
+        return false;
+    }
+
+    const float freq_hz = constrain_float(peak_bin * _state->_bin_resolution, (float)config._fft_min_hz, (float)config._fft_max_hz);
+    const FrequencyPeak peak = _sdft_peak[_update_axis];
+
+    // the other peaks and the bandwidth are only refreshed by the FFT
+    update_tl_center_freq_energy(peak, _update_axis, power);
+    update_tl_noise_center_freq_hz(peak, _update_axis, freq_hz);
+    _missed_cycles[_update_axis][peak] = 0;
+
+    _thread_state._center_freq_bin[_update_axis] = bin;
+    _thread_state._center_freq_hz[_update_axis] = freq_hz;
+    _thread_state._center_snr[_update_axis] = snr;
+    _thread_state._health_ms[_update_axis] = AP_HAL::millis();
+
+    return true;
+}
+
 // filter values through a median sliding window followed by low pass filter
 // this eliminates temporary spikes in the detected frequency that are either pure noise
 // or a different peak that will erroneously bias the peak we are tracking
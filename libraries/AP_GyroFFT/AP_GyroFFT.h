@@ -33,6 +33,7 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <Filter/LowPassFilter.h>
 #include <Filter/FilterWithBuffer.h>
+#include <Filter/SlidingDFT.h>
 
 #define DEBUG_FFT   0
 
@@ -195,6 +196,12 @@ private:
     float calculate_weighted_freq_hz(const Vector3f& energy, const Vector3f& freq) const;
     // update the estimation of the background noise energy
     void update_ref_energy(uint16_t max_bin);
+    // whether the sliding DFT tracker should be used for the next cycle on an axis
+    bool sdft_tracking(uint8_t axis) const { return _sdft_cycles[axis] > 0; }
+    // update the tracked noise peak using the sliding DFT
+    bool run_tracker(FloatBuffer& gyro_buffer, const EngineConfig& config);
+    // lock the sliding DFT tracker onto the center peak found by the full FFT
+    void update_tracker_lock(FloatBuffer& gyro_buffer, const EngineConfig& config);
     // test frequency detection for all of the allowable bins
     float self_test_bin_frequencies();
     // detect the provided frequency
@@ -207,6 +214,10 @@ private:
     uint16_t get_available_samples(uint8_t axis) {
         return _sample_mode == 0 ?_ins->get_raw_gyro_window(axis).available() : _downsampled_gyro_data[axis].available();
     }
+    // return samples required in the gyro window for the next cycle
+    uint16_t get_required_samples(uint8_t axis) const {
+        return _state->_window_size + (sdft_tracking(axis) ? _sdft_hop : 0);
+    }
     // semaphore for access to shared FFT data
     HAL_Semaphore _sem;
 
@@ -284,6 +295,19 @@ private:
     // engine health on roll/pitch/yaw
     Vector3<uint8_t> _rpy_health;
 
+    // sliding DFT tracker for each axis
+    SlidingDFT _sdft[XYZ_AXIS_COUNT];
+    // copy of the current gyro window used by the sliding DFT tracker
+    float* _sdft_window;
+    // number of samples between sliding DFT tracker outputs, zero if the tracker is disabled
+    uint16_t _sdft_hop;
+    // number of sliding DFT cycles before the next full FFT re-acquisition
+    uint16_t _sdft_reacquire_cycles;
+    // number of sliding DFT cycles remaining on each axis, zero if the tracker is not locked
+    uint16_t _sdft_cycles[XYZ_AXIS_COUNT];
+    // noise peak followed by the sliding DFT tracker on each axis
+    FrequencyPeak _sdft_peak[XYZ_AXIS_COUNT];
+
     // smoothing filter on the output
     MedianLowPassFilter3dFloat _center_freq_filter[FrequencyPeak::MAX_TRACKED_PEAKS];
     // smoothing filter on the energy
@@ -334,6 +358,8 @@ private:
     AP_Int8 _harmonic_fit;
     // harmonic peak target
     AP_Int8 _harmonic_peak;
+    // frequency tracking engine
+    AP_Int8 _engine;
     AP_InertialSensor* _ins;
 #if DEBUG_FFT
     uint32_t _last_output_ms;
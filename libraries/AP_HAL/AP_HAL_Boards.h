@@ -256,3 +256,18 @@
 #ifndef HAL_ENABLE_THREAD_STATISTICS
 #define HAL_ENABLE_THREAD_STATISTICS 0
 #endif
+
+// per call site semaphore contention statistics, see SemaphoreProfiler.h
+#ifndef HAL_SEMAPHORE_PROFILE_ENABLED
+#define HAL_SEMAPHORE_PROFILE_ENABLED 0
+#endif
+
+// storage write-back timing, see StorageWriteback.h. The maximum
+// latency must stay well inside the 2s window of Storage::healthy()
+#ifndef HAL_STORAGE_WRITEBACK_QUIET_MS
+#define HAL_STORAGE_WRITEBACK_QUIET_MS 100
+#endif
+
+#ifndef HAL_STORAGE_WRITEBACK_MAX_MS
+#define HAL_STORAGE_WRITEBACK_MAX_MS 1000
+#endif
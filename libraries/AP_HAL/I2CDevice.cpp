@@ -0,0 +1,53 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "I2CDevice.h"
+
+namespace AP_HAL {
+
+bool I2CDevice::transfer_batch(const Segment *segments, uint8_t count)
+{
+    if (count == 0) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        const Segment &seg = segments[i];
+
+        if (seg.send == nullptr) {
+            if (!transfer(nullptr, 0, seg.recv, seg.len)) {
+                return false;
+            }
+            continue;
+        }
+
+        // a write followed by a read is what transfer() does anyway
+        if (i + 1 < count && segments[i + 1].send == nullptr) {
+            if (!transfer(seg.send, seg.len, segments[i + 1].recv, segments[i + 1].len)) {
+                return false;
+            }
+            i++;
+            continue;
+        }
+
+        if (!transfer(seg.send, seg.len, nullptr, 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
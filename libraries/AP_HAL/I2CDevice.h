@@ -47,6 +47,31 @@ public:
     virtual bool read_registers_multiple(uint8_t first_reg, uint8_t *recv,
                                          uint32_t recv_len, uint8_t times) = 0;
 
+    /*
+     * One segment of a batched transaction: a write of @len bytes from @send
+     * if @send is set, otherwise a read of @len bytes into @recv.
+     */
+    struct Segment {
+        const uint8_t *send;
+        uint8_t *recv;
+        uint16_t len;
+    };
+
+    /*
+     * Perform several write and read segments in one request to the bus,
+     * so that a driver which needs e.g. a status read, a data read and a
+     * command write every cycle doesn't pay for each separately.
+     *
+     * Where the HAL supports it the segments are a single transaction, with
+     * a repeated start between segments and one stop at the end. The
+     * default implementation issues one transfer() per segment, or per
+     * write followed by a read, each ending with a stop, which is also used
+     * when transfers are split. Drivers must therefore not depend on the
+     * device seeing a single transaction, only on no other device on the
+     * bus being addressed between the segments.
+     */
+    virtual bool transfer_batch(const Segment *segments, uint8_t count);
+
     /* See Device::get_semaphore() */
     virtual Semaphore *get_semaphore() override = 0;
 
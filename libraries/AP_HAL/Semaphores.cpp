@@ -1,4 +1,5 @@
 #include "AP_HAL.h"
+#include "utility/SemaphoreProfiler.h"
 
 extern const AP_HAL::HAL &hal;
 
@@ -22,6 +23,30 @@ WithSemaphore::WithSemaphore(AP_HAL::Semaphore &mtx, uint32_t line) :
     }
 }
 
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+WithSemaphore::WithSemaphore(AP_HAL::Semaphore *mtx, uint32_t line, const char *file) :
+    WithSemaphore(*mtx, line, file)
+{}
+
+WithSemaphore::WithSemaphore(AP_HAL::Semaphore &mtx, uint32_t line, const char *file) :
+    _mtx(mtx)
+{
+    // attribute the take to this site rather than to us
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::set_call_site(file, line);
+    }
+
+    bool in_main = hal.scheduler->in_main_thread();
+    if (in_main) {
+        hal.util->persistent_data.semaphore_line = line;
+    }
+    _mtx.take_blocking();
+    if (in_main) {
+        hal.util->persistent_data.semaphore_line = 0;
+    }
+}
+#endif
+
 WithSemaphore::~WithSemaphore()
 {
     _mtx.give();
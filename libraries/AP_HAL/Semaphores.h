@@ -45,6 +45,10 @@ class WithSemaphore {
 public:
     WithSemaphore(AP_HAL::Semaphore *mtx, uint32_t line);
     WithSemaphore(AP_HAL::Semaphore &mtx, uint32_t line);
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    WithSemaphore(AP_HAL::Semaphore *mtx, uint32_t line, const char *file);
+    WithSemaphore(AP_HAL::Semaphore &mtx, uint32_t line, const char *file);
+#endif
 
     ~WithSemaphore();
 private:
@@ -54,4 +58,8 @@ private:
 // From: https://stackoverflow.com/questions/19666142/why-is-a-level-of-indirection-needed-for-this-concatenation-macro
 #define WITH_SEMAPHORE( sem ) JOIN( sem, __LINE__, __COUNTER__ )
 #define JOIN( sem, line, counter ) _DO_JOIN( sem, line, counter )
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+#define _DO_JOIN( sem, line, counter ) WithSemaphore _getsem ## counter(sem, line, __FILE__)
+#else
 #define _DO_JOIN( sem, line, counter ) WithSemaphore _getsem ## counter(sem, line)
+#endif
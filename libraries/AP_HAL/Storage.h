@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include "AP_HAL_Namespace.h"
 
+class ExpandingString;
+
 class AP_HAL::Storage {
 public:
     virtual void init() = 0;
@@ -11,4 +13,11 @@ public:
     virtual void write_block(uint16_t dst, const void* src, size_t n) = 0;
     virtual void _timer_tick(void) {};
     virtual bool healthy(void) { return true; }
+
+    // write back pending changes without waiting for the write-back
+    // delay, e.g. before a reboot
+    virtual void flush(void) {}
+
+    // request write-back and wear statistics
+    virtual void storage_info(ExpandingString &str) {}
 };
@@ -199,6 +199,20 @@ public:
     // request information on uart I/O
     virtual void uart_info(ExpandingString &str) {}
 
+    /*
+      mark the start and end of a named span on the calling thread for
+      boards with an event tracer. The name must stay valid for the life
+      of the program, e.g. a string literal or scheduler task name
+     */
+    virtual void trace_begin(const char *name) {}
+    virtual void trace_end(const char *name) {}
+
+    // request the recent trace events in Chrome/Perfetto JSON format
+    virtual void trace_info(ExpandingString &str) {}
+
+    // request semaphore contention statistics per call site
+    virtual void semaphore_info(ExpandingString &str) {}
+
 protected:
     // we start soft_armed false, so that actuators don't send any
     // values until the vehicle code has fully started
@@ -0,0 +1,46 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/utility/RingBuffer.h>
+
+/*
+  one producer and one consumer thread hammering the same buffer, as the
+  logger and the UART drivers do. The argument is the chunk size
+ */
+static ByteBuffer byte_buffer{4096};
+static SPSCByteBuffer spsc_buffer{4096};
+
+template <class Buffer>
+static void run_two_threads(benchmark::State& state, Buffer &buffer)
+{
+    uint8_t chunk[1024] {};
+    const uint32_t len = state.range(0);
+    int64_t bytes = 0;
+
+    if (state.thread_index == 0) {
+        while (state.KeepRunning()) {
+            bytes += buffer.write(chunk, len);
+        }
+    } else {
+        while (state.KeepRunning()) {
+            bytes += buffer.read(chunk, len);
+            gbenchmark_escape(chunk);
+        }
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+
+static void BM_ByteBufferTwoThreads(benchmark::State& state)
+{
+    run_two_threads(state, byte_buffer);
+}
+
+static void BM_SPSCByteBufferTwoThreads(benchmark::State& state)
+{
+    run_two_threads(state, spsc_buffer);
+}
+
+BENCHMARK(BM_ByteBufferTwoThreads)->Arg(1)->Arg(16)->Arg(256)->Threads(2)->UseRealTime();
+BENCHMARK(BM_SPSCByteBufferTwoThreads)->Arg(1)->Arg(16)->Arg(256)->Threads(2)->UseRealTime();
+
+BENCHMARK_MAIN();
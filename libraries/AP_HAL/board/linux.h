@@ -350,6 +350,10 @@
     #define HAL_LINUX_I2C_EXTERNAL_BUS_MASK 0xFFFF
 #endif
 
+#ifndef HAL_SEMAPHORE_PROFILE_ENABLED
+    #define HAL_SEMAPHORE_PROFILE_ENABLED 1
+#endif
+
 #include <AP_HAL_Linux/Semaphores.h>
 #define HAL_Semaphore Linux::Semaphore
 #include <AP_HAL/EventHandle.h>
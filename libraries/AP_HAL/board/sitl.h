@@ -54,6 +54,10 @@
 #define HAL_HAVE_SERVO_VOLTAGE 1
 #define HAL_HAVE_SAFETY_SWITCH 0
 
+#ifndef HAL_SEMAPHORE_PROFILE_ENABLED
+#define HAL_SEMAPHORE_PROFILE_ENABLED 1
+#endif
+
 // allow for static semaphores
 #include <AP_HAL_SITL/Semaphores.h>
 #define HAL_Semaphore HALSITL::Semaphore
@@ -264,3 +264,237 @@ int16_t ByteBuffer::peek(uint32_t ofs) const
     }
     return buf[(head+ofs)%size];
 }
+
+SPSCByteBuffer::SPSCByteBuffer(uint32_t _size)
+{
+    buf = (uint8_t*)calloc(1, _size);
+    size = buf ? _size : 0;
+}
+
+SPSCByteBuffer::~SPSCByteBuffer(void)
+{
+    free(buf);
+}
+
+/*
+ * Caller is responsible for locking in set_size()
+ */
+bool SPSCByteBuffer::set_size(uint32_t _size)
+{
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    cached_head = cached_tail = 0;
+    if (_size != size) {
+        free(buf);
+        buf = (uint8_t*)calloc(1, _size);
+        if (!buf) {
+            size = 0;
+            return false;
+        }
+
+        size = _size;
+    }
+
+    return true;
+}
+
+uint32_t SPSCByteBuffer::space(void) const
+{
+    if (size == 0) {
+        return 0;
+    }
+    return free_space(head.load(std::memory_order_acquire),
+                      tail.load(std::memory_order_relaxed));
+}
+
+uint32_t SPSCByteBuffer::available(void) const
+{
+    return used_space(head.load(std::memory_order_relaxed),
+                      tail.load(std::memory_order_acquire));
+}
+
+/*
+  the cached head only ever lags the real one, so it gives a lower
+  bound on the free space without touching the consumer's cache line
+ */
+uint32_t SPSCByteBuffer::producer_space(uint32_t _tail, uint32_t len)
+{
+    uint32_t n = free_space(cached_head, _tail);
+    if (n < len) {
+        cached_head = head.load(std::memory_order_acquire);
+        n = free_space(cached_head, _tail);
+    }
+    return n;
+}
+
+uint32_t SPSCByteBuffer::consumer_available(uint32_t _head, uint32_t len)
+{
+    uint32_t n = used_space(_head, cached_tail);
+    if (n < len) {
+        cached_tail = tail.load(std::memory_order_acquire);
+        n = used_space(_head, cached_tail);
+    }
+    return n;
+}
+
+uint8_t SPSCByteBuffer::reserve(IoVec vec[2], uint32_t len)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    const uint32_t _tail = tail.load(std::memory_order_relaxed);
+    const uint32_t n = producer_space(_tail, len);
+    if (len > n) {
+        len = n;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    vec[0].data = &buf[_tail];
+    const uint32_t to_end = size - _tail;
+    if (len <= to_end) {
+        vec[0].len = len;
+        return 1;
+    }
+
+    vec[0].len = to_end;
+    vec[1].data = buf;
+    vec[1].len = len - to_end;
+    return 2;
+}
+
+bool SPSCByteBuffer::commit(uint32_t len)
+{
+    if (size == 0) {
+        return len == 0;
+    }
+    const uint32_t _tail = tail.load(std::memory_order_relaxed);
+    if (len > producer_space(_tail, len)) {
+        return false;
+    }
+    // make the data visible before the new tail
+    tail.store((_tail + len) % size, std::memory_order_release);
+    return true;
+}
+
+uint32_t SPSCByteBuffer::write(const uint8_t *data, uint32_t len)
+{
+    IoVec vec[2];
+    const auto n_vec = reserve(vec, len);
+    uint32_t ret = 0;
+
+    for (uint8_t i = 0; i < n_vec; i++) {
+        memcpy(vec[i].data, data + ret, vec[i].len);
+        ret += vec[i].len;
+    }
+
+    if (ret > 0) {
+        commit(ret);
+    }
+    return ret;
+}
+
+uint8_t SPSCByteBuffer::peekiovec(IoVec vec[2], uint32_t len)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    const uint32_t n = consumer_available(_head, len);
+    if (len > n) {
+        len = n;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    vec[0].data = &buf[_head];
+    const uint32_t to_end = size - _head;
+    if (len <= to_end) {
+        vec[0].len = len;
+        return 1;
+    }
+
+    vec[0].len = to_end;
+    vec[1].data = buf;
+    vec[1].len = len - to_end;
+    return 2;
+}
+
+uint32_t SPSCByteBuffer::peekbytes(uint8_t *data, uint32_t len)
+{
+    IoVec vec[2];
+    const auto n_vec = peekiovec(vec, len);
+    uint32_t ret = 0;
+
+    for (uint8_t i = 0; i < n_vec; i++) {
+        memcpy(data + ret, vec[i].data, vec[i].len);
+        ret += vec[i].len;
+    }
+
+    return ret;
+}
+
+uint32_t SPSCByteBuffer::read(uint8_t *data, uint32_t len)
+{
+    const uint32_t ret = peekbytes(data, len);
+    if (ret > 0) {
+        advance(ret);
+    }
+    return ret;
+}
+
+const uint8_t *SPSCByteBuffer::readptr(uint32_t &available_bytes)
+{
+    IoVec vec[2];
+    if (peekiovec(vec, UINT32_MAX) == 0) {
+        available_bytes = 0;
+        return nullptr;
+    }
+    available_bytes = vec[0].len;
+    return vec[0].data;
+}
+
+bool SPSCByteBuffer::advance(uint32_t n)
+{
+    if (size == 0) {
+        return n == 0;
+    }
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    if (n > consumer_available(_head, n)) {
+        return false;
+    }
+    // we are done with the data before the producer may reuse it
+    head.store((_head + n) % size, std::memory_order_release);
+    return true;
+}
+
+void SPSCByteBuffer::clear(void)
+{
+    cached_tail = tail.load(std::memory_order_acquire);
+    head.store(cached_tail, std::memory_order_release);
+}
+
+uint32_t SPSCByteBuffer::write_mark(void) const
+{
+    return tail.load(std::memory_order_relaxed);
+}
+
+bool SPSCByteBuffer::discard_to(uint32_t mark)
+{
+    if (size == 0) {
+        return false;
+    }
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    cached_tail = tail.load(std::memory_order_acquire);
+    // the mark lies between the read and write indexes unless we have
+    // already read past it
+    if (used_space(_head, mark) > used_space(_head, cached_tail)) {
+        return false;
+    }
+    head.store(mark, std::memory_order_release);
+    return true;
+}
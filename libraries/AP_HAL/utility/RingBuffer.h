@@ -101,6 +101,111 @@ private:
     bool external_buf;
 };
 
+#ifndef HAL_CACHE_LINE_SIZE
+#define HAL_CACHE_LINE_SIZE 64
+#endif
+
+/*
+ * Circular buffer of bytes for exactly one producer thread and one
+ * consumer thread. The read and write indexes live on separate cache
+ * lines, along with each side's cached copy of the other's index, so a
+ * busy producer does not keep invalidating the consumer's line and vice
+ * versa. Publishing is done with release stores paired with acquire
+ * loads on the other side.
+ *
+ * Producer side: space(), write(), reserve(), commit(), write_mark()
+ * Consumer side: available(), read(), peekbytes(), peekiovec(),
+ * readptr(), advance(), clear(), discard_to()
+ */
+class SPSCByteBuffer {
+public:
+    using IoVec = ByteBuffer::IoVec;
+
+    SPSCByteBuffer(uint32_t size);
+    ~SPSCByteBuffer(void);
+
+    // return size of ringbuffer
+    uint32_t get_size(void) const { return size; }
+
+    // set size of ringbuffer, caller responsible for locking out both sides
+    bool set_size(uint32_t size);
+
+    // number of bytes space available to write
+    uint32_t space(void) const;
+
+    // write bytes to ringbuffer. Returns number of bytes written
+    uint32_t write(const uint8_t *data, uint32_t len);
+
+    // reserve up to len bytes of free space for the caller to fill in
+    // place, returning the number of parts. Publish with commit()
+    uint8_t reserve(IoVec vec[2], uint32_t len);
+
+    // publish len bytes previously filled in after reserve()
+    bool commit(uint32_t len);
+
+    // number of bytes available to be read
+    uint32_t available(void) const;
+
+    // true if available() is zero
+    bool is_empty(void) const WARN_IF_UNUSED { return available() == 0; }
+
+    // read bytes from ringbuffer. Returns number of bytes read
+    uint32_t read(uint8_t *data, uint32_t len);
+
+    // read len bytes without advancing the read pointer
+    uint32_t peekbytes(uint8_t *data, uint32_t len);
+
+    // fill out up to two parts holding the next len bytes, returning
+    // the number of parts. Release them with advance()
+    uint8_t peekiovec(IoVec vec[2], uint32_t len);
+
+    // Returns the pointer and size to a contiguous read of the next available data
+    const uint8_t *readptr(uint32_t &available_bytes);
+
+    // advance the read pointer (discarding bytes)
+    bool advance(uint32_t n);
+
+    // Discards the buffer content, emptying it
+    void clear(void);
+
+    // producer side: mark the end of the data written so far, for the
+    // consumer to discard it with discard_to()
+    uint32_t write_mark(void) const;
+
+    // consumer side: discard the data written before mark, leaving
+    // anything written after it. Returns false if the data up to mark
+    // had already been read
+    bool discard_to(uint32_t mark);
+
+private:
+    uint32_t free_space(uint32_t _head, uint32_t _tail) const {
+        return (_head > _tail ? 0 : size) + _head - _tail - 1;
+    }
+    uint32_t used_space(uint32_t _head, uint32_t _tail) const {
+        return (_head > _tail ? size : 0) + _tail - _head;
+    }
+
+    // producer side, refreshing the cached head only when short of space
+    uint32_t producer_space(uint32_t _tail, uint32_t len);
+    // consumer side, refreshing the cached tail only when short of data
+    uint32_t consumer_available(uint32_t _head, uint32_t len);
+
+    // read-only while both sides run
+    uint8_t *buf;
+    uint32_t size;
+    uint8_t _pad0[HAL_CACHE_LINE_SIZE - sizeof(uint8_t *) - sizeof(uint32_t)];
+
+    // written by the consumer
+    std::atomic<uint32_t> head{0};
+    uint32_t cached_tail = 0;
+    uint8_t _pad1[HAL_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+
+    // written by the producer
+    std::atomic<uint32_t> tail{0};
+    uint32_t cached_head = 0;
+    uint8_t _pad2[HAL_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+};
+
 /*
   ring buffer class for objects of fixed size
   !!! Note ObjectBuffer_TS is a duplicate of this update, in both places !!!
@@ -0,0 +1,287 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_HAL/AP_HAL.h>
+
+#include "SemaphoreProfiler.h"
+
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <AP_Common/ExpandingString.h>
+
+#ifndef HAL_SEMAPHORE_PROFILE_MAX_SITES
+#define HAL_SEMAPHORE_PROFILE_MAX_SITES 256
+#endif
+
+#define MAX_THREADS 32
+#define NO_THREAD 0xFF
+
+struct SemaphoreProfiler::Site {
+    enum State : uint8_t {
+        EMPTY,
+        CLAIMING,
+        READY,
+    };
+    std::atomic<uint8_t> state;
+
+    // file of a WITH_SEMAPHORE() with its line, or caller address with line 0
+    const void *id;
+    uint16_t line;
+
+    std::atomic<uint32_t> takes;
+    std::atomic<uint32_t> contended;
+    std::atomic<uint64_t> wait_total_us;
+    std::atomic<uint32_t> wait_max_us;
+    std::atomic<uint64_t> hold_total_us;
+    std::atomic<uint32_t> hold_max_us;
+    std::atomic<uint8_t> owner;
+    std::atomic<Site *> blocker;
+};
+
+std::atomic<bool> SemaphoreProfiler::_enabled;
+
+static SemaphoreProfiler::Site sites[HAL_SEMAPHORE_PROFILE_MAX_SITES];
+
+static char thread_names[MAX_THREADS][16];
+static std::atomic<uint8_t> num_threads;
+
+static thread_local uint8_t thread_index = NO_THREAD;
+static thread_local const char *pending_file;
+static thread_local uint16_t pending_line;
+
+// wall clock time, SITL may run the simulation clock at any speed
+static uint64_t now_usec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void update_max(std::atomic<uint32_t> &max, uint32_t v)
+{
+    uint32_t old = max.load(std::memory_order_relaxed);
+    while (v > old && !max.compare_exchange_weak(old, v, std::memory_order_relaxed)) {
+    }
+}
+
+void SemaphoreProfiler::set_call_site(const char *file, uint16_t line)
+{
+    pending_file = file;
+    pending_line = line;
+}
+
+/*
+  find or add the site for a call site id. Sites are never removed, so
+  this is a lock-free insert-only open addressing table
+ */
+SemaphoreProfiler::Site *SemaphoreProfiler::_find_site(const void *id, uint16_t line)
+{
+    const uintptr_t hash = (uintptr_t(id) >> 3) ^ (uintptr_t(line) * 2654435761U);
+
+    for (uint16_t i = 0; i < HAL_SEMAPHORE_PROFILE_MAX_SITES; i++) {
+        Site &site = sites[(hash + i) % HAL_SEMAPHORE_PROFILE_MAX_SITES];
+        uint8_t state = site.state.load(std::memory_order_acquire);
+        if (state == Site::EMPTY) {
+            if (site.state.compare_exchange_strong(state, Site::CLAIMING, std::memory_order_acquire)) {
+                site.id = id;
+                site.line = line;
+                site.owner.store(NO_THREAD, std::memory_order_relaxed);
+                site.state.store(Site::READY, std::memory_order_release);
+                return &site;
+            }
+        }
+        // another thread is filling in this slot
+        while (state == Site::CLAIMING) {
+            state = site.state.load(std::memory_order_acquire);
+        }
+        if (site.id == id && site.line == line) {
+            return &site;
+        }
+    }
+
+    // table full
+    return nullptr;
+}
+
+uint8_t SemaphoreProfiler::_thread_index()
+{
+    if (thread_index == NO_THREAD) {
+        // saturate rather than wrap, as threads past the limit come
+        // back here on every take
+        uint8_t idx = num_threads.load(std::memory_order_relaxed);
+        do {
+            if (idx >= MAX_THREADS) {
+                return NO_THREAD;
+            }
+        } while (!num_threads.compare_exchange_weak(idx, idx+1, std::memory_order_relaxed));
+        pthread_getname_np(pthread_self(), thread_names[idx], sizeof(thread_names[idx]));
+        thread_index = idx;
+    }
+    return thread_index;
+}
+
+void SemaphoreProfiler::_site_name(const Site &site, char *name, uint8_t len)
+{
+    if (site.line == 0) {
+        snprintf(name, len, "%p", site.id);
+        return;
+    }
+    const char *file = (const char *)site.id;
+    const char *base = strrchr(file, '/');
+    snprintf(name, len, "%s:%u", base ? base + 1 : file, unsigned(site.line));
+}
+
+SemaphoreProfiler::Wait::Wait(Hold &hold, const void *caller) :
+    _hold(hold)
+{
+    if (pending_file != nullptr) {
+        _site = _find_site(pending_file, pending_line);
+        pending_file = nullptr;
+    } else {
+        _site = _find_site(caller, 0);
+    }
+    _blocker = hold.site.load(std::memory_order_acquire);
+    _start_us = now_usec();
+}
+
+bool SemaphoreProfiler::Wait::taken(bool ok)
+{
+    if (!ok) {
+        return false;
+    }
+
+    // we own the semaphore from here on
+    if (_hold.depth++ > 0) {
+        // a recursive take is part of the outer hold
+        return true;
+    }
+
+    const uint64_t now = now_usec();
+    _hold.taken_us = now;
+    _hold.site.store(_site, std::memory_order_release);
+
+    if (_site == nullptr) {
+        return true;
+    }
+
+    const uint32_t wait_us = now - _start_us;
+    _site->takes.fetch_add(1, std::memory_order_relaxed);
+    _site->wait_total_us.fetch_add(wait_us, std::memory_order_relaxed);
+    update_max(_site->wait_max_us, wait_us);
+    _site->owner.store(_thread_index(), std::memory_order_relaxed);
+    if (_blocker != nullptr) {
+        _site->contended.fetch_add(1, std::memory_order_relaxed);
+        _site->blocker.store(_blocker, std::memory_order_relaxed);
+    }
+
+    return true;
+}
+
+void SemaphoreProfiler::released(Hold &hold)
+{
+    // the semaphore may have been taken before profiling was enabled
+    if (hold.depth == 0 || --hold.depth > 0) {
+        return;
+    }
+
+    Site *site = hold.site.load(std::memory_order_relaxed);
+    hold.site.store(nullptr, std::memory_order_release);
+    if (site == nullptr) {
+        return;
+    }
+
+    const uint32_t hold_us = now_usec() - hold.taken_us;
+    site->hold_total_us.fetch_add(hold_us, std::memory_order_relaxed);
+    update_max(site->hold_max_us, hold_us);
+}
+
+uint16_t SemaphoreProfiler::get_worst(Stats *stats, uint16_t max_stats)
+{
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < HAL_SEMAPHORE_PROFILE_MAX_SITES; i++) {
+        const Site &site = sites[i];
+        if (site.state.load(std::memory_order_acquire) != Site::READY) {
+            continue;
+        }
+        const uint64_t wait_total_us = site.wait_total_us.load(std::memory_order_relaxed);
+
+        // insertion sort by total wait time, dropping the least waited
+        uint16_t j = n < max_stats ? n++ : n;
+        while (j > 0 && stats[j-1].wait_total_us < wait_total_us) {
+            if (j < max_stats) {
+                stats[j] = stats[j-1];
+            }
+            j--;
+        }
+        if (j >= max_stats) {
+            continue;
+        }
+
+        Stats &s = stats[j];
+        _site_name(site, s.name, sizeof(s.name));
+        const uint8_t owner = site.owner.load(std::memory_order_relaxed);
+        strncpy(s.owner, owner < MAX_THREADS ? thread_names[owner] : "", sizeof(s.owner));
+        s.owner[sizeof(s.owner)-1] = '\0';
+        const Site *blocker = site.blocker.load(std::memory_order_relaxed);
+        if (blocker != nullptr) {
+            _site_name(*blocker, s.blocker, sizeof(s.blocker));
+        } else {
+            s.blocker[0] = '\0';
+        }
+        s.takes = site.takes.load(std::memory_order_relaxed);
+        s.contended = site.contended.load(std::memory_order_relaxed);
+        s.wait_total_us = wait_total_us;
+        s.wait_max_us = site.wait_max_us.load(std::memory_order_relaxed);
+        s.hold_total_us = site.hold_total_us.load(std::memory_order_relaxed);
+        s.hold_max_us = site.hold_max_us.load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+// display semaphore statistics as text buffer for @SYS/semaphores.txt
+void SemaphoreProfiler::info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("SemaphoresV1\n");
+
+    // dynamically enable statistics collection
+    if (!enabled()) {
+        enable();
+        return;
+    }
+
+    Stats *stats = new Stats[HAL_SEMAPHORE_PROFILE_MAX_SITES];
+    if (stats == nullptr) {
+        return;
+    }
+
+    const uint16_t n = get_worst(stats, HAL_SEMAPHORE_PROFILE_MAX_SITES);
+    for (uint16_t i = 0; i < n; i++) {
+        const Stats &s = stats[i];
+        str.printf("%-40s TAKE=%" PRIu32 " CONT=%" PRIu32 " WAIT=%" PRIu64 "us MAXW=%" PRIu32 "us"
+                   " HOLD=%" PRIu64 "us MAXH=%" PRIu32 "us OWNER=%s BLOCKER=%s\n",
+                   s.name, s.takes, s.contended, s.wait_total_us, s.wait_max_us,
+                   s.hold_total_us, s.hold_max_us, s.owner, s.blocker);
+    }
+
+    delete[] stats;
+}
+
+#endif // HAL_SEMAPHORE_PROFILE_ENABLED
@@ -0,0 +1,102 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+
+#include <atomic>
+#include <stdint.h>
+
+class ExpandingString;
+
+/*
+  contention statistics for semaphores, gathered per call site.
+
+  A call site is the file and line of a WITH_SEMAPHORE(), or the return
+  address of a direct take() otherwise. For each site we keep how often
+  it took a semaphore, how often and how long it had to wait, how long
+  it held the semaphore, the thread that last took it and the site that
+  was holding the semaphore the last time it had to wait.
+
+  Collection is off until enable() is called, after which the hooks
+  cost two clock reads per take/give pair.
+ */
+class SemaphoreProfiler {
+public:
+    struct Site;
+
+    // hold state kept by each profiled semaphore
+    struct Hold {
+        // site holding the semaphore, read by waiters without the lock
+        std::atomic<Site *> site {nullptr};
+        uint64_t taken_us {0};
+        // recursion depth of the owner
+        uint8_t depth {0};
+    };
+
+    struct Stats {
+        char name[64];
+        char owner[16];
+        char blocker[64];
+        uint32_t takes;
+        uint32_t contended;
+        uint64_t wait_total_us;
+        uint32_t wait_max_us;
+        uint64_t hold_total_us;
+        uint32_t hold_max_us;
+    };
+
+    /*
+      a take in progress. Construct before waiting for the lock and call
+      taken() with the result once the wait is over
+     */
+    class Wait {
+    public:
+        Wait(Hold &hold, const void *caller);
+        bool taken(bool ok);
+
+    private:
+        Hold &_hold;
+        Site *_site;
+        Site *_blocker;
+        uint64_t _start_us;
+    };
+
+    static void enable() { _enabled.store(true, std::memory_order_relaxed); }
+    static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    // set the call site for the next take on this thread
+    static void set_call_site(const char *file, uint16_t line);
+
+    // record a give, must be called while still holding the semaphore
+    static void released(Hold &hold);
+
+    // get statistics of the sites with the longest total wait, worst first
+    static uint16_t get_worst(Stats *stats, uint16_t max_stats);
+
+    // write statistics of all sites, worst first
+    static void info(ExpandingString &str);
+
+private:
+    static Site *_find_site(const void *id, uint16_t line);
+    static uint8_t _thread_index();
+    static void _site_name(const Site &site, char *name, uint8_t len);
+
+    static std::atomic<bool> _enabled;
+};
+
+#endif // HAL_SEMAPHORE_PROFILE_ENABLED
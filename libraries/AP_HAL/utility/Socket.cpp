@@ -21,6 +21,11 @@
 
 #include "Socket.h"
 
+#ifndef MSG_NOSIGNAL
+// not available on macOS, where SIGPIPE is ignored by SITL anyway
+#define MSG_NOSIGNAL 0
+#endif
+
 /*
   constructor
  */
@@ -150,6 +155,46 @@ ssize_t SocketAPM::recv(void *buf, size_t size, uint32_t timeout_ms)
     return ::recvfrom(fd, buf, size, MSG_DONTWAIT, (sockaddr *)&in_addr, &len);
 }
 
+/*
+  send data from a list of buffers to the connected peer
+ */
+ssize_t SocketAPM::sendv(const struct iovec *iov, int iovcnt) const
+{
+    struct msghdr msg {};
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/*
+  send data from a list of buffers to the given address
+ */
+ssize_t SocketAPM::sendtov(const struct iovec *iov, int iovcnt, const char *address, uint16_t port)
+{
+    struct sockaddr_in sockaddr;
+    make_sockaddr(address, port, sockaddr);
+
+    struct msghdr msg {};
+    msg.msg_name = &sockaddr;
+    msg.msg_namelen = sizeof(sockaddr);
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/*
+  receive data into a list of buffers without waiting
+ */
+ssize_t SocketAPM::recvv(const struct iovec *iov, int iovcnt)
+{
+    struct msghdr msg {};
+    msg.msg_name = &in_addr;
+    msg.msg_namelen = sizeof(in_addr);
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return ::recvmsg(fd, &msg, MSG_DONTWAIT);
+}
+
 /*
   return the IP address and port of the last received packet
  */
@@ -28,6 +28,7 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 
 class SocketAPM {
 public:
@@ -46,6 +47,13 @@ public:
     ssize_t sendto(const void *buf, size_t size, const char *address, uint16_t port);
     ssize_t recv(void *pkt, size_t size, uint32_t timeout_ms);
 
+    // scatter/gather variants of send(), sendto() and recv(). These
+    // never block and a datagram is sent or received as a single
+    // packet regardless of the number of iovecs
+    ssize_t sendv(const struct iovec *iov, int iovcnt) const;
+    ssize_t sendtov(const struct iovec *iov, int iovcnt, const char *address, uint16_t port);
+    ssize_t recvv(const struct iovec *iov, int iovcnt);
+
     // return the IP address and port of the last received packet
     void last_recv_address(const char *&ip_addr, uint16_t &port) const;
 
@@ -62,6 +70,9 @@ public:
     // listen has been used. A new socket is returned
     SocketAPM *accept(uint32_t timeout_ms);
 
+    // file descriptor, for use with poll() or epoll()
+    int get_fd(void) const { return fd; }
+
 private:
     bool datagram;
     struct sockaddr_in in_addr {};
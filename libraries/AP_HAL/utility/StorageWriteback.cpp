@@ -0,0 +1,106 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "StorageWriteback.h"
+
+#include <AP_Common/ExpandingString.h>
+
+static_assert(HAL_STORAGE_WRITEBACK_MAX_MS < 2000,
+              "storage write-back latency must be below the healthy() window");
+
+void StorageWriteback::set_medium(const char *name, uint32_t size)
+{
+    _medium = name;
+    _block_size = (size + wear_blocks - 1) / wear_blocks;
+}
+
+/*
+  called from write_block(), possibly racing with the storage thread
+  calling clean(). If we lose the race flush_due() restarts the clock
+  on the next tick, so the lines are written one quiet time later
+ */
+void StorageWriteback::dirtied(uint16_t loc, uint16_t n, uint32_t now_ms)
+{
+    if (!_pending) {
+        _pending = true;
+        _first_dirty_ms = now_ms;
+    }
+    _last_dirty_ms = now_ms;
+    _requests++;
+    _request_bytes += n;
+}
+
+bool StorageWriteback::flush_due(uint32_t now_ms)
+{
+    if (_flushing) {
+        return true;
+    }
+    if (!_pending) {
+        _pending = true;
+        _first_dirty_ms = now_ms;
+        _last_dirty_ms = now_ms;
+    }
+    if (now_ms - _last_dirty_ms < quiet_ms &&
+        now_ms - _first_dirty_ms < max_latency_ms) {
+        return false;
+    }
+    _flushing = true;
+    _flushes++;
+    return true;
+}
+
+void StorageWriteback::flush_now(void)
+{
+    if (!_flushing) {
+        _flushing = true;
+        _flushes++;
+    }
+}
+
+void StorageWriteback::clean(void)
+{
+    _pending = false;
+    _flushing = false;
+}
+
+void StorageWriteback::wrote(uint32_t offset, uint32_t n)
+{
+    _writes++;
+    _write_bytes += n;
+    if (_block_size == 0 || n == 0) {
+        return;
+    }
+    const uint32_t last = (offset + n - 1) / _block_size;
+    for (uint32_t b = offset / _block_size; b <= last && b < wear_blocks; b++) {
+        _block_writes[b]++;
+    }
+}
+
+void StorageWriteback::info(ExpandingString &str) const
+{
+    str.printf("StorageV1\n");
+    str.printf("medium=%s block_size=%u quiet_ms=%u max_ms=%u\n",
+               _medium, unsigned(_block_size), unsigned(quiet_ms), unsigned(max_latency_ms));
+    str.printf("requests=%u request_bytes=%u\n",
+               unsigned(_requests), unsigned(_request_bytes));
+    str.printf("flushes=%u writes=%u write_bytes=%u erases=%u\n",
+               unsigned(_flushes), unsigned(_writes), unsigned(_write_bytes), unsigned(_erases));
+    if (_block_size == 0) {
+        return;
+    }
+    str.printf("%-8s %s\n", "Offset", "Writes");
+    for (uint8_t i = 0; i < wear_blocks; i++) {
+        str.printf("%-8u %u\n", unsigned(i * _block_size), unsigned(_block_writes[i]));
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#include <stdint.h>
+
+class ExpandingString;
+
+/*
+  write-back policy and wear statistics for the HAL storage drivers.
+
+  Writes to storage only update the RAM copy and mark lines dirty. The
+  driver asks flush_due() on each storage tick and only writes lines
+  back once there have been no new writes for the quiet time, or the
+  oldest unwritten change has reached the maximum latency. A burst of
+  parameter saves or a mission upload then reaches the medium as a
+  few long runs of lines rather than one line per tick, and a line
+  changed several times in a burst is only written once.
+
+  Once a flush has started it carries on until the driver reports all
+  lines clean, so a steady stream of writes can't hold data back for
+  longer than the maximum latency plus the time to write it out.
+ */
+class StorageWriteback {
+public:
+    // time with no new writes after which dirty lines are written back
+    static constexpr uint16_t quiet_ms = HAL_STORAGE_WRITEBACK_QUIET_MS;
+
+    // maximum time a change waits before write back starts
+    static constexpr uint16_t max_latency_ms = HAL_STORAGE_WRITEBACK_MAX_MS;
+
+    // number of blocks the medium is divided into for wear statistics
+    static constexpr uint8_t wear_blocks = 16;
+
+    /*
+      set the name and size of the medium being written, used for
+      wear statistics. For flash this is the size of the sectors used
+      by AP_FlashStorage rather than the size of storage
+     */
+    void set_medium(const char *name, uint32_t size);
+
+    // n bytes at loc were changed by write_block()
+    void dirtied(uint16_t loc, uint16_t n, uint32_t now_ms);
+
+    // true if dirty lines should be written back on this tick
+    bool flush_due(uint32_t now_ms);
+
+    // start writing back now, e.g. before a reboot
+    void flush_now(void);
+
+    // all dirty lines have been written back
+    void clean(void);
+
+    // n bytes were written to the medium at offset
+    void wrote(uint32_t offset, uint32_t n);
+
+    // a flash sector was erased
+    void erased(void) { _erases++; }
+
+    // report statistics in @SYS/storage.txt format
+    void info(ExpandingString &str) const;
+
+private:
+    const char *_medium = "none";
+    uint32_t _block_size;
+
+    bool _pending;
+    bool _flushing;
+    uint32_t _first_dirty_ms;
+    uint32_t _last_dirty_ms;
+
+    // calls to write_block() that changed data, and their total size
+    uint32_t _requests;
+    uint32_t _request_bytes;
+
+    // write backs started, and the writes and bytes they took
+    uint32_t _flushes;
+    uint32_t _writes;
+    uint32_t _write_bytes;
+    uint32_t _erases;
+
+    uint32_t _block_writes[wear_blocks];
+};
@@ -0,0 +1,130 @@
+#include <AP_gtest.h>
+
+#include <thread>
+
+#include <AP_HAL/utility/RingBuffer.h>
+
+TEST(SPSCByteBufferTest, WriteRead)
+{
+    SPSCByteBuffer buf(8);
+    const uint8_t in[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t out[8] {};
+
+    EXPECT_EQ(7U, buf.space());
+    EXPECT_EQ(7U, buf.write(in, sizeof(in)));
+    EXPECT_EQ(0U, buf.space());
+    EXPECT_EQ(7U, buf.available());
+
+    EXPECT_EQ(3U, buf.read(out, 3));
+    EXPECT_EQ(1, out[0]);
+    EXPECT_EQ(3, out[2]);
+    EXPECT_EQ(3U, buf.space());
+
+    // wraps around the end of the buffer
+    EXPECT_EQ(3U, buf.write(in, 3));
+    EXPECT_EQ(7U, buf.read(out, sizeof(out)));
+    const uint8_t expected[] = {4, 5, 6, 7, 1, 2, 3};
+    for (uint8_t i = 0; i < sizeof(expected); i++) {
+        EXPECT_EQ(expected[i], out[i]);
+    }
+    EXPECT_TRUE(buf.is_empty());
+}
+
+TEST(SPSCByteBufferTest, ReserveCommit)
+{
+    SPSCByteBuffer buf(8);
+    const uint8_t in[] = {1, 2, 3, 4, 5};
+    uint8_t out[5];
+
+    EXPECT_EQ(5U, buf.write(in, 5));
+    EXPECT_EQ(5U, buf.read(out, 5));
+
+    SPSCByteBuffer::IoVec vec[2];
+    EXPECT_EQ(2, buf.reserve(vec, 6));
+    EXPECT_EQ(3U, vec[0].len);
+    EXPECT_EQ(3U, vec[1].len);
+    EXPECT_EQ(0U, buf.available());
+
+    memset(vec[0].data, 0xAA, vec[0].len);
+    memset(vec[1].data, 0xBB, vec[1].len);
+    EXPECT_TRUE(buf.commit(6));
+    EXPECT_EQ(6U, buf.available());
+
+    uint32_t n;
+    const uint8_t *p = buf.readptr(n);
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ(3U, n);
+    EXPECT_EQ(0xAA, p[0]);
+    EXPECT_TRUE(buf.advance(3));
+
+    p = buf.readptr(n);
+    EXPECT_EQ(3U, n);
+    EXPECT_EQ(0xBB, p[0]);
+
+    EXPECT_FALSE(buf.advance(4));
+    buf.clear();
+    EXPECT_EQ(0U, buf.available());
+    EXPECT_EQ(7U, buf.space());
+}
+
+TEST(SPSCByteBufferTest, DiscardTo)
+{
+    SPSCByteBuffer buf(8);
+    const uint8_t in[] = {1, 2, 3, 4, 5};
+    uint8_t out[5];
+
+    // only what was written before the mark goes
+    EXPECT_EQ(4U, buf.write(in, 4));
+    const uint32_t mark = buf.write_mark();
+    EXPECT_EQ(2U, buf.write(&in[3], 2));
+    EXPECT_TRUE(buf.discard_to(mark));
+    EXPECT_EQ(2U, buf.read(out, sizeof(out)));
+    EXPECT_EQ(4, out[0]);
+    EXPECT_EQ(5, out[1]);
+
+    // a mark the consumer has already read past leaves the data alone
+    EXPECT_EQ(2U, buf.write(in, 2));
+    const uint32_t old_mark = buf.write_mark();
+    EXPECT_EQ(3U, buf.write(in, 3));
+    EXPECT_EQ(4U, buf.read(out, 4));
+    EXPECT_FALSE(buf.discard_to(old_mark));
+    EXPECT_EQ(1U, buf.available());
+}
+
+TEST(SPSCByteBufferTest, TwoThreads)
+{
+    SPSCByteBuffer buf(61);
+    const uint32_t total = 1000000;
+
+    std::thread producer([&buf]() {
+        uint8_t chunk[17];
+        uint32_t sent = 0;
+        while (sent < total) {
+            uint32_t n = MIN(uint32_t(sizeof(chunk)), total - sent);
+            for (uint32_t i = 0; i < n; i++) {
+                chunk[i] = uint8_t(sent + i);
+            }
+            sent += buf.write(chunk, n);
+        }
+    });
+
+    uint8_t chunk[23];
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    while (received < total) {
+        const uint32_t n = buf.read(chunk, sizeof(chunk));
+        for (uint32_t i = 0; i < n; i++) {
+            if (chunk[i] != uint8_t(received + i)) {
+                errors++;
+            }
+        }
+        received += n;
+    }
+
+    producer.join();
+
+    EXPECT_EQ(0U, errors);
+    EXPECT_TRUE(buf.is_empty());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,82 @@
+#include <AP_gtest.h>
+
+#include <string.h>
+
+#include <AP_Common/ExpandingString.h>
+#include <AP_HAL/utility/StorageWriteback.h>
+
+TEST(StorageWritebackTest, WaitsForQuietTime)
+{
+    StorageWriteback wb {};
+
+    wb.dirtied(0, 4, 1000);
+    EXPECT_FALSE(wb.flush_due(1000));
+    wb.dirtied(8, 4, 1050);
+    EXPECT_FALSE(wb.flush_due(1050 + StorageWriteback::quiet_ms - 1));
+    EXPECT_TRUE(wb.flush_due(1050 + StorageWriteback::quiet_ms));
+
+    // a started flush carries on until the lines are clean
+    wb.dirtied(16, 4, 1200);
+    EXPECT_TRUE(wb.flush_due(1200));
+    wb.clean();
+    wb.dirtied(16, 4, 1300);
+    EXPECT_FALSE(wb.flush_due(1300));
+}
+
+TEST(StorageWritebackTest, MaxLatency)
+{
+    StorageWriteback wb {};
+
+    // a steady stream of writes is written back after the max latency
+    uint32_t now = 5000;
+    const uint32_t first = now;
+    const uint32_t step = StorageWriteback::quiet_ms / 2;
+    while (now - first < StorageWriteback::max_latency_ms) {
+        wb.dirtied(0, 4, now);
+        EXPECT_FALSE(wb.flush_due(now));
+        now += step;
+    }
+    wb.dirtied(0, 4, now);
+    EXPECT_TRUE(wb.flush_due(now));
+}
+
+TEST(StorageWritebackTest, LinesDirtiedWithoutNotice)
+{
+    StorageWriteback wb {};
+
+    // lines found dirty after clean() start their own quiet time
+    EXPECT_FALSE(wb.flush_due(100));
+    EXPECT_TRUE(wb.flush_due(100 + StorageWriteback::quiet_ms));
+}
+
+TEST(StorageWritebackTest, FlushNow)
+{
+    StorageWriteback wb {};
+
+    wb.dirtied(0, 4, 100);
+    wb.flush_now();
+    EXPECT_TRUE(wb.flush_due(100));
+}
+
+TEST(StorageWritebackTest, WearBlocks)
+{
+    StorageWriteback wb {};
+    wb.set_medium("Test", 16 * 1024);
+
+    wb.wrote(0, 8);
+    wb.wrote(1020, 8);
+    wb.wrote(15 * 1024, 1024);
+    wb.erased();
+
+    ExpandingString str {};
+    wb.info(str);
+    const char *s = str.get_string();
+    ASSERT_NE(nullptr, s);
+    EXPECT_EQ(0, strncmp(s, "StorageV1\n", 10));
+    EXPECT_NE(nullptr, strstr(s, "medium=Test block_size=1024"));
+    EXPECT_NE(nullptr, strstr(s, "writes=3 write_bytes=1040 erases=1"));
+    EXPECT_NE(nullptr, strstr(s, "\n0        2\n1024     1\n2048     0\n"));
+    EXPECT_NE(nullptr, strstr(s, "\n15360    1\n"));
+}
+
+AP_GTEST_MAIN()
@@ -63,6 +63,7 @@ void Storage::_storage_open(void)
 #if HAL_WITH_RAMTRON
     if (fram.init() && fram.read(0, _buffer, CH_STORAGE_SIZE)) {
         _save_backup();
+        _writeback.set_medium("FRAM", CH_STORAGE_SIZE);
         _initialisedType = StorageBackend::FRAM;
         ::printf("Initialised Storage type=%d\n", _initialisedType);
         return;
@@ -79,6 +80,7 @@ void Storage::_storage_open(void)
         // load from storage backend
         _flash_load();
         _save_backup();
+        _writeback.set_medium("Flash", 2*stm32_flash_getpagesize(STORAGE_FLASH_PAGE));
         _initialisedType = StorageBackend::Flash;
 #elif defined(USE_POSIX)
         // if we have failed filesystem init don't try again
@@ -109,6 +111,7 @@ void Storage::_storage_open(void)
                 return;
             }
             _save_backup();
+            _writeback.set_medium("SDCard", CH_STORAGE_SIZE);
             _initialisedType = StorageBackend::SDCard;
         }
 #endif
@@ -241,6 +244,7 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
         WITH_SEMAPHORE(sem);
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _writeback.dirtied(loc, n, AP_HAL::millis());
     }
 }
 
@@ -251,11 +255,16 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+        _writeback.clean();
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+    if (!_writeback.flush_due(AP_HAL::millis())) {
+        return;
+    }
+
+    // write out the first run of dirty lines, limited to keep the
+    // latency of this call to a minimum
     uint16_t i;
     for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -266,18 +275,25 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint16_t n = 1;
+    while (n < CH_STORAGE_MAX_WRITE_LINES && i+n < CH_STORAGE_NUM_LINES && _dirty_mask.get(i+n)) {
+        n++;
+    }
+    const uint32_t offset = CH_STORAGE_LINE_SIZE*i;
+    const uint16_t length = CH_STORAGE_LINE_SIZE*n;
 
     {
-        // take a copy of the line we are writing with a semaphore held
+        // take a copy of the lines we are writing with a semaphore held
         WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
+        memcpy(tmpline, &_buffer[offset], length);
     }
 
     bool write_ok = false;
 
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
+        if (fram.write(offset, tmpline, length)) {
+            _writeback.wrote(offset, length);
             write_ok = true;
         }
     }
@@ -285,16 +301,16 @@ void Storage::_timer_tick(void)
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
         if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
             return;
         }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
+        if (AP::FS().write(log_fd, &_buffer[offset], length) != length) {
             return;
         }
         if (AP::FS().fsync(log_fd) != 0) {
             return;
         }
+        _writeback.wrote(offset, length);
         write_ok = true;
     }
 #endif
@@ -302,7 +318,7 @@ void Storage::_timer_tick(void)
 #ifdef STORAGE_FLASH_PAGE
     if (_initialisedType == StorageBackend::Flash) {
         // save to storage backend
-        if (_flash_write(i)) {
+        if (_flash_write(i, n)) {
             write_ok = true;
         }
     }
@@ -310,14 +326,17 @@ void Storage::_timer_tick(void)
 
     if (write_ok) {
         WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
+        // while holding the semaphore we check if the copy of each
         // line is different from the original line. If it is
         // different then someone has re-dirtied the line while we
         // were writing it, in which case we should not mark it
         // clean. If it matches then we know we can mark the line as
         // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
+        for (uint16_t j=0; j<n; j++) {
+            const uint16_t ofs = CH_STORAGE_LINE_SIZE*j;
+            if (memcmp(&tmpline[ofs], &_buffer[offset+ofs], CH_STORAGE_LINE_SIZE) == 0) {
+                _dirty_mask.clear(i+j);
+            }
         }
     }
 }
@@ -341,12 +360,12 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask.
+  write n storage lines
 */
-bool Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t line, uint16_t n)
 {
 #ifdef STORAGE_FLASH_PAGE
-    return _flash.write(line*CH_STORAGE_LINE_SIZE, CH_STORAGE_LINE_SIZE);
+    return _flash.write(line*CH_STORAGE_LINE_SIZE, n*CH_STORAGE_LINE_SIZE);
 #else
     return false;
 #endif
@@ -361,6 +380,7 @@ bool Storage::_flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *
     size_t base_address = hal.flash->getpageaddr(_flash_page+sector);
     for (uint8_t i=0; i<STORAGE_FLASH_RETRIES; i++) {
         if (hal.flash->write(base_address+offset, data, length)) {
+            _writeback.wrote(base_address+offset-hal.flash->getpageaddr(_flash_page), length);
             return true;
         }
         hal.scheduler->delay(1);
@@ -416,6 +436,7 @@ bool Storage::_flash_erase_sector(uint8_t sector)
         sched->_expect_delay_ms(1000);
         if (hal.flash->erasepage(_flash_page+sector)) {
             sched->_expect_delay_ms(0);
+            _writeback.erased();
             return true;
         }
         sched->_expect_delay_ms(0);
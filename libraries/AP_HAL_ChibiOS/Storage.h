@@ -22,6 +22,7 @@
 #include <AP_FlashStorage/AP_FlashStorage.h>
 #include "hwdef/common/flash.h"
 #include <AP_RAMTRON/AP_RAMTRON.h>
+#include <AP_HAL/utility/StorageWriteback.h>
 
 #define CH_STORAGE_SIZE HAL_STORAGE_SIZE
 
@@ -34,6 +35,11 @@
 #define CH_STORAGE_LINE_SIZE (1<<CH_STORAGE_LINE_SHIFT)
 #define CH_STORAGE_NUM_LINES (CH_STORAGE_SIZE/CH_STORAGE_LINE_SIZE)
 
+// maximum number of consecutive dirty lines written back in one tick
+#ifndef CH_STORAGE_MAX_WRITE_LINES
+#define CH_STORAGE_MAX_WRITE_LINES 8
+#endif
+
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
@@ -46,6 +52,8 @@ public:
 
     void _timer_tick(void) override;
     bool healthy(void) override;
+    void flush(void) override { _writeback.flush_now(); }
+    void storage_info(ExpandingString &str) override { _writeback.info(str); }
 
 private:
     enum class StorageBackend: uint8_t {
@@ -62,7 +70,8 @@ private:
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
     HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    uint8_t tmpline[CH_STORAGE_LINE_SIZE*CH_STORAGE_MAX_WRITE_LINES];
+    StorageWriteback _writeback;
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
@@ -83,7 +92,7 @@ private:
 #endif
 
     void _flash_load(void);
-    bool _flash_write(uint16_t line);
+    bool _flash_write(uint16_t line, uint16_t n);
 
 #if HAL_WITH_RAMTRON
     AP_RAMTRON fram;
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sys/uio.h>
 
 #include <AP_HAL/AP_HAL.h>
 
@@ -76,6 +77,30 @@ ssize_t ConsoleDevice::write(const uint8_t *buf, uint16_t n)
     return ::write(_wr_fd, buf, n);
 }
 
+ssize_t ConsoleDevice::readv(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    if (_closed) {
+        return -EAGAIN;
+    }
+
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    return ::readv(_rd_fd, iov, iovcnt);
+}
+
+ssize_t ConsoleDevice::writev(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    if (_closed) {
+        return -EAGAIN;
+    }
+
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    return ::writev(_wr_fd, iov, iovcnt);
+}
+
 void ConsoleDevice::set_blocking(bool blocking)
 {
     int rd_flags;
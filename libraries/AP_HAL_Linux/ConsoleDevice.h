@@ -12,6 +12,10 @@ public:
     virtual bool close() override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual ssize_t writev(const ByteBuffer::IoVec *vec, uint8_t n) override;
+    virtual ssize_t readv(const ByteBuffer::IoVec *vec, uint8_t n) override;
+    virtual int get_fd() const override { return _closed ? -1 : _rd_fd; }
+    virtual bool writes_to_fd() const override { return _rd_fd == _wr_fd; }
     virtual void set_blocking(bool blocking) override;
     virtual void set_speed(uint32_t speed) override;
 
@@ -41,6 +41,7 @@
 #include "SPIUARTDriver.h"
 #include "Scheduler.h"
 #include "Storage.h"
+#include "Trace.h"
 #include "UARTDriver.h"
 #include "Util.h"
 #include "Util_RPI.h"
@@ -283,6 +284,12 @@ void _usage(void)
     printf("\tcustom storage path:\n");
     printf("\t                   --storage-directory /var/APM/storage\n");
     printf("\t                   -s /var/APM/storage\n");
+    printf("\tthread CPU affinity (main, timer, uart, rcin, io, spi, i2c, other):\n");
+    printf("\t                   --cpu-affinity main=3 --cpu-affinity spi=isolated\n");
+    printf("\t                   -a timer=0-2\n");
+    printf("\tevent trace of the last N events per thread, in @SYS/trace.json:\n");
+    printf("\t                   --trace 8192\n");
+    printf("\t                   -T 8192\n");
 #if AP_MODULE_SUPPORTED
     printf("\tmodule support:\n");
     printf("\t                   --module-directory %s\n", AP_MODULE_DEFAULT_DIRECTORY);
@@ -312,11 +319,13 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"storage-directory",   true,  0, 's'},
         {"module-directory",    true,  0, 'M'},
         {"defaults",            true,  0, 'd'},
+        {"cpu-affinity",        true,  0, 'a'},
+        {"trace",               true,  0, 'T'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:G:H:l:t:s:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:G:H:l:t:s:he:SM:a:T:",
                     options);
 
     /*
@@ -368,6 +377,15 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         case 'd':
             utilInstance.set_custom_defaults_path(gopt.optarg);
             break;
+        case 'a':
+            if (!Scheduler::from(scheduler)->set_cpu_affinity(gopt.optarg)) {
+                printf("Invalid CPU affinity '%s'\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+        case 'T':
+            Trace::enable(strtoul(gopt.optarg, nullptr, 0));
+            break;
         case 'h':
             _usage();
             exit(0);
@@ -49,6 +49,7 @@
 #include "Scheduler.h"
 #include "Semaphores.h"
 #include "Thread.h"
+#include "Trace.h"
 #include "Util.h"
 
 /* Workaround broken header from i2c-tools */
@@ -154,6 +155,8 @@ I2CDevice::~I2CDevice()
 bool I2CDevice::transfer(const uint8_t *send, uint32_t send_len,
                          uint8_t *recv, uint32_t recv_len)
 {
+    TraceScope trace("i2c");
+
     if (_split_transfers && send_len > 0 && recv_len > 0) {
         return transfer(send, send_len, nullptr, 0) &&
             transfer(nullptr, 0, recv, recv_len);
@@ -197,6 +200,49 @@ bool I2CDevice::transfer(const uint8_t *send, uint32_t send_len,
     return r != -1;
 }
 
+bool I2CDevice::transfer_batch(const Segment *segments, uint8_t count)
+{
+    TraceScope trace("i2c");
+
+    if (_split_transfers) {
+        return AP_HAL::I2CDevice::transfer_batch(segments, count);
+    }
+
+    /* the kernel can't do more as one combined message */
+    if (count == 0 || count > I2C_RDRW_IOCTL_MAX_MSGS) {
+        return false;
+    }
+
+    /* all segments go to the kernel as one combined message */
+    struct i2c_msg msgs[count];
+    struct i2c_rdwr_ioctl_data i2c_data = { };
+
+    memset(msgs, 0, count * sizeof(*msgs));
+
+    for (uint8_t i = 0; i < count; i++) {
+        msgs[i].addr = _address;
+        if (segments[i].send) {
+            msgs[i].flags = 0;
+            msgs[i].buf = const_cast<uint8_t*>(segments[i].send);
+        } else {
+            msgs[i].flags = I2C_M_RD;
+            msgs[i].buf = segments[i].recv;
+        }
+        msgs[i].len = segments[i].len;
+    }
+
+    i2c_data.msgs = msgs;
+    i2c_data.nmsgs = count;
+
+    int r;
+    unsigned retries = _retries;
+    do {
+        r = ::ioctl(_bus.fd, I2C_RDWR, &i2c_data);
+    } while (r == -1 && retries-- > 0);
+
+    return r != -1;
+}
+
 bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
                                         uint32_t recv_len, uint8_t times)
 {
@@ -261,6 +307,7 @@ AP_HAL::Device::PeriodicHandle I2CDevice::register_periodic_callback(
         snprintf(name, sizeof(name), "ap-i2c-%u", _bus.bus);
 
         _bus.thread.set_stack_size(AP_LINUX_SENSORS_STACK_SIZE);
+        Scheduler::from(hal.scheduler)->apply_cpu_affinity(_bus.thread, Scheduler::ThreadClass::I2C);
         _bus.thread.start(name, AP_LINUX_SENSORS_SCHED_POLICY,
                           AP_LINUX_SENSORS_SCHED_PRIO);
     }
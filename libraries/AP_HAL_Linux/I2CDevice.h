@@ -57,6 +57,11 @@ public:
     bool transfer(const uint8_t *send, uint32_t send_len,
                   uint8_t *recv, uint32_t recv_len) override;
 
+    /* See AP_HAL::I2CDevice::transfer_batch(). Batches of more than
+     * I2C_RDRW_IOCTL_MAX_MSGS segments are rejected unless transfers
+     * are split */
+    bool transfer_batch(const Segment *segments, uint8_t count) override;
+
     bool read_registers_multiple(uint8_t first_reg, uint8_t *recv,
                                  uint32_t recv_len, uint8_t times) override;
 
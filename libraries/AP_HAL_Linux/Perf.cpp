@@ -26,6 +26,7 @@
 #include "Util.h"
 #include "Perf.h"
 #include "Perf_Lttng.h"
+#include "Trace.h"
 
 #ifndef PRIu64
 #define PRIu64 "llu"
@@ -135,6 +136,7 @@ void Perf::begin(Util::perf_counter_t pc)
     perf.start = now_nsec();
 
     perf.lttng.begin(perf.name);
+    Trace::begin(perf.name);
 }
 
 void Perf::end(Util::perf_counter_t pc)
@@ -184,6 +186,7 @@ void Perf::end(Util::perf_counter_t pc)
     perf.start = 0;
 
     perf.lttng.end(perf.name);
+    Trace::end(perf.name);
 }
 
 void Perf::count(Util::perf_counter_t pc)
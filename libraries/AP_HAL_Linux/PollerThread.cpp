@@ -37,6 +37,16 @@ void TimerPollable::on_can_read()
         return;
     }
 
+    if (_jitter && nevents > 0) {
+        struct itimerspec spec;
+        if (timerfd_gettime(_fd, &spec) == 0) {
+            const uint64_t remaining_usec = spec.it_value.tv_sec * AP_USEC_PER_SEC +
+                spec.it_value.tv_nsec / AP_NSEC_PER_USEC;
+            // time since the first of the expirations we are handling
+            _jitter->record(uint64_t(_period_usec) * nevents - MIN(remaining_usec, uint64_t(_period_usec)));
+        }
+    }
+
     if (_wrapper) {
         _wrapper->start_cb();
     }
@@ -83,6 +93,8 @@ bool TimerPollable::adjust_timer(uint32_t timeout_usec)
         return false;
     }
 
+    _period_usec = timeout_usec;
+
     return true;
 }
 
@@ -93,7 +105,7 @@ TimerPollable *PollerThread::add_timer(TimerPollable::PeriodicCb cb,
     if (!_poller) {
         return nullptr;
     }
-    TimerPollable *p = new TimerPollable(cb, wrapper);
+    TimerPollable *p = new TimerPollable(cb, wrapper, &_jitter);
     if (!p || !p->setup_timer(timeout_usec) ||
         !_poller.register_pollable(p, POLLIN)) {
         delete p;
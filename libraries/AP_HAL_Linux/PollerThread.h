@@ -48,14 +48,17 @@ public:
     bool adjust_timer(uint32_t timeout_usec);
 
 protected:
-    TimerPollable(PeriodicCb cb, WrapperCb *wrapper)
+    TimerPollable(PeriodicCb cb, WrapperCb *wrapper, ThreadJitter *jitter)
         : _cb(cb)
         , _wrapper(wrapper)
+        , _jitter(jitter)
     {
     }
 
     PeriodicCb _cb;
     WrapperCb *_wrapper;
+    ThreadJitter *_jitter;
+    uint32_t _period_usec = 0;
     bool _removeme = false;
 };
 
@@ -70,6 +73,14 @@ public:
                              uint32_t timeout_usec);
     bool adjust_timer(TimerPollable *p, uint32_t timeout_usec);
 
+    /*
+     * Wait for events on @p in addition to the timers. Callbacks run on
+     * this thread, serialized with the timer callbacks.
+     */
+    bool register_pollable(Pollable *p, uint32_t events) { return _poller.register_pollable(p, events); }
+    bool modify_pollable(Pollable *p, uint32_t events) { return _poller.modify_pollable(p, events); }
+    void unregister_pollable(const Pollable *p) { _poller.unregister_pollable(p); }
+
     void mainloop();
 
     bool stop() override;
@@ -35,6 +35,7 @@
 #include "Scheduler.h"
 #include "Semaphores.h"
 #include "Thread.h"
+#include "Trace.h"
 #include "Util.h"
 
 #define DEBUG 0
@@ -269,6 +270,7 @@ bool SPIDevice::set_speed(AP_HAL::Device::Speed speed)
 bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
                          uint8_t *recv, uint32_t recv_len)
 {
+    TraceScope trace("spi");
     struct spi_ioc_transfer msgs[2] = { };
     unsigned nmsgs = 0;
     int fd = _bus.fd[_desc.subdev];
@@ -349,6 +351,7 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
 bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                                     uint32_t len)
 {
+    TraceScope trace("spi");
     struct spi_ioc_transfer msgs[1] = { };
     int fd = _bus.fd[_desc.subdev];
 
@@ -421,6 +424,7 @@ AP_HAL::Device::PeriodicHandle SPIDevice::register_periodic_callback(
         snprintf(name, sizeof(name), "ap-spi-%u", _bus.bus);
 
         _bus.thread.set_stack_size(AP_LINUX_SENSORS_STACK_SIZE);
+        Scheduler::from(hal.scheduler)->apply_cpu_affinity(_bus.thread, Scheduler::ThreadClass::SPI);
         _bus.thread.start(name, AP_LINUX_SENSORS_SCHED_POLICY,
                           AP_LINUX_SENSORS_SCHED_PRIO);
     }
@@ -85,12 +85,56 @@ void SPIUARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
     _initialised = true;
 }
 
-int SPIUARTDriver::_write_fd(const uint8_t *buf, uint16_t size)
+int SPIUARTDriver::_writev_fd(const ByteBuffer::IoVec *vec, uint8_t n)
 {
     if (_external) {
-        return UARTDriver::_write_fd(buf,size);
+        return UARTDriver::_writev_fd(vec, n);
     }
 
+    int total = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        int ret = _write_fd(vec[i].data, vec[i].len);
+        if (ret <= 0) {
+            break;
+        }
+        total += ret;
+        if ((unsigned)ret != vec[i].len) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+int SPIUARTDriver::_readv_fd(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    if (_external) {
+        return UARTDriver::_readv_fd(vec, n);
+    }
+
+    int total = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        int ret = _read_fd(vec[i].data, vec[i].len);
+        if (ret <= 0) {
+            break;
+        }
+        total += ret;
+        if ((unsigned)ret != vec[i].len) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+const SerialDevice *SPIUARTDriver::_pollable_device() const
+{
+    // the SPI side is polled from the tick at its own lower rate
+    return _external ? UARTDriver::_pollable_device() : nullptr;
+}
+
+int SPIUARTDriver::_write_fd(const uint8_t *buf, uint16_t size)
+{
     if (!_dev->get_semaphore()->take_nonblocking()) {
         return 0;
     }
@@ -115,10 +159,6 @@ int SPIUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
 {
     static uint8_t ff_stub[100] = {0xff};
 
-    if (_external) {
-        return UARTDriver::_read_fd(buf, n);
-    }
-
     /* Make SPI transactions shorter. It can save SPI bus from keeping too
      * long. It's essential for NavIO as MPU9250 is on the same bus and
      * doesn't like to be waiting. Making transactions more frequent but shorter
@@ -13,8 +13,12 @@ public:
     void _timer_tick(void) override;
 
 protected:
-    int _write_fd(const uint8_t *buf, uint16_t n) override;
-    int _read_fd(uint8_t *buf, uint16_t n) override;
+    int _writev_fd(const ByteBuffer::IoVec *vec, uint8_t n) override;
+    int _readv_fd(const ByteBuffer::IoVec *vec, uint8_t n) override;
+    const SerialDevice *_pollable_device() const override;
+
+    int _write_fd(const uint8_t *buf, uint16_t n);
+    int _read_fd(uint8_t *buf, uint16_t n);
 
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> _dev;
 
@@ -5,10 +5,12 @@
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
 
+#include <AP_Common/ExpandingString.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
@@ -16,6 +18,7 @@
 #include "RCInput.h"
 #include "SPIUARTDriver.h"
 #include "Storage.h"
+#include "Trace.h"
 #include "UARTDriver.h"
 #include "Util.h"
 
@@ -52,11 +55,107 @@ extern const AP_HAL::HAL& hal;
         .policy = SCHED_FIFO,                                   \
         .prio = APM_LINUX_##UPPER_NAME_##_PRIORITY,             \
         .rate = APM_LINUX_##UPPER_NAME_##_RATE,                 \
+        .cpu_class = ThreadClass::UPPER_NAME_,                  \
     }
 
+static const char *thread_class_names[] = {
+    "main", "timer", "uart", "rcin", "io", "spi", "i2c", "other",
+};
+static_assert(ARRAY_SIZE(thread_class_names) == uint8_t(Scheduler::ThreadClass::COUNT),
+              "thread_class_names must match ThreadClass");
+
 Scheduler::Scheduler()
 { }
 
+/*
+  parse a CPU list such as "0-2,5" into a CPU set. "isolated" selects the
+  CPUs isolated from the kernel scheduler with the isolcpus boot parameter
+ */
+static bool parse_cpu_list(const char *list, cpu_set_t &cpus)
+{
+    CPU_ZERO(&cpus);
+
+    if (strcmp(list, "isolated") == 0) {
+        char buf[128];
+        FILE *f = fopen("/sys/devices/system/cpu/isolated", "r");
+        if (f == nullptr) {
+            return false;
+        }
+        const bool ok = fgets(buf, sizeof(buf), f) != nullptr;
+        fclose(f);
+        if (!ok) {
+            return false;
+        }
+        buf[strcspn(buf, "\n")] = '\0';
+        return parse_cpu_list(buf, cpus);
+    }
+
+    const char *p = list;
+    while (*p != '\0') {
+        char *end;
+        const long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) {
+            return false;
+        }
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first || last >= CPU_SETSIZE) {
+                return false;
+            }
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return false;
+        }
+        p = end;
+    }
+
+    return CPU_COUNT(&cpus) > 0;
+}
+
+bool Scheduler::set_cpu_affinity(const char *spec)
+{
+    const char *cpus = strchr(spec, '=');
+    if (cpus == nullptr) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(thread_class_names); i++) {
+        if (strlen(thread_class_names[i]) == size_t(cpus - spec) &&
+            strncmp(spec, thread_class_names[i], cpus - spec) == 0) {
+            if (!parse_cpu_list(cpus + 1, _cpu_affinity[i])) {
+                return false;
+            }
+            _cpu_affinity_classes |= 1U << i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Scheduler::apply_cpu_affinity(Thread &thread, ThreadClass cls) const
+{
+    if (_cpu_affinity_classes == 0) {
+        // leave placement to the kernel
+        return;
+    }
+
+    // threads inherit the affinity of their creator, so always set it
+    // explicitly to avoid piling everything onto the main thread's CPU
+    if (_cpu_affinity_classes & (1U << uint8_t(cls))) {
+        thread.set_cpu_affinity(_cpu_affinity[uint8_t(cls)]);
+    } else {
+        thread.set_cpu_affinity(_default_cpus);
+    }
+}
+
 
 void Scheduler::init_realtime()
 {
@@ -90,9 +189,9 @@ void Scheduler::init()
         int policy;
         int prio;
         uint32_t rate;
+        ThreadClass cpu_class;
     } sched_table[] = {
         SCHED_THREAD(timer, TIMER),
-        SCHED_THREAD(uart, UART),
         SCHED_THREAD(rcin, RCIN),
         SCHED_THREAD(io, IO),
     };
@@ -101,8 +200,22 @@ void Scheduler::init()
 
     init_realtime();
 
-    /* set barrier to N + 1 threads: worker threads + main */
-    unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
+    if (_cpu_affinity_classes != 0) {
+        CPU_ZERO(&_default_cpus);
+        sched_getaffinity(0, sizeof(_default_cpus), &_default_cpus);
+
+        if (_cpu_affinity_classes & (1U << uint8_t(ThreadClass::MAIN))) {
+            ret = pthread_setaffinity_np(_main_ctx, sizeof(cpu_set_t),
+                                         &_cpu_affinity[uint8_t(ThreadClass::MAIN)]);
+            if (ret != 0) {
+                fprintf(stderr, "Scheduler: failed to set main thread CPU affinity: %s\n",
+                        strerror(ret));
+            }
+        }
+    }
+
+    /* set barrier to N + 2 threads: worker threads + uart + main */
+    unsigned n_threads = ARRAY_SIZE(sched_table) + 2;
     ret = pthread_barrier_init(&_initialized_barrier, nullptr, n_threads);
     if (ret) {
         AP_HAL::panic("Scheduler: Failed to initialise barrier object: %s",
@@ -114,9 +227,23 @@ void Scheduler::init()
 
         t->thread->set_rate(t->rate);
         t->thread->set_stack_size(1024 * 1024);
+        apply_cpu_affinity(*t->thread, t->cpu_class);
         t->thread->start(t->name, t->policy, t->prio);
     }
 
+    /*
+      the UART tick runs from a timer on a poller thread so that UARTs
+      able to wait on their file descriptor are serviced from the same
+      thread as soon as data arrives, rather than on the next tick
+     */
+    if (!_uart_thread.add_timer(FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void),
+                                nullptr, AP_USEC_PER_SEC / APM_LINUX_UART_RATE)) {
+        AP_HAL::panic("Scheduler: failed to create UART timer");
+    }
+    _uart_thread.set_stack_size(1024 * 1024);
+    apply_cpu_affinity(_uart_thread, ThreadClass::UART);
+    _uart_thread.start("ap-uart", SCHED_FIFO, APM_LINUX_UART_PRIORITY);
+
 #if defined(DEBUG_STACK) && DEBUG_STACK
     register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_stack, void));
 #endif
@@ -170,7 +297,20 @@ void Scheduler::delay_microseconds(uint16_t us)
     if (_stopped_clock_usec) {
         return;
     }
+
+    if (!in_main_thread()) {
+        microsleep(us);
+        return;
+    }
+
+    // the main loop sleeps here waiting for the next IMU sample, so
+    // this is where wakeup latency shows up as loop jitter
+    const uint64_t start = AP_HAL::micros64();
+    Trace::begin("sleep");
     microsleep(us);
+    Trace::end("sleep");
+    const uint64_t slept = AP_HAL::micros64() - start;
+    _main_jitter.record(slept > us ? slept - us : 0);
 }
 
 void Scheduler::register_timer_process(AP_HAL::MemberProc proc)
@@ -220,6 +360,8 @@ void Scheduler::_timer_task()
     }
     _in_timer_proc = true;
 
+    TraceScope trace("timer");
+
     // now call the timer based drivers
     for (i = 0; i < _num_timer_procs; i++) {
         if (_timer_proc[i]) {
@@ -239,6 +381,8 @@ void Scheduler::_run_io(void)
 {
     _io_semaphore.take_blocking();
 
+    TraceScope trace("io");
+
     // now call the IO based drivers
     for (int i = 0; i < _num_io_procs; i++) {
         if (_io_proc[i]) {
@@ -262,11 +406,13 @@ void Scheduler::_run_uarts()
 
 void Scheduler::_rcin_task()
 {
+    TraceScope trace("rcin");
     RCInput::from(hal.rcin)->_timer_tick();
 }
 
 void Scheduler::_uart_task()
 {
+    TraceScope trace("uart");
     _run_uarts();
 }
 
@@ -305,6 +451,8 @@ void Scheduler::set_system_initialized()
 
 void Scheduler::reboot(bool hold_in_bootloader)
 {
+    // don't lose changes still waiting for write-back
+    Storage::from(hal.storage)->flush();
     exit(1);
 }
 
@@ -335,6 +483,13 @@ bool Scheduler::SchedulerThread::_run()
     return PeriodicThread::_run();
 }
 
+bool Scheduler::SchedulerPollerThread::_run()
+{
+    _sched._wait_all_threads();
+
+    return PollerThread::_run();
+}
+
 void Scheduler::teardown()
 {
     _timer_thread.stop();
@@ -348,6 +503,29 @@ void Scheduler::teardown()
     _uart_thread.join();
 }
 
+void Scheduler::thread_info(ExpandingString &str)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    pthread_getaffinity_np(_main_ctx, sizeof(cpus), &cpus);
+
+    str.printf("%-15s PRI=%2d CPUS=", "main", APM_LINUX_MAIN_PRIORITY);
+    bool first = true;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &cpus)) {
+            str.printf(first ? "%d" : ",%d", cpu);
+            first = false;
+        }
+    }
+    const ThreadJitter::Stats jitter = _main_jitter.get_stats();
+    str.printf(" WAKE=%u MEAN=%uus MAX=%uus\n",
+               unsigned(jitter.count),
+               unsigned(jitter.mean_usec),
+               unsigned(jitter.max_usec));
+
+    Thread::thread_info(str);
+}
+
 // calculates an integer to be used as the priority for a newly-created thread
 uint8_t Scheduler::calculate_thread_priority(priority_base base, int8_t priority) const
 {
@@ -399,6 +577,33 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
      */
     thread->set_auto_free(true);
 
+    ThreadClass cpu_class = ThreadClass::OTHER;
+    switch (base) {
+    case PRIORITY_SPI:
+        cpu_class = ThreadClass::SPI;
+        break;
+    case PRIORITY_I2C:
+        cpu_class = ThreadClass::I2C;
+        break;
+    case PRIORITY_CAN:
+    case PRIORITY_TIMER:
+        cpu_class = ThreadClass::TIMER;
+        break;
+    case PRIORITY_RCIN:
+        cpu_class = ThreadClass::RCIN;
+        break;
+    case PRIORITY_UART:
+        cpu_class = ThreadClass::UART;
+        break;
+    case PRIORITY_IO:
+    case PRIORITY_STORAGE:
+        cpu_class = ThreadClass::IO;
+        break;
+    default:
+        break;
+    }
+    apply_cpu_affinity(*thread, cpu_class);
+
     if (!thread->start(name, SCHED_FIFO, thread_priority)) {
         delete thread;
         return false;
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <pthread.h>
+#include <sched.h>
 
 #include "AP_HAL_Linux.h"
 
+#include "PollerThread.h"
 #include "Semaphores.h"
 #include "Thread.h"
 
@@ -49,6 +51,46 @@ public:
 
     void teardown();
 
+    /*
+      classes of thread that can be given their own CPU affinity
+     */
+    enum class ThreadClass : uint8_t {
+        MAIN,
+        TIMER,
+        UART,
+        RCIN,
+        IO,
+        SPI,
+        I2C,
+        OTHER,
+        COUNT
+    };
+
+    /*
+      set the CPUs for a class of thread from a "class=cpus" string,
+      e.g. "main=3", "spi=2-3" or "main=isolated". Must be called before
+      init()
+     */
+    bool set_cpu_affinity(const char *spec);
+
+    /*
+      apply the configured CPU affinity to a thread that is about to be
+      started. Threads in a class without an explicit affinity are kept
+      on the CPUs the process started with
+     */
+    void apply_cpu_affinity(Thread &thread, ThreadClass cls) const;
+
+    /*
+      describe the main thread and all other started threads
+     */
+    void thread_info(ExpandingString &str);
+
+    /*
+      thread running the UART ticks. UARTs whose device has a file
+      descriptor register it here to be serviced as soon as data arrives
+     */
+    PollerThread &uart_poller() { return _uart_thread; }
+
     /*
       create a new thread
      */
@@ -68,6 +110,18 @@ private:
         Scheduler &_sched;
     };
 
+    class SchedulerPollerThread : public PollerThread {
+    public:
+        SchedulerPollerThread(Scheduler &sched)
+            : _sched(sched)
+        { }
+
+    protected:
+        bool _run() override;
+
+        Scheduler &_sched;
+    };
+
     void     init_realtime();
 
     void _wait_all_threads();
@@ -93,7 +147,7 @@ private:
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
-    SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
+    SchedulerPollerThread _uart_thread{*this};
 
     void _timer_task();
     void _io_task();
@@ -107,6 +161,15 @@ private:
     uint64_t _last_stack_debug_msec;
     pthread_t _main_ctx;
 
+    // CPUs for each thread class with an explicit affinity
+    cpu_set_t _cpu_affinity[uint8_t(ThreadClass::COUNT)];
+    uint8_t _cpu_affinity_classes;
+    // CPUs the process was started with
+    cpu_set_t _default_cpus;
+
+    // lateness of main thread wakeups from delay_microseconds()
+    ThreadJitter _main_jitter;
+
     Semaphore _io_semaphore;
 };
 
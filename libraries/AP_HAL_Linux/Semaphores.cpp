@@ -1,6 +1,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "Semaphores.h"
+#include "Trace.h"
 
 extern const AP_HAL::HAL& hal;
 
@@ -17,21 +18,54 @@ Semaphore::Semaphore()
 
 bool Semaphore::give()
 {
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::released(_profile);
+    }
+#endif
     return pthread_mutex_unlock(&_lock) == 0;
 }
 
 bool Semaphore::take(uint32_t timeout_ms)
 {
-    if (timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
-        return pthread_mutex_lock(&_lock) == 0;
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::Wait wait(_profile, __builtin_return_address(0));
+        return wait.taken(_take(timeout_ms));
     }
-    if (take_nonblocking()) {
+#endif
+    return _take(timeout_ms);
+}
+
+// override so that profiled sites are our callers rather than the base class
+void Semaphore::take_blocking()
+{
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::Wait wait(_profile, __builtin_return_address(0));
+        wait.taken(_take(HAL_SEMAPHORE_BLOCK_FOREVER));
+        return;
+    }
+#endif
+    _take(HAL_SEMAPHORE_BLOCK_FOREVER);
+}
+
+bool Semaphore::_take(uint32_t timeout_ms)
+{
+    if (pthread_mutex_trylock(&_lock) == 0) {
         return true;
     }
+
+    // only contended takes show up in the trace
+    TraceScope trace("sem wait");
+
+    if (timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
+        return pthread_mutex_lock(&_lock) == 0;
+    }
     uint64_t start = AP_HAL::micros64();
     do {
         hal.scheduler->delay_microseconds(200);
-        if (take_nonblocking()) {
+        if (pthread_mutex_trylock(&_lock) == 0) {
             return true;
         }
     } while ((AP_HAL::micros64() - start) < timeout_ms*1000);
@@ -40,6 +74,11 @@ bool Semaphore::take(uint32_t timeout_ms)
 
 bool Semaphore::take_nonblocking()
 {
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::Wait wait(_profile, __builtin_return_address(0));
+        return wait.taken(pthread_mutex_trylock(&_lock) == 0);
+    }
+#endif
     return pthread_mutex_trylock(&_lock) == 0;
 }
-
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <AP_HAL/AP_HAL_Macros.h>
 #include <AP_HAL/Semaphores.h>
+#include <AP_HAL/utility/SemaphoreProfiler.h>
 #include <pthread.h>
 
 namespace Linux {
@@ -14,8 +15,14 @@ public:
     bool give() override;
     bool take(uint32_t timeout_ms) override;
     bool take_nonblocking() override;
+    void take_blocking() override;
 protected:
+    bool _take(uint32_t timeout_ms);
+
     pthread_mutex_t _lock;
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    SemaphoreProfiler::Hold _profile;
+#endif
 };
 
 }
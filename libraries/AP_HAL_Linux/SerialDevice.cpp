@@ -0,0 +1,53 @@
+#include "SerialDevice.h"
+
+ssize_t SerialDevice::writev(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    ssize_t total = 0;
+
+    for (uint8_t i = 0; i < n; i++) {
+        ssize_t ret = write(vec[i].data, vec[i].len);
+        if (ret < 0) {
+            return total > 0 ? total : ret;
+        }
+        total += ret;
+
+        /* We wrote less than we asked for, stop */
+        if ((size_t)ret != vec[i].len) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+ssize_t SerialDevice::readv(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    ssize_t total = 0;
+
+    for (uint8_t i = 0; i < n; i++) {
+        ssize_t ret = read(vec[i].data, vec[i].len);
+        if (ret < 0) {
+            return total > 0 ? total : ret;
+        }
+        total += ret;
+
+        /* stop reading as we read less than we asked for */
+        if ((size_t)ret != vec[i].len) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+int SerialDevice::_to_iovec(const ByteBuffer::IoVec *vec, uint8_t n, struct iovec iov[MAX_IOVEC])
+{
+    if (n > MAX_IOVEC) {
+        n = MAX_IOVEC;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+    return n;
+}
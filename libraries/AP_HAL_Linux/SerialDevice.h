@@ -2,6 +2,9 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <sys/uio.h>
+
+#include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
 
@@ -13,6 +16,35 @@ public:
     virtual bool close() = 0;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) = 0;
     virtual ssize_t read(uint8_t *buf, uint16_t n) = 0;
+
+    /*
+     * Scatter/gather variants of write() and read() working directly on
+     * the ring buffer parts. The default implementations fall back to one
+     * call per part.
+     */
+    virtual ssize_t writev(const ByteBuffer::IoVec *vec, uint8_t n);
+    virtual ssize_t readv(const ByteBuffer::IoVec *vec, uint8_t n);
+
+    /*
+     * File descriptor that becomes readable when there is data to be read,
+     * or -1 if the device can't be waited on and needs to be polled. It may
+     * change after a call to read() or readv().
+     */
+    virtual int get_fd() const { return -1; }
+
+    /*
+     * Incremented each time the device closes a descriptor it returned
+     * from get_fd(), so a new descriptor can be told apart from an old
+     * one that was given the same number.
+     */
+    uint32_t fd_generation() const { return _fd_generation; }
+
+    /*
+     * True if writes go to the descriptor returned by get_fd(), so it can
+     * also be waited on to become writable.
+     */
+    virtual bool writes_to_fd() const { return true; }
+
     virtual void set_blocking(bool blocking) = 0;
     virtual void set_speed(uint32_t speed) = 0;
     virtual AP_HAL::UARTDriver::flow_control get_flow_control(void) { return AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE; }
@@ -23,4 +55,13 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+protected:
+    uint32_t _fd_generation = 0;
+
+    /* Ring buffers have at most 2 parts */
+    static const uint8_t MAX_IOVEC = 2;
+
+    /* Fill @iov from the ring buffer parts, returning the number of entries */
+    static int _to_iovec(const ByteBuffer::IoVec *vec, uint8_t n, struct iovec iov[MAX_IOVEC]);
 };
@@ -171,6 +171,7 @@ void Storage::init()
     }
 
     _fd = fd;
+    _writeback.set_medium("File", LINUX_STORAGE_SIZE);
     _initialised = true;
 }
 
@@ -212,12 +213,20 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
         init();
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _writeback.dirtied(loc, n, AP_HAL::millis());
     }
 }
 
 void Storage::_timer_tick(void)
 {
-    if (!_initialised || _dirty_mask == 0 || _fd == -1) {
+    if (!_initialised || _fd == -1) {
+        return;
+    }
+    if (_dirty_mask == 0) {
+        _writeback.clean();
+        return;
+    }
+    if (!_writeback.flush_due(AP_HAL::millis())) {
         return;
     }
 
@@ -257,6 +266,8 @@ void Storage::_timer_tick(void)
             _dirty_mask |= write_mask;
             close(_fd);
             _fd = -1;
+        } else {
+            _writeback.wrote(i<<LINUX_STORAGE_LINE_SHIFT, n<<LINUX_STORAGE_LINE_SHIFT);
         }
         if (_dirty_mask == 0) {
             if (fsync(_fd) != 0) {
@@ -266,3 +277,18 @@ void Storage::_timer_tick(void)
         }
     }
 }
+
+/*
+  write back the whole buffer if anything is dirty. This uses pwrite()
+  so it can't disturb the file offset of a concurrent _timer_tick()
+ */
+void Storage::flush(void)
+{
+    if (!_initialised || _fd == -1 || _dirty_mask == 0) {
+        return;
+    }
+    if (pwrite(_fd, _buffer, sizeof(_buffer), 0) == sizeof(_buffer)) {
+        _writeback.wrote(0, sizeof(_buffer));
+        fsync(_fd);
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/StorageWriteback.h>
 
 #define LINUX_STORAGE_SIZE HAL_STORAGE_SIZE
 #define LINUX_STORAGE_MAX_WRITE 512
@@ -33,6 +34,10 @@ public:
     void write_block(uint16_t dst, const void* src, size_t n) override;
 
     virtual void _timer_tick(void) override;
+    void storage_info(ExpandingString &str) override { _writeback.info(str); }
+
+    // write back all dirty lines now, used before a reboot
+    void flush(void) override;
 
 protected:
     void _mark_dirty(uint16_t loc, uint16_t length);
@@ -42,6 +47,7 @@ protected:
     volatile bool _initialised;
     volatile uint32_t _dirty_mask;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+    StorageWriteback _writeback;
 };
 
 }
@@ -38,25 +38,66 @@ ssize_t TCPServerDevice::write(const uint8_t *buf, uint16_t n)
  */
 ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
 {
-    if (sock == nullptr) {
-        sock = listener.accept(0);
-        if (sock != nullptr) {
-            sock->set_blocking(_blocking);
-        }
+    if (!_accept()) {
+        return -1;
     }
+    ssize_t ret = sock->recv(buf, n, 1);
+    if (ret == 0) {
+        // EOF, go back to waiting for a new connection
+        delete sock;
+        sock = nullptr;
+        _fd_generation++;
+        return -1;
+    }
+    return ret;
+}
+
+ssize_t TCPServerDevice::writev(const ByteBuffer::IoVec *vec, uint8_t n)
+{
     if (sock == nullptr) {
         return -1;
     }
-    ssize_t ret = sock->recv(buf, n, 1);
+
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    return sock->sendv(iov, iovcnt);
+}
+
+ssize_t TCPServerDevice::readv(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    if (!_accept()) {
+        return -1;
+    }
+
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    ssize_t ret = sock->recvv(iov, iovcnt);
     if (ret == 0) {
         // EOF, go back to waiting for a new connection
         delete sock;
         sock = nullptr;
+        _fd_generation++;
         return -1;
     }
     return ret;
 }
 
+/*
+  accept a new connection if one isn't already established
+ */
+bool TCPServerDevice::_accept()
+{
+    if (sock == nullptr) {
+        sock = listener.accept(0);
+        if (sock != nullptr) {
+            sock->set_blocking(_blocking);
+        }
+    }
+    return sock != nullptr;
+}
+
 bool TCPServerDevice::open()
 {
     listener.reuseaddress();
@@ -105,6 +146,7 @@ bool TCPServerDevice::close()
     if (sock != nullptr) {
         delete sock;
         sock = nullptr;
+        _fd_generation++;
     }
     return true;
 }
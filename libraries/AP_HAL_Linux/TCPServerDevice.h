@@ -14,8 +14,18 @@ public:
     virtual void set_speed(uint32_t speed) override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual ssize_t writev(const ByteBuffer::IoVec *vec, uint8_t n) override;
+    virtual ssize_t readv(const ByteBuffer::IoVec *vec, uint8_t n) override;
+
+    /* wait on the listener until a client connects */
+    virtual int get_fd() const override
+    {
+        return sock != nullptr ? sock->get_fd() : listener.get_fd();
+    }
 
 private:
+    bool _accept();
+
     SocketAPM listener{false};
     SocketAPM *sock = nullptr;
     const char *_ip;
@@ -20,9 +20,11 @@
 #include <limits.h>
 #include <sys/types.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <utility>
 
+#include <AP_Common/ExpandingString.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
@@ -34,6 +36,20 @@ extern const AP_HAL::HAL &hal;
 
 namespace Linux {
 
+Thread *Thread::_first;
+pthread_mutex_t Thread::_list_lock = PTHREAD_MUTEX_INITIALIZER;
+
+Thread::~Thread()
+{
+    pthread_mutex_lock(&_list_lock);
+    for (Thread **t = &_first; *t != nullptr; t = &(*t)->_next) {
+        if (*t == this) {
+            *t = _next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_list_lock);
+}
 
 void *Thread::_run_trampoline(void *arg)
 {
@@ -191,6 +207,18 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
+    if (_has_cpu_affinity &&
+        (r = pthread_attr_setaffinity_np(&attr, sizeof(_cpu_affinity), &_cpu_affinity)) != 0) {
+        fprintf(stderr, "Failed to set CPU affinity for thread '%s': %s\n",
+                name ? name : "", strerror(r));
+    }
+
+    // the thread may be reported as soon as it runs
+    if (name) {
+        strncpy(_name, name, sizeof(_name) - 1);
+    }
+    _prio = prio;
+
     r = pthread_create(&_ctx, &attr, &Thread::_run_trampoline, this);
     if (r != 0) {
         AP_HAL::panic("Failed to create thread '%s': %s",
@@ -202,11 +230,64 @@ bool Thread::start(const char *name, int policy, int prio)
         pthread_setname_np(_ctx, name);
     }
 
+    pthread_mutex_lock(&_list_lock);
+    Thread *t = _first;
+    while (t != nullptr && t != this) {
+        t = t->_next;
+    }
+    if (t == nullptr) {
+        _next = _first;
+        _first = this;
+    }
+    pthread_mutex_unlock(&_list_lock);
+
     _started = true;
 
     return true;
 }
 
+bool Thread::set_cpu_affinity(const cpu_set_t &cpus)
+{
+    if (_started || CPU_COUNT(&cpus) == 0) {
+        return false;
+    }
+
+    _cpu_affinity = cpus;
+    _has_cpu_affinity = true;
+
+    return true;
+}
+
+void Thread::thread_info(ExpandingString &str)
+{
+    pthread_mutex_lock(&_list_lock);
+    for (Thread *t = _first; t != nullptr; t = t->_next) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        if (!t->_started || pthread_getaffinity_np(t->_ctx, sizeof(cpus), &cpus) != 0) {
+            continue;
+        }
+        str.printf("%-15s PRI=%2d CPUS=", t->_name[0] ? t->_name : "?", t->_prio);
+        // print the CPU mask as a list, e.g. 0,2,3
+        bool first = true;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &cpus)) {
+                str.printf(first ? "%d" : ",%d", cpu);
+                first = false;
+            }
+        }
+        const ThreadJitter::Stats jitter = t->_jitter.get_stats();
+        if (jitter.count > 0) {
+            str.printf(" WAKE=%u MEAN=%uus MAX=%uus",
+                       unsigned(jitter.count),
+                       unsigned(jitter.mean_usec),
+                       unsigned(jitter.max_usec));
+        }
+        str.printf("\n");
+    }
+    pthread_mutex_unlock(&_list_lock);
+}
+
 bool Thread::is_current_thread()
 {
     return pthread_equal(pthread_self(), _ctx);
@@ -266,6 +347,8 @@ bool PeriodicThread::_run()
             next_run_usec = AP_HAL::micros64();
         } else {
             Scheduler::from(hal.scheduler)->microsleep(dt);
+            const uint64_t now = AP_HAL::micros64();
+            _jitter.record(now > next_run_usec ? now - next_run_usec : 0);
         }
         next_run_usec += _period_usec;
 
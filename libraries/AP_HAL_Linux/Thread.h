@@ -16,14 +16,67 @@
  */
 #pragma once
 
+#include <atomic>
 #include <pthread.h>
+#include <sched.h>
 #include <inttypes.h>
 #include <stdlib.h>
 
 #include <AP_HAL/utility/functor.h>
 
+class ExpandingString;
+
 namespace Linux {
 
+/*
+ * Wakeup latency statistics. Only updated by the thread being measured.
+ * The update is bracketed by a sequence count so that readers on other
+ * threads take a consistent snapshot, retrying if it changed while
+ * reading, and never see the 64-bit total half written.
+ */
+class ThreadJitter {
+public:
+    void record(uint32_t late_usec)
+    {
+        // an odd sequence count marks an update in progress
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _count++;
+        _total_usec += late_usec;
+        if (late_usec > _max_usec) {
+            _max_usec = late_usec;
+        }
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    struct Stats {
+        uint32_t count;
+        uint32_t mean_usec;
+        uint32_t max_usec;
+    };
+
+    Stats get_stats() const
+    {
+        uint32_t seq, count, max_usec;
+        uint64_t total_usec;
+        do {
+            seq = _seq.load(std::memory_order_acquire);
+            count = _count;
+            max_usec = _max_usec;
+            total_usec = _total_usec;
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) || seq != _seq.load(std::memory_order_relaxed));
+        return Stats { count, count ? uint32_t(total_usec / count) : 0, max_usec };
+    }
+
+private:
+    std::atomic<uint32_t> _seq;
+    uint32_t _count;
+    uint32_t _max_usec;
+    uint64_t _total_usec;
+};
+
 /*
  * Interface abstracting threads
  */
@@ -33,10 +86,22 @@ public:
 
     Thread(task_t t) : _task(t) { }
 
-    virtual ~Thread() { }
+    virtual ~Thread();
 
     bool start(const char *name, int policy, int prio);
 
+    /*
+     * Restrict the CPUs the thread may run on. Must be called before start().
+     */
+    bool set_cpu_affinity(const cpu_set_t &cpus);
+
+    ThreadJitter &get_jitter() { return _jitter; }
+
+    /*
+     * Describe all started threads for @SYS/threads.txt
+     */
+    static void thread_info(ExpandingString &str);
+
     bool is_current_thread();
 
     bool is_started() const { return _started; }
@@ -75,6 +140,17 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+
+    char _name[16] {};
+    int _prio = 0;
+    bool _has_cpu_affinity = false;
+    cpu_set_t _cpu_affinity;
+    ThreadJitter _jitter {};
+
+    /* list of started threads, for reporting */
+    Thread *_next = nullptr;
+    static Thread *_first;
+    static pthread_mutex_t _list_lock;
 };
 
 class PeriodicThread : public Thread {
@@ -0,0 +1,213 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
+
+using namespace Linux;
+
+uint32_t Trace::_events_per_thread;
+Trace::Buffer *Trace::_first;
+pthread_mutex_t Trace::_list_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t Trace::_buffer_key;
+thread_local Trace::Buffer *Trace::_buffer;
+
+static inline uint64_t now_nsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_nsec + (ts.tv_sec * AP_NSEC_PER_SEC);
+}
+
+/*
+  write a string as a JSON string body, escaping quotes, backslashes
+  and control characters
+ */
+static void print_json_string(ExpandingString &str, const char *s)
+{
+    for (; *s != '\0'; s++) {
+        const uint8_t c = *s;
+        if (c == '"' || c == '\\') {
+            str.printf("\\%c", c);
+        } else if (c < 0x20) {
+            str.printf("\\u%04x", unsigned(c));
+        } else {
+            str.append((const char *)&c, 1);
+        }
+    }
+}
+
+void Trace::enable(uint32_t events_per_thread)
+{
+    if (pthread_key_create(&_buffer_key, &Trace::_release_buffer) != 0) {
+        return;
+    }
+    _events_per_thread = events_per_thread;
+}
+
+Trace::Buffer *Trace::_create_buffer()
+{
+    const pid_t tid = syscall(SYS_gettid);
+
+    // take over the buffer of a thread that has exited if there is one.
+    // The exporter holds the lock while reading, so it can't see the
+    // buffer being reset
+    pthread_mutex_lock(&_list_lock);
+    Buffer *buf = _first;
+    while (buf != nullptr && !buf->released) {
+        buf = buf->next;
+    }
+    if (buf != nullptr) {
+        buf->count = 0;
+        buf->tid = tid;
+        buf->released = false;
+    }
+    pthread_mutex_unlock(&_list_lock);
+
+    if (buf == nullptr) {
+        buf = new Buffer;
+        buf->events = new Event[_events_per_thread];
+        buf->count = 0;
+        buf->tid = tid;
+        buf->released = false;
+
+        pthread_mutex_lock(&_list_lock);
+        buf->next = _first;
+        _first = buf;
+        pthread_mutex_unlock(&_list_lock);
+    }
+
+    // have the buffer released when the thread exits
+    pthread_setspecific(_buffer_key, buf);
+
+    return buf;
+}
+
+/*
+  called on a thread as it exits
+ */
+void Trace::_release_buffer(void *buf)
+{
+    _buffer = nullptr;
+
+    pthread_mutex_lock(&_list_lock);
+    ((Buffer *)buf)->released = true;
+    pthread_mutex_unlock(&_list_lock);
+}
+
+void Trace::_record(const char *name, EventType type)
+{
+    Buffer *buf = _buffer;
+    if (buf == nullptr) {
+        buf = _buffer = _create_buffer();
+    }
+
+    const uint32_t n = buf->count.load(std::memory_order_relaxed);
+    Event &ev = buf->events[n % _events_per_thread];
+    ev.time_nsec = now_nsec();
+    ev.name = name;
+    ev.type = type;
+
+    // publish the event to the exporter
+    buf->count.store(n + 1, std::memory_order_release);
+}
+
+/*
+  export the events of one thread. The owner keeps recording meanwhile,
+  so copy the ring first and then drop anything that may have been
+  overwritten while copying
+ */
+void Trace::_export_buffer(ExpandingString &str, const Buffer &buf, Event *snapshot, bool first_thread)
+{
+    const uint32_t count = buf.count.load(std::memory_order_acquire);
+    const uint32_t first = count > _events_per_thread ? count - _events_per_thread : 0;
+
+    for (uint32_t i = first; i < count; i++) {
+        snapshot[i - first] = buf.events[i % _events_per_thread];
+    }
+
+    // the slot being written after count2 is that of count2 - N
+    const uint32_t count2 = buf.count.load(std::memory_order_acquire);
+    const uint32_t valid = count2 >= _events_per_thread ? count2 - _events_per_thread + 1 : 0;
+
+    char name[32];
+    snprintf(name, sizeof(name), "tid %d", int(buf.tid));
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/comm", int(buf.tid));
+    FILE *f = fopen(path, "r");
+    if (f != nullptr) {
+        if (fgets(name, sizeof(name), f) != nullptr) {
+            name[strcspn(name, "\n")] = '\0';
+        }
+        fclose(f);
+    }
+
+    str.printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+               "\"args\":{\"name\":\"",
+               first_thread ? "" : ",\n", int(getpid()), int(buf.tid));
+    print_json_string(str, name);
+    str.printf("\"}}");
+
+    // spans whose begin was overwritten can't be closed
+    uint32_t depth = 0;
+    for (uint32_t i = MAX(first, valid); i < count; i++) {
+        const Event &ev = snapshot[i - first];
+        if (ev.type == END) {
+            if (depth == 0) {
+                continue;
+            }
+            depth--;
+        } else {
+            depth++;
+        }
+        str.printf(",\n{\"name\":\"");
+        print_json_string(str, ev.name);
+        str.printf("\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64 ".%03u}",
+                   ev.type == BEGIN ? 'B' : 'E', int(getpid()), int(buf.tid),
+                   ev.time_nsec / 1000, unsigned(ev.time_nsec % 1000));
+    }
+}
+
+void Trace::export_json(ExpandingString &str)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    Event *snapshot = new Event[_events_per_thread];
+    if (snapshot == nullptr) {
+        return;
+    }
+
+    str.printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    pthread_mutex_lock(&_list_lock);
+    for (const Buffer *buf = _first; buf != nullptr; buf = buf->next) {
+        _export_buffer(str, *buf, snapshot, buf == _first);
+    }
+    pthread_mutex_unlock(&_list_lock);
+
+    str.printf("\n]}\n");
+
+    delete[] snapshot;
+}
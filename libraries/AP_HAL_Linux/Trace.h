@@ -0,0 +1,114 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "AP_HAL_Linux.h"
+
+class ExpandingString;
+
+namespace Linux {
+
+/*
+ * Flight recorder of named spans. Each thread records into its own ring
+ * of the most recent events, with no locking on the recording side, and
+ * the rings can be exported at any time as a Chrome/Perfetto trace.
+ *
+ * Names must outlive the trace, e.g. string literals or task names.
+ */
+class Trace {
+public:
+    /*
+     * Start recording, keeping the last @events_per_thread events of each
+     * thread. Must be called before any other thread is started. The
+     * buffer of a thread that exits is reused by the next new thread, so
+     * there are only as many as the most threads alive at once.
+     */
+    static void enable(uint32_t events_per_thread);
+
+    static bool enabled() { return _events_per_thread != 0; }
+
+    static void begin(const char *name)
+    {
+        if (enabled()) {
+            _record(name, BEGIN);
+        }
+    }
+
+    static void end(const char *name)
+    {
+        if (enabled()) {
+            _record(name, END);
+        }
+    }
+
+    /*
+     * Write the events of all threads in Chrome JSON trace format
+     */
+    static void export_json(ExpandingString &str);
+
+private:
+    enum EventType : uint8_t {
+        BEGIN,
+        END,
+    };
+
+    struct Event {
+        uint64_t time_nsec;
+        const char *name;
+        EventType type;
+    };
+
+    struct Buffer {
+        Event *events;
+        // number of events ever recorded, only written by the owner thread
+        std::atomic<uint32_t> count;
+        pid_t tid;
+        // the owner thread has exited, the buffer is kept for export
+        // until another thread takes it over
+        bool released;
+        Buffer *next;
+    };
+
+    static void _record(const char *name, EventType type);
+    static Buffer *_create_buffer();
+    static void _release_buffer(void *buf);
+    static void _export_buffer(ExpandingString &str, const Buffer &buf, Event *snapshot,
+                               bool first_thread);
+
+    static uint32_t _events_per_thread;
+    static Buffer *_first;
+    static pthread_mutex_t _list_lock;
+    static pthread_key_t _buffer_key;
+    static thread_local Buffer *_buffer;
+};
+
+/*
+ * Span covering the enclosing scope
+ */
+class TraceScope {
+public:
+    TraceScope(const char *name) : _name(name) { Trace::begin(_name); }
+    ~TraceScope() { Trace::end(_name); }
+
+private:
+    const char *_name;
+};
+
+}
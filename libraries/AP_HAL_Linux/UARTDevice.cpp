@@ -4,6 +4,7 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <stdio.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -24,6 +25,7 @@ bool UARTDevice::close()
         if (::close(_fd) < 0) {
             return false;
         }
+        _fd_generation++;
     }
 
     _fd = -1;
@@ -67,6 +69,31 @@ ssize_t UARTDevice::write(const uint8_t *buf, uint16_t n)
     return ret;
 }
 
+ssize_t UARTDevice::readv(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    return ::readv(_fd, iov, iovcnt);
+}
+
+ssize_t UARTDevice::writev(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    struct pollfd fds;
+    fds.fd = _fd;
+    fds.events = POLLOUT;
+    fds.revents = 0;
+
+    if (poll(&fds, 1, 0) != 1) {
+        return 0;
+    }
+
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    return ::writev(_fd, iov, iovcnt);
+}
+
 void UARTDevice::set_blocking(bool blocking)
 {
     int flags = fcntl(_fd, F_GETFL, 0);
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -20,6 +21,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "ConsoleDevice.h"
+#include "Scheduler.h"
 #include "TCPServerDevice.h"
 #include "UARTDevice.h"
 #include "UDPDevice.h"
@@ -220,6 +222,8 @@ void UARTDriver::end()
         hal.scheduler->delay(1);
     }
 
+    _unregister_pollable();
+    _poll_failed_fd = -1;
     _device->close();
     _deallocate_buffers();
 }
@@ -354,9 +358,9 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
 }
 
 /*
-  try writing n bytes, handling an unresponsive port
+  try writing the ring buffer parts, handling an unresponsive port
  */
-int UARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
+int UARTDriver::_writev_fd(const ByteBuffer::IoVec *vec, uint8_t n)
 {
     /*
       allow for delayed connection. This allows ArduPilot to start
@@ -369,15 +373,15 @@ int UARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
         return 0;
     }
 
-    return _device->write(buf, n);
+    return _device->writev(vec, n);
 }
 
 /*
-  try reading n bytes, handling an unresponsive port
+  try reading into the ring buffer parts, handling an unresponsive port
  */
-int UARTDriver::_read_fd(uint8_t *buf, uint16_t n)
+int UARTDriver::_readv_fd(const ByteBuffer::IoVec *vec, uint8_t n)
 {
-    return _device->read(buf, n);
+    return _device->readv(vec, n);
 }
 
 
@@ -397,30 +401,15 @@ bool UARTDriver::_write_pending_bytes(void)
     }
 
     if (n > 0) {
-        int ret;
-
-        if (_packetise) {
-            // keep as a single UDP packet
-            uint8_t tmpbuf[n];
-            _writebuf.peekbytes(tmpbuf, n);
-            ret = _write_fd(tmpbuf, n);
-            if (ret > 0)
-                _writebuf.advance(ret);
-        } else {
-            ByteBuffer::IoVec vec[2];
-            const auto n_vec = _writebuf.peekiovec(vec, n);
-            for (int i = 0; i < n_vec; i++) {
-                ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
-                if (ret < 0) {
-                    break;
-                }
-                _writebuf.advance(ret);
-
-                /* We wrote less than we asked for, stop */
-                if ((unsigned)ret != vec[i].len) {
-                    break;
-                }
-            }
+        /*
+          both parts go out in one call, so a packet wrapping around
+          the end of the buffer is still sent as a single UDP packet
+         */
+        ByteBuffer::IoVec vec[2];
+        const auto n_vec = _writebuf.peekiovec(vec, n);
+        const int ret = _writev_fd(vec, n_vec);
+        if (ret > 0) {
+            _writebuf.advance(ret);
         }
     }
 
@@ -428,41 +417,219 @@ bool UARTDriver::_write_pending_bytes(void)
 }
 
 /*
-  push any pending bytes to/from the serial port. This is called at
-  1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  push out pending bytes until the device stops taking them
+  return true if progress is made
  */
-void UARTDriver::_timer_tick(void)
+bool UARTDriver::_write_pending()
 {
-    if (!_initialised) return;
-
-    _in_timer = true;
+    const uint32_t available_bytes = _writebuf.available();
 
     uint8_t num_send = 10;
     while (num_send != 0 && _write_pending_bytes()) {
         num_send--;
     }
 
-    // try to fill the read buffer
-    int ret;
+    return _writebuf.available() != available_bytes;
+}
+
+/*
+  read as much as there is room for directly into the read buffer
+  return the number of bytes read or the error from the device
+ */
+int UARTDriver::_fill_read_buffer()
+{
     ByteBuffer::IoVec vec[2];
 
     const auto n_vec = _readbuf.reserve(vec, _readbuf.space());
-    for (int i = 0; i < n_vec; i++) {
-        ret = _read_fd(vec[i].data, vec[i].len);
-        if (ret < 0) {
-            break;
-        }
+    if (n_vec == 0) {
+        return 0;
+    }
+
+    const int ret = _readv_fd(vec, n_vec);
+    if (ret > 0) {
         _readbuf.commit((unsigned)ret);
 
         // update receive timestamp
         _receive_timestamp[_receive_timestamp_idx^1] = AP_HAL::micros64();
         _receive_timestamp_idx ^= 1;
-        
-        /* stop reading as we read less than we asked for */
-        if ((unsigned)ret < vec[i].len) {
-            break;
+    }
+
+    return ret;
+}
+
+/*
+  wait on the device file descriptor from the UART thread, following
+  it when it changes, e.g. when a TCP client connects
+ */
+void UARTDriver::_update_pollable()
+{
+    const SerialDevice *device = _pollable_device();
+    if (device == nullptr) {
+        _unregister_pollable();
+        return;
+    }
+
+    const int fd = device->get_fd();
+    const uint32_t generation = device->fd_generation();
+    if (generation != _poll_generation) {
+        /*
+          the device closed the descriptor we knew, which took it out of
+          the poller. Its number may since have been reused, by this
+          device or another one, so it must not be unregistered
+         */
+        _poll_generation = generation;
+        _forget_pollable();
+        _poll_failed_fd = -1;
+    }
+    if (_pollable_registered() && fd == _pollable.get_fd()) {
+        return;
+    }
+
+    _unregister_pollable();
+
+    if (fd < 0 || fd == _poll_failed_fd) {
+        return;
+    }
+    _poll_failed_fd = -1;
+
+    _pollable.set_fd(fd);
+    if (!Scheduler::from(hal.scheduler)->uart_poller().register_pollable(&_pollable, EPOLLIN)) {
+        // e.g. regular files, keep polling from the tick
+        _poll_failed_fd = fd;
+        _pollable.set_fd(-1);
+        return;
+    }
+    _poll_registered = true;
+    _poll_events = EPOLLIN;
+}
+
+void UARTDriver::_unregister_pollable()
+{
+    if (!_pollable_registered()) {
+        return;
+    }
+
+    Scheduler::from(hal.scheduler)->uart_poller().unregister_pollable(&_pollable);
+    _forget_pollable();
+}
+
+void UARTDriver::_forget_pollable()
+{
+    _pollable.set_fd(-1);
+    _poll_registered = false;
+    _poll_events = 0;
+}
+
+void UARTDriver::_set_poll_events(uint32_t events)
+{
+    if (!_pollable_registered() || events == _poll_events) {
+        return;
+    }
+
+    if (Scheduler::from(hal.scheduler)->uart_poller().modify_pollable(&_pollable, events)) {
+        _poll_events = events;
+    }
+}
+
+/*
+  called from the UART thread as soon as data arrives, or when the
+  device reports an error or hang up
+ */
+void UARTDriver::_on_device_event()
+{
+    if (!_initialised || !_pollable_registered()) {
+        return;
+    }
+
+    _in_timer = true;
+
+    const int fd = _pollable.get_fd();
+
+    if (_readbuf.space() == 0) {
+        /*
+          an error or hang up while we wait for the buffer to drain,
+          leave the device to the tick rather than spin on it
+         */
+        if (!(_poll_events & EPOLLIN)) {
+            _poll_failed_fd = fd;
+            _unregister_pollable();
+        } else {
+            // stop waiting for data until the tick finds room for it
+            _set_poll_events(_poll_events & ~EPOLLIN);
         }
+    } else {
+        errno = 0;
+        const int ret = _fill_read_buffer();
+        const SerialDevice *device = _pollable_device();
+
+        if (device == nullptr || device->get_fd() != fd ||
+            device->fd_generation() != _poll_generation) {
+            _update_pollable();
+        } else if (ret == 0 ||
+                   (ret < 0 && (errno == EIO || errno == EBADF ||
+                                errno == ENXIO || errno == ENODEV))) {
+            /*
+              end of file or the device went away: the descriptor
+              would stay readable, so go back to polling from the tick
+             */
+            _poll_failed_fd = fd;
+            _unregister_pollable();
+        }
+    }
+
+    // send replies without waiting for the next tick
+    _write_pending();
+
+    _in_timer = false;
+}
+
+/*
+  called from the UART thread when a device that pushed back on a write
+  can take more data
+ */
+void UARTDriver::_on_can_write()
+{
+    if (!_initialised || !_pollable_registered()) {
+        return;
+    }
+
+    _in_timer = true;
+
+    if (!_write_pending() || _writebuf.available() == 0) {
+        // done, or the device keeps refusing: leave it to the tick
+        _set_poll_events(_poll_events & ~EPOLLOUT);
+    }
+
+    _in_timer = false;
+}
+
+/*
+  push any pending bytes to/from the serial port. This is called at
+  100Hz from the UART thread. Doing it this way reduces the system call
+  overhead in the main task enormously.
+
+  Devices with a file descriptor are read from as soon as data arrives
+  instead, see _on_device_event(), so idle ports cost nothing here.
+ */
+void UARTDriver::_timer_tick(void)
+{
+    if (!_initialised) return;
+
+    _in_timer = true;
+
+    _update_pollable();
+
+    if (!_write_pending() && _writebuf.available() > 0 && !_packetise &&
+        _pollable_registered() && _pollable_device()->writes_to_fd()) {
+        // the device is pushing back, have it tell us when it drains
+        _set_poll_events(_poll_events | EPOLLOUT);
+    }
+
+    if (!_pollable_registered()) {
+        // try to fill the read buffer
+        _fill_read_buffer();
+    } else if (!(_poll_events & EPOLLIN) && _readbuf.space() > 0) {
+        _set_poll_events(_poll_events | EPOLLIN);
     }
 
     _in_timer = false;
@@ -4,6 +4,7 @@
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 #include "Semaphores.h"
 
@@ -70,6 +71,26 @@ public:
     uint64_t receive_time_constraint_us(uint16_t nbytes) override;
 
 private:
+    /*
+      forwards events on the device file descriptor, which stays owned
+      by the device, to the driver
+     */
+    class DevicePollable : public Pollable {
+    public:
+        DevicePollable(UARTDriver &uart) : _uart(uart) { }
+        ~DevicePollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _uart._on_device_event(); }
+        void on_can_write() override { _uart._on_can_write(); }
+        void on_error() override { _uart._on_device_event(); }
+        void on_hang_up() override { _uart._on_device_event(); }
+
+    private:
+        UARTDriver &_uart;
+    };
+
     AP_HAL::OwnPtr<SerialDevice> _device;
     bool _nonblocking_writes;
     bool _console;
@@ -90,6 +111,29 @@ private:
     uint64_t _receive_timestamp[2];
     uint8_t _receive_timestamp_idx;
 
+    // registered with the UART thread's poller while the device has a
+    // file descriptor that can be waited on
+    DevicePollable _pollable{*this};
+    bool _poll_registered = false;
+    // SerialDevice::fd_generation() of the registered descriptor
+    uint32_t _poll_generation = 0;
+    uint32_t _poll_events = 0;
+    // descriptor epoll refused or that reached end of file, polled from
+    // the tick instead
+    int _poll_failed_fd = -1;
+
+    bool _pollable_registered() const { return _poll_registered; }
+    void _update_pollable();
+    void _unregister_pollable();
+    void _forget_pollable();
+    void _set_poll_events(uint32_t events);
+
+    void _on_device_event();
+    void _on_can_write();
+
+    int _fill_read_buffer();
+    bool _write_pending();
+
 protected:
     const char *device_path;
     volatile bool _initialised;
@@ -99,8 +143,15 @@ protected:
     ByteBuffer _readbuf{0};
     ByteBuffer _writebuf{0};
 
-    virtual int _write_fd(const uint8_t *buf, uint16_t n);
-    virtual int _read_fd(uint8_t *buf, uint16_t n);
+    virtual int _writev_fd(const ByteBuffer::IoVec *vec, uint8_t n);
+    virtual int _readv_fd(const ByteBuffer::IoVec *vec, uint8_t n);
+
+    /*
+      device whose descriptor the UART thread waits on, or nullptr for
+      drivers that move their data some other way and are polled from
+      the tick
+     */
+    virtual const SerialDevice *_pollable_device() const { return _device.get(); }
 
     Linux::Semaphore _write_mutex;
 };
@@ -37,14 +37,54 @@ ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
 {
     ssize_t ret = socket.recv(buf, n, 0);
     if (!_connected && ret > 0) {
-        const char *ip;
-        uint16_t port;
-        socket.last_recv_address(ip, port);
-        _connected = socket.connect(ip, port);
+        _connect_to_sender();
     }
     return ret;
 }
 
+/*
+  the whole packet goes out as a single datagram, split over the ring
+  buffer parts
+ */
+ssize_t UDPDevice::writev(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    if (_connected) {
+        return socket.sendv(iov, iovcnt);
+    }
+    if (_input) {
+        // can't send yet
+        return -1;
+    }
+    return socket.sendtov(iov, iovcnt, _ip, _port);
+}
+
+/*
+  a datagram is received whole even when it wraps around the end of the
+  ring buffer
+ */
+ssize_t UDPDevice::readv(const ByteBuffer::IoVec *vec, uint8_t n)
+{
+    struct iovec iov[MAX_IOVEC];
+    const int iovcnt = _to_iovec(vec, n, iov);
+
+    ssize_t ret = socket.recvv(iov, iovcnt);
+    if (!_connected && ret > 0) {
+        _connect_to_sender();
+    }
+    return ret;
+}
+
+void UDPDevice::_connect_to_sender()
+{
+    const char *ip;
+    uint16_t port;
+    socket.last_recv_address(ip, port);
+    _connected = socket.connect(ip, port);
+}
+
 bool UDPDevice::open()
 {
     if (_input) {
@@ -14,7 +14,12 @@ public:
     virtual void set_speed(uint32_t speed) override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual ssize_t writev(const ByteBuffer::IoVec *vec, uint8_t n) override;
+    virtual ssize_t readv(const ByteBuffer::IoVec *vec, uint8_t n) override;
+    virtual int get_fd() const override { return socket.get_fd(); }
 private:
+    void _connect_to_sender();
+
     SocketAPM socket{true};
     const char *_ip;
     uint16_t _port;
@@ -10,6 +10,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "Heat_Pwm.h"
+#include "Scheduler.h"
 #include "ToneAlarm_Disco.h"
 #include "Util.h"
 
@@ -23,6 +24,15 @@ ToneAlarm_Disco Util::_toneAlarm;
 ToneAlarm Util::_toneAlarm;
 #endif
 
+/*
+  display scheduling, CPU affinity and wakeup jitter of our threads as text
+  buffer for @SYS/threads.txt
+ */
+void Util::thread_info(ExpandingString &str)
+{
+    Scheduler::from(hal.scheduler)->thread_info(str);
+}
+
 void Util::init(int argc, char * const *argv) {
     saved_argc = argc;
     saved_argv = argv;
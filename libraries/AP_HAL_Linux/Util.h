@@ -2,6 +2,7 @@
 
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/SemaphoreProfiler.h>
 
 #include "Heat.h"
 #include "Perf.h"
@@ -10,6 +11,7 @@
 #endif
 #include "ToneAlarm.h"
 #include "Semaphores.h"
+#include "Trace.h"
 
 namespace Linux {
 
@@ -110,6 +112,14 @@ public:
 
     int get_hw_arm32();
 
+    // scheduling, CPU affinity and wakeup jitter of threads for @SYS/threads.txt
+    void thread_info(ExpandingString &str) override;
+
+    void trace_begin(const char *name) override { Trace::begin(name); }
+    void trace_end(const char *name) override { Trace::end(name); }
+    void trace_info(ExpandingString &str) override { Trace::export_json(str); }
+    void semaphore_info(ExpandingString &str) override { SemaphoreProfiler::info(str); }
+
     bool toneAlarm_init() override { return _toneAlarm.init(); }
     void toneAlarm_set_buzzer_tone(float frequency, float volume, uint32_t duration_ms) override {
         _toneAlarm.set_buzzer_tone(frequency, volume, duration_ms);
@@ -251,6 +251,11 @@ void HAL_SITL::run(int argc, char * const argv[], Callbacks* callbacks) const
         callbacks->loop();
         HALSITL::Scheduler::_run_io_procs();
 
+        if (_sitl_state->checkpoint_due() && !_sitl_state->checkpoint_branch()) {
+            ::fprintf(stderr, "SITL checkpoint failed\n");
+            exit(1);
+        }
+
         uint32_t now = AP_HAL::millis();
         if (now - last_watchdog_save >= 100 && using_watchdog) {
             // save persistent data every 100ms
@@ -264,6 +269,15 @@ void HAL_SITL::run(int argc, char * const argv[], Callbacks* callbacks) const
         }
     }
 
+    if (_sitl_state->in_checkpoint_branch()) {
+        // a reboot ends the branch, the checkpoint then starts the next
+        ::fprintf(stderr, "Ending checkpoint branch\n");
+        exit(0);
+    }
+
+    // don't lose changes still waiting for write-back
+    sitlStorage.flush();
+
     actually_reboot();
 }
 
@@ -206,6 +206,8 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
         if (hal.scheduler->in_main_thread() ||
             Scheduler::from(hal.scheduler)->semaphore_wait_hack_required()) {
             _fdm_input_step();
+        } else if (_scheduler->max_speed()) {
+            _scheduler->wait_clock_thread(wait_time_usec);
         } else {
             usleep(1000);
         }
@@ -93,6 +93,13 @@ public:
     bool use_rtscts(void) const {
         return _use_rtscts;
     }
+
+    // checkpointing for scenario branching, see SITL_checkpoint.cpp
+    bool checkpoint_due(void) const;
+    bool checkpoint_branch(void) WARN_IF_UNUSED;
+    bool in_checkpoint_branch(void) const {
+        return _in_checkpoint_branch;
+    }
     
     // simulated airspeed, sonar and battery monitor
     uint16_t sonar_pin_value;    // pin 0
@@ -194,6 +201,15 @@ private:
     uint8_t _instance;
     uint16_t _base_port;
     pid_t _parent_pid;
+
+    // simulated time to checkpoint at, zero for none
+    uint64_t _checkpoint_time_us;
+    // number of branches to run from the checkpoint, zero for no limit
+    uint32_t _checkpoint_branches;
+    uint32_t _checkpoint_branch_count;
+    uint8_t _checkpoint_park_attempts;
+    bool _in_checkpoint_branch;
+    bool _checkpoint_start_branch(void);
     uint32_t _update_count;
 
     AP_Baro *_barometer;
@@ -0,0 +1,145 @@
+/*
+  checkpointing of a SITL process for scenario branching.
+
+  When simulated time reaches the checkpoint time the process stops
+  and becomes a template. It forks a branch, which carries on with the
+  complete vehicle, EKF, physics and storage state of the checkpoint,
+  and waits for the branch to exit. Each time a branch exits, on a
+  reboot request or SIGTERM, the template forks the next one from the
+  same state. File descriptors are shared with the template, so a test
+  harness stays connected to the same ports across branches.
+
+  Before forking all threads are parked on the simulated clock with no
+  HAL semaphore held, and the clock stays locked in the template so
+  they can't move on. A branch gives each of them a new thread that
+  switches to the stack and registers it parked with, so it carries on
+  from where it was. Threads not created through the scheduler, and
+  threads that never park on the clock, can't be carried over. The
+  checkpoint then fails and SITL exits with an error.
+
+  Only in-process physics models are checkpointed, an external
+  simulator keeps running its own state.
+*/
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL && !defined(HAL_BUILD_AP_PERIPH)
+
+#include "AP_HAL_SITL.h"
+#include "AP_HAL_SITL_Namespace.h"
+#include "HAL_SITL_Class.h"
+#include "Scheduler.h"
+#include "Storage.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+extern const AP_HAL::HAL& hal;
+
+using namespace HALSITL;
+
+// wall clock time to wait for threads to park at each attempt
+#define CHECKPOINT_PARK_TIMEOUT_US 100000
+#define CHECKPOINT_PARK_ATTEMPTS 100
+
+bool SITL_State::checkpoint_due(void) const
+{
+    return _checkpoint_time_us != 0 &&
+        !_in_checkpoint_branch &&
+        AP_HAL::micros64() >= _checkpoint_time_us;
+}
+
+/*
+  become the checkpoint template. Returns true in a branch, or when
+  threads could not be parked yet so the clock can run on for another
+  try. Returns false if the checkpoint can't be made
+ */
+bool SITL_State::checkpoint_branch(void)
+{
+    switch (_scheduler->park_threads_for_fork(CHECKPOINT_PARK_TIMEOUT_US)) {
+    case Scheduler::ForkPark::PARKED:
+        break;
+    case Scheduler::ForkPark::BUSY:
+        return ++_checkpoint_park_attempts < CHECKPOINT_PARK_ATTEMPTS;
+    case Scheduler::ForkPark::FAILED:
+        return false;
+    }
+
+    // the watchdog must not fire while we wait for branches
+    alarm(0);
+
+    ::fprintf(stderr, "SITL checkpoint at %.3fs\n", AP_HAL::micros64() * 1.0e-6);
+
+    while (_checkpoint_branches == 0 || _checkpoint_branch_count < _checkpoint_branches) {
+        if (Scheduler::_should_exit) {
+            break;
+        }
+        _checkpoint_branch_count++;
+
+        // don't let the branch print our buffered output again
+        fflush(stdout);
+        fflush(stderr);
+
+        const pid_t pid = fork();
+        if (pid == -1) {
+            AP_HAL::panic("checkpoint fork failed: %s", strerror(errno));
+        }
+        if (pid == 0) {
+            if (!_checkpoint_start_branch()) {
+                exit(1);
+            }
+            return true;
+        }
+
+        ::fprintf(stderr, "SITL checkpoint: branch %u pid %d\n",
+                  unsigned(_checkpoint_branch_count), int(pid));
+
+        int status = 0;
+        while (waitpid(pid, &status, 0) == -1) {
+            if (errno != EINTR) {
+                AP_HAL::panic("checkpoint waitpid failed: %s", strerror(errno));
+            }
+            if (Scheduler::_should_exit) {
+                // take the running branch down with us
+                kill(pid, SIGTERM);
+            }
+        }
+
+        if (WIFEXITED(status)) {
+            ::fprintf(stderr, "SITL checkpoint: branch %u exited with %d\n",
+                      unsigned(_checkpoint_branch_count), WEXITSTATUS(status));
+        } else if (WIFSIGNALED(status)) {
+            ::fprintf(stderr, "SITL checkpoint: branch %u killed by signal %d\n",
+                      unsigned(_checkpoint_branch_count), WTERMSIG(status));
+        }
+    }
+
+    ::fprintf(stderr, "SITL checkpoint done after %u branches\n",
+              unsigned(_checkpoint_branch_count));
+    exit(0);
+}
+
+bool SITL_State::_checkpoint_start_branch(void)
+{
+    _in_checkpoint_branch = true;
+
+#ifdef __linux__
+    // don't outlive the template
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+
+    // parameter and mission changes made by a branch must not show up
+    // in the next one
+    static_cast<Storage *>(hal.storage)->keep_in_memory();
+
+    return _scheduler->resume_threads_after_fork();
+}
+
+#endif
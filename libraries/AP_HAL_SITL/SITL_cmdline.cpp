@@ -71,6 +71,11 @@ void SITL_State::_usage(void)
            "\t--wipe|-w                wipe eeprom\n"
            "\t--unhide-groups|-u       parameter enumeration ignores AP_PARAM_FLAG_ENABLE\n"
            "\t--speedup|-s SPEEDUP     set simulation speedup\n"
+           "\t--free-run               run as fast as possible, ignoring speedup\n"
+           "\t--max-speed              free run with all threads stepped on simulated time, no FlightGear output\n"
+           "\t--speedup-report SECONDS print achieved speedup every SECONDS of wall time\n"
+           "\t--checkpoint SECONDS     branch runs from the state at SECONDS of simulated time\n"
+           "\t--checkpoint-branches N  stop after N branches from the checkpoint\n"
            "\t--rate|-r RATE           set SITL framerate\n"
            "\t--console|-C             use console instead of TCP ports\n"
            "\t--instance|-I N          set instance of SITL (adds 10*instance to all port numbers)\n"
@@ -184,6 +189,8 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
 {
     int opt;
     float speedup = 1.0f;
+    bool free_run = false;
+    float speedup_report_s = 0;
     _instance = 0;
     _synthetic_clock_mode = false;
     // default to CMAC
@@ -240,6 +247,11 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_IRLOCK_PORT,
         CMDLINE_START_TIME,
         CMDLINE_SYSID,
+        CMDLINE_FREE_RUN,
+        CMDLINE_MAX_SPEED,
+        CMDLINE_SPEEDUP_REPORT,
+        CMDLINE_CHECKPOINT,
+        CMDLINE_CHECKPOINT_BRANCHES,
     };
 
     const struct GetOptLong::option options[] = {
@@ -278,6 +290,11 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"irlock-port",     true,   0, CMDLINE_IRLOCK_PORT},
         {"start-time",      true,   0, CMDLINE_START_TIME},
         {"sysid",           true,   0, CMDLINE_SYSID},
+        {"free-run",        false,  0, CMDLINE_FREE_RUN},
+        {"max-speed",       false,  0, CMDLINE_MAX_SPEED},
+        {"speedup-report",  true,   0, CMDLINE_SPEEDUP_REPORT},
+        {"checkpoint",      true,   0, CMDLINE_CHECKPOINT},
+        {"checkpoint-branches", true, 0, CMDLINE_CHECKPOINT_BRANCHES},
         {0, false, 0, 0}
     };
 
@@ -418,6 +435,27 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             printf("Setting SYSID_THISMAV=%d\n", sysid);
             break;
         }
+        case CMDLINE_FREE_RUN:
+            free_run = true;
+            break;
+        case CMDLINE_MAX_SPEED:
+            free_run = true;
+            _use_fg_view = false;
+            _scheduler->set_max_speed(true);
+            break;
+        case CMDLINE_SPEEDUP_REPORT:
+            speedup_report_s = strtof(gopt.optarg, nullptr);
+            break;
+        case CMDLINE_CHECKPOINT:
+            _checkpoint_time_us = strtof(gopt.optarg, nullptr) * 1.0e6;
+            // threads must be parked on the clock when we fork, and
+            // know where to resume in a branch
+            _scheduler->set_max_speed(true);
+            _scheduler->enable_fork_resume();
+            break;
+        case CMDLINE_CHECKPOINT_BRANCHES:
+            _checkpoint_branches = strtoul(gopt.optarg, nullptr, 0);
+            break;
         default:
             _usage();
             exit(1);
@@ -455,6 +493,12 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             }
             sitl_model->set_interface_ports(simulator_address, simulator_port_in, simulator_port_out);
             sitl_model->set_speedup(speedup);
+            if (free_run) {
+                sitl_model->set_free_run();
+            }
+            if (speedup_report_s > 0) {
+                sitl_model->set_speedup_report(speedup_report_s);
+            }
             sitl_model->set_instance(_instance);
             sitl_model->set_autotest_dir(autotest_dir);
             sitl_model->set_config(config);
@@ -5,6 +5,7 @@
 #include "Scheduler.h"
 #include "UARTDriver.h"
 #include <sys/time.h>
+#include <errno.h>
 #include <fenv.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
 #if defined (__clang__) || (defined (__APPLE__) && defined (__MACH__))
@@ -13,6 +14,9 @@
 #include <malloc.h>
 #endif
 #include <AP_RCProtocol/AP_RCProtocol.h>
+#ifdef __linux__
+#include <dirent.h>
+#endif
 
 using namespace HALSITL;
 
@@ -42,6 +46,23 @@ bool Scheduler::_in_semaphore_take_wait = false;
 
 Scheduler::thread_attr *Scheduler::threads;
 HAL_Semaphore Scheduler::_thread_sem;
+thread_local Scheduler::thread_attr *Scheduler::_current_thread;
+#if SITL_THREAD_RESUME_ENABLED
+thread_local ucontext_t *Scheduler::_resume_home;
+#endif
+
+thread_local Scheduler::clock_waiter Scheduler::_clock_waiter;
+Scheduler::clock_waiter *Scheduler::_clock_waiters;
+uint32_t Scheduler::_clock_step;
+uint8_t Scheduler::_num_running;
+pthread_mutex_t Scheduler::_clock_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t Scheduler::_clock_cond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t Scheduler::_idle_cond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t Scheduler::_park_cond = PTHREAD_COND_INITIALIZER;
+bool Scheduler::_fork_resume;
+
+// longest wall clock time the main thread waits for woken threads
+#define MAX_SPEED_THREAD_WAIT_US 10000
 
 Scheduler::Scheduler(SITL_State *sitlState) :
     _sitlState(sitlState),
@@ -264,6 +285,220 @@ void Scheduler::stop_clock(uint64_t time_usec)
         _last_io_run = time_usec;
         _run_io_procs();
     }
+    if (_max_speed) {
+        _step_threads(time_usec);
+    }
+}
+
+static void timespec_after_us(struct timespec &ts, uint32_t usec)
+{
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += (usec % 1000000) * 1000UL;
+    ts.tv_sec += usec / 1000000 + ts.tv_nsec / 1000000000L;
+    ts.tv_nsec %= 1000000000L;
+}
+
+/*
+  wake the threads whose deadline has been reached and wait for them to
+  come back for more time. Threads that block on something else instead
+  are given up on after MAX_SPEED_THREAD_WAIT_US so we can't deadlock
+ */
+void Scheduler::_step_threads(uint64_t time_usec)
+{
+    pthread_mutex_lock(&_clock_mutex);
+    _clock_step++;
+    _num_running = 0;
+    for (clock_waiter *w = _clock_waiters; w != nullptr; w = w->next) {
+        if (!w->running && w->deadline_usec <= time_usec) {
+            w->running = true;
+            w->step = _clock_step;
+            _num_running++;
+        }
+    }
+    if (_num_running > 0) {
+        pthread_cond_broadcast(&_clock_cond);
+        struct timespec ts;
+        timespec_after_us(ts, MAX_SPEED_THREAD_WAIT_US);
+        while (_num_running > 0) {
+            if (pthread_cond_timedwait(&_idle_cond, &_clock_mutex, &ts) == ETIMEDOUT) {
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&_clock_mutex);
+}
+
+/*
+  the calling thread has finished the work it was woken for. Called with
+  _clock_mutex held
+ */
+void Scheduler::_clock_thread_idle()
+{
+    clock_waiter &w = _clock_waiter;
+    if (w.running && w.step == _clock_step && _num_running > 0) {
+        if (--_num_running == 0) {
+            pthread_cond_signal(&_idle_cond);
+        }
+    }
+    w.running = false;
+}
+
+void Scheduler::wait_clock_thread(uint64_t wait_time_usec)
+{
+#if SITL_THREAD_RESUME_ENABLED
+    struct thread_attr *a = _current_thread;
+    if (_fork_resume && a != nullptr) {
+        // in the child of a checkpoint fork this thread carries on
+        // from here on a new thread, see resume_threads_after_fork()
+        getcontext(&a->park_context);
+    }
+#endif
+    // thread-local state must be looked up again after a resume, so
+    // it is only used in a separate function
+    _wait_clock(wait_time_usec);
+}
+
+void Scheduler::_wait_clock(uint64_t wait_time_usec)
+{
+    pthread_mutex_lock(&_clock_mutex);
+    _clock_thread_idle();
+
+    clock_waiter &w = _clock_waiter;
+    w.deadline_usec = wait_time_usec;
+    w.next = _clock_waiters;
+    _clock_waiters = &w;
+    pthread_cond_signal(&_park_cond);
+
+    while (!w.running && AP_HAL::micros64() < wait_time_usec && !_should_exit) {
+        // time out now and then in case the main thread stops stepping
+        struct timespec ts;
+        timespec_after_us(ts, 100000);
+        pthread_cond_timedwait(&_clock_cond, &_clock_mutex, &ts);
+    }
+
+    for (clock_waiter **p = &_clock_waiters; *p != nullptr; p = &(*p)->next) {
+        if (*p == &w) {
+            *p = w.next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_clock_mutex);
+}
+
+/*
+  return the number of threads in this process, or -1 if unknown
+ */
+static int count_process_threads(void)
+{
+#ifdef __linux__
+    DIR *d = opendir("/proc/self/task");
+    if (d == nullptr) {
+        return -1;
+    }
+    int count = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != nullptr) {
+        if (de->d_name[0] != '.') {
+            count++;
+        }
+    }
+    closedir(d);
+    return count;
+#else
+    return -1;
+#endif
+}
+
+/*
+  park all threads for a checkpoint fork(). A thread is parked when it
+  is waiting in wait_clock_thread() and has not been woken by a clock
+  step. While we hold _clock_mutex no parked thread can leave
+  wait_clock_thread(), so once all of them are parked and no semaphore
+  is held nothing can change under the fork
+ */
+Scheduler::ForkPark Scheduler::park_threads_for_fork(uint32_t timeout_us)
+{
+#if SITL_THREAD_RESUME_ENABLED
+    if (!_fork_resume) {
+        ::fprintf(stderr, "SITL checkpoint: thread resume not enabled\n");
+        return ForkPark::FAILED;
+    }
+
+    uint8_t num_threads = 0;
+    {
+        WITH_SEMAPHORE(_thread_sem);
+        for (struct thread_attr *a=threads; a; a=a->next) {
+            num_threads++;
+        }
+    }
+
+    // a thread not created by thread_create() can't be parked or
+    // carried into the child
+    const int num_process_threads = count_process_threads();
+    if (num_process_threads != num_threads + 1) {
+        ::fprintf(stderr, "SITL checkpoint: %d threads running, %u known to the scheduler\n",
+                  num_process_threads, unsigned(num_threads + 1));
+        return ForkPark::FAILED;
+    }
+
+    struct timespec ts;
+    timespec_after_us(ts, timeout_us);
+    pthread_mutex_lock(&_clock_mutex);
+    while (true) {
+        uint8_t num_parked = 0;
+        for (clock_waiter *w = _clock_waiters; w != nullptr; w = w->next) {
+            if (w->resumable && !w->running) {
+                num_parked++;
+            }
+        }
+        if (num_parked >= num_threads && Semaphore::num_held() == 0) {
+            return ForkPark::PARKED;
+        }
+        if (pthread_cond_timedwait(&_park_cond, &_clock_mutex, &ts) == ETIMEDOUT) {
+            ::fprintf(stderr, "SITL checkpoint: %u of %u threads parked, %u semaphores held\n",
+                      unsigned(num_parked), unsigned(num_threads),
+                      unsigned(Semaphore::num_held()));
+            pthread_mutex_unlock(&_clock_mutex);
+            return ForkPark::BUSY;
+        }
+    }
+#else
+    ::fprintf(stderr, "SITL checkpoint: not supported on this platform\n");
+    return ForkPark::FAILED;
+#endif
+}
+
+/*
+  only the forking thread exists in the child of a fork(). The other
+  threads were parked by park_threads_for_fork(), and their stacks and
+  the context saved where they parked are copied into the child. Each
+  gets a new thread which switches to that context, so it carries on
+  from wait_clock_thread() as if the fork had not happened. Returns
+  false if a thread could not be created
+ */
+bool Scheduler::resume_threads_after_fork(void)
+{
+#if SITL_THREAD_RESUME_ENABLED
+    pthread_mutex_init(&_clock_mutex, nullptr);
+    pthread_cond_init(&_clock_cond, nullptr);
+    pthread_cond_init(&_idle_cond, nullptr);
+    pthread_cond_init(&_park_cond, nullptr);
+    _clock_waiters = nullptr;
+    _num_running = 0;
+
+    WITH_SEMAPHORE(_thread_sem);
+    for (struct thread_attr *a=threads; a; a=a->next) {
+        pthread_t thread {};
+        if (pthread_create(&thread, nullptr, thread_resume_trampoline, a) != 0) {
+            ::fprintf(stderr, "SITL checkpoint: failed to resume thread %s\n", a->name);
+            return false;
+        }
+        pthread_detach(thread);
+    }
+    return true;
+#else
+    return false;
+#endif
 }
 
 /*
@@ -272,22 +507,69 @@ void Scheduler::stop_clock(uint64_t time_usec)
 void *Scheduler::thread_create_trampoline(void *ctx)
 {
     struct thread_attr *a = (struct thread_attr *)ctx;
+    _current_thread = a;
+    _clock_waiter.resumable = true;
     a->f[0]();
-    
-    WITH_SEMAPHORE(_thread_sem);
-    if (threads == a) {
-        threads = a->next;
-    } else {
-        for (struct thread_attr *p=threads; p->next; p=p->next) {
-            if (p->next == a) {
-                p->next = p->next->next;
-                break;
+    _thread_exit(a);
+    return nullptr;
+}
+
+/*
+  clean up after a thread function returns. This is separate from the
+  trampoline so thread-local state is looked up on the thread we are
+  now, which differs if the thread was resumed after a fork
+*/
+void Scheduler::_thread_exit(struct thread_attr *a)
+{
+    // don't leave the main thread waiting for us
+    pthread_mutex_lock(&_clock_mutex);
+    _clock_thread_idle();
+    pthread_mutex_unlock(&_clock_mutex);
+
+    {
+        WITH_SEMAPHORE(_thread_sem);
+        if (threads == a) {
+            threads = a->next;
+        } else {
+            for (struct thread_attr *p=threads; p->next; p=p->next) {
+                if (p->next == a) {
+                    p->next = p->next->next;
+                    break;
+                }
             }
         }
+        free(a->stack);
+        free(a->f);
+        delete a;
     }
-    free(a->stack);
-    free(a->f);
-    delete a;
+
+#if SITL_THREAD_RESUME_ENABLED
+    if (_resume_home != nullptr) {
+        // this stack was copied from a thread of the process we were
+        // forked from, so finish on the stack of the resuming thread
+        setcontext(_resume_home);
+    }
+#endif
+}
+
+/*
+  start of a thread carrying on a parked thread after a fork
+ */
+void *Scheduler::thread_resume_trampoline(void *ctx)
+{
+#if SITL_THREAD_RESUME_ENABLED
+    struct thread_attr *a = (struct thread_attr *)ctx;
+    ucontext_t home;
+    volatile bool resumed = false;
+    getcontext(&home);
+    if (!resumed) {
+        resumed = true;
+        _current_thread = a;
+        _clock_waiter.resumable = true;
+        _resume_home = &home;
+        setcontext(&a->park_context);
+    }
+#endif
     return nullptr;
 }
 
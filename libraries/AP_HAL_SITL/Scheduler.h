@@ -5,6 +5,13 @@
 #include "AP_HAL_SITL_Namespace.h"
 #include <sys/time.h>
 #include <pthread.h>
+#ifdef __linux__
+#include <ucontext.h>
+// threads can carry on in the child of a checkpoint fork
+#define SITL_THREAD_RESUME_ENABLED 1
+#else
+#define SITL_THREAD_RESUME_ENABLED 0
+#endif
 
 #define SITL_SCHEDULER_MAX_TIMER_PROCS 8
 
@@ -68,6 +75,38 @@ public:
     // a couple of helper functions to cope with SITL's time stepping
     bool semaphore_wait_hack_required() const;
 
+    /*
+      in max speed mode threads waiting for simulated time sleep until
+      the main thread steps the clock past their deadline, and the main
+      thread then waits for them to finish their work before stepping
+      the clock again, so no thread depends on wall clock time
+     */
+    void set_max_speed(bool enable) { _max_speed = enable; }
+    bool max_speed() const { return _max_speed; }
+
+    // wait for simulated time from a thread other than the main thread
+    void wait_clock_thread(uint64_t wait_time_usec);
+
+    /*
+      checkpoint fork support. Once enable_fork_resume() is called
+      threads record where they park on the clock.
+      park_threads_for_fork() waits until every thread created by
+      thread_create() is parked in wait_clock_thread() and no HAL
+      semaphore is held, and returns PARKED with the clock locked so
+      none of them can leave the park. Otherwise the clock is left
+      unlocked, with BUSY if parking may succeed later and FAILED if it
+      can't. After the fork, resume_threads_after_fork() carries on
+      each thread from its park in the child
+     */
+    enum class ForkPark {
+        PARKED,
+        BUSY,
+        FAILED,
+    };
+    void enable_fork_resume(void) { _fork_resume = true; }
+    ForkPark park_threads_for_fork(uint32_t timeout_us);
+    bool resume_threads_after_fork(void);
+
 private:
     SITL_State *_sitlState;
     uint8_t _nested_atomic_ctr;
@@ -90,7 +129,34 @@ private:
     void stop_clock(uint64_t time_usec) override;
 
     static void *thread_create_trampoline(void *ctx);
+    static void *thread_resume_trampoline(void *ctx);
     static void check_thread_stacks(void);
+
+    // a thread waiting for simulated time in max speed mode
+    struct clock_waiter {
+        clock_waiter *next;
+        uint64_t deadline_usec;
+        // woken by the clock step numbered step and not finished yet
+        bool running;
+        uint32_t step;
+        // thread was created by thread_create()
+        bool resumable;
+    };
+    static thread_local clock_waiter _clock_waiter;
+    static clock_waiter *_clock_waiters;
+    static uint32_t _clock_step;
+    static uint8_t _num_running;
+    static pthread_mutex_t _clock_mutex;
+    static pthread_cond_t _clock_cond;
+    static pthread_cond_t _idle_cond;
+    static pthread_cond_t _park_cond;
+    static bool _fork_resume;
+
+    void _step_threads(uint64_t time_usec);
+    static void _clock_thread_idle();
+    static void _wait_clock(uint64_t wait_time_usec) __attribute__((noinline));
+
+    bool _max_speed = false;
     
     bool _initialized;
     uint64_t _stopped_clock_usec;
@@ -106,8 +172,19 @@ private:
         void *stack;
         const uint8_t *stack_min;
         const char *name;
+#if SITL_THREAD_RESUME_ENABLED
+        // where the thread last parked in wait_clock_thread()
+        ucontext_t park_context;
+#endif
     };
     static struct thread_attr *threads;
+    static void _thread_exit(struct thread_attr *a) __attribute__((noinline));
+    // the thread_create() thread we are, if any
+    static thread_local struct thread_attr *_current_thread;
+#if SITL_THREAD_RESUME_ENABLED
+    // where a thread resumed after a fork goes when its function returns
+    static thread_local ucontext_t *_resume_home;
+#endif
     static const uint8_t stackfill = 0xEB;
 };
 #endif  // CONFIG_HAL_BOARD
@@ -9,6 +9,8 @@ extern const AP_HAL::HAL& hal;
 
 using namespace HALSITL;
 
+std::atomic<uint32_t> Semaphore::_num_held;
+
 // construct a semaphore
 Semaphore::Semaphore()
 {
@@ -21,7 +23,13 @@ Semaphore::Semaphore()
 
 bool Semaphore::give()
 {
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::released(_profile);
+    }
+#endif
     take_count--;
+    _num_held--;
     if (pthread_mutex_unlock(&_lock) != 0) {
         AP_HAL::panic("Bad semaphore usage");
     }
@@ -40,16 +48,41 @@ void Semaphore::check_owner() const
 }
 
 bool Semaphore::take(uint32_t timeout_ms)
+{
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::Wait wait(_profile, __builtin_return_address(0));
+        return wait.taken(_take(timeout_ms));
+    }
+#endif
+    return _take(timeout_ms);
+}
+
+// override so that profiled sites are our callers rather than the base class
+void Semaphore::take_blocking()
+{
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::Wait wait(_profile, __builtin_return_address(0));
+        wait.taken(_take(HAL_SEMAPHORE_BLOCK_FOREVER));
+        return;
+    }
+#endif
+    _take(HAL_SEMAPHORE_BLOCK_FOREVER);
+}
+
+bool Semaphore::_take(uint32_t timeout_ms)
 {
     if (timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
         if (pthread_mutex_lock(&_lock) == 0) {
             owner = pthread_self();
             take_count++;
+            _num_held++;
             return true;
         }
         return false;
     }
-    if (take_nonblocking()) {
+    if (_take_nonblocking()) {
         owner = pthread_self();
         return true;
     }
@@ -58,7 +91,7 @@ bool Semaphore::take(uint32_t timeout_ms)
         Scheduler::from(hal.scheduler)->set_in_semaphore_take_wait(true);
         hal.scheduler->delay_microseconds(200);
         Scheduler::from(hal.scheduler)->set_in_semaphore_take_wait(false);
-        if (take_nonblocking()) {
+        if (_take_nonblocking()) {
             owner = pthread_self();
             return true;
         }
@@ -67,10 +100,22 @@ bool Semaphore::take(uint32_t timeout_ms)
 }
 
 bool Semaphore::take_nonblocking()
+{
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (SemaphoreProfiler::enabled()) {
+        SemaphoreProfiler::Wait wait(_profile, __builtin_return_address(0));
+        return wait.taken(_take_nonblocking());
+    }
+#endif
+    return _take_nonblocking();
+}
+
+bool Semaphore::_take_nonblocking()
 {
     if (pthread_mutex_trylock(&_lock) == 0) {
         owner = pthread_self();
         take_count++;
+        _num_held++;
         return true;
     }
     return false;
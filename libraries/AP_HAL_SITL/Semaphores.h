@@ -4,8 +4,10 @@
 #include <stdint.h>
 #include <AP_HAL/AP_HAL_Macros.h>
 #include <AP_HAL/Semaphores.h>
+#include <AP_HAL/utility/SemaphoreProfiler.h>
 #include "AP_HAL_SITL_Namespace.h"
 #include <pthread.h>
+#include <atomic>
 
 class HALSITL::Semaphore : public AP_HAL::Semaphore {
 public:
@@ -13,14 +15,28 @@ public:
     bool give() override;
     bool take(uint32_t timeout_ms) override;
     bool take_nonblocking() override;
+    void take_blocking() override;
 
     void check_owner() const;  // asserts that current thread owns semaphore
 
+    // takes not yet given back over all semaphores, counting recursive
+    // takes. A checkpoint fork requires this to be zero
+    static uint32_t num_held() { return _num_held; }
+
 protected:
+    bool _take(uint32_t timeout_ms);
+    bool _take_nonblocking();
+
     pthread_mutex_t _lock;
     pthread_t owner;
 
     // keep track the recursion level to ensure we only disown the
     // semaphore once we're done with it
     uint8_t take_count;
+
+    static std::atomic<uint32_t> _num_held;
+
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    SemaphoreProfiler::Hold _profile;
+#endif
 };
@@ -62,6 +62,7 @@ void Storage::_storage_open(void)
 
 #if STORAGE_USE_FLASH
     // load from storage backend
+    _writeback.set_medium("Flash", 2*HAL_FLASH_SECTOR_SIZE);
     _flash_load();
 #elif STORAGE_USE_POSIX
     log_fd = open(HAL_STORAGE_FILE, O_RDWR|O_CREAT, 0644);
@@ -88,6 +89,7 @@ void Storage::_storage_open(void)
         return;        
     }
     using_filesystem = true;
+    _writeback.set_medium("File", HAL_STORAGE_SIZE);
 #else
 #error "No storage system enabled"
 #endif
@@ -133,6 +135,7 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
         _storage_open();
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _writeback.dirtied(loc, n, AP_HAL::millis());
     }
 }
 
@@ -143,11 +146,21 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+        _writeback.clean();
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+    if (_in_memory_only) {
+        _dirty_mask.clearall();
+        return;
+    }
+
+    if (!_writeback.flush_due(AP_HAL::millis())) {
+        return;
+    }
+
+    // write out the first run of dirty lines, limited to keep the
+    // latency of this call to a minimum
     uint16_t i;
     for (i=0; i<STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -158,27 +171,44 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint16_t n = 1;
+    while (n < STORAGE_MAX_WRITE_LINES && i+n < STORAGE_NUM_LINES && _dirty_mask.get(i+n)) {
+        n++;
+    }
 
 #if STORAGE_USE_POSIX
     if (using_filesystem && log_fd != -1) {
         const off_t offset = STORAGE_LINE_SIZE*i;
+        const ssize_t length = STORAGE_LINE_SIZE*n;
         if (lseek(log_fd, offset, SEEK_SET) != offset) {
             return;
         }
-        if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE) != STORAGE_LINE_SIZE) {
+        if (write(log_fd, &_buffer[offset], length) != length) {
             return;
         }
-        _dirty_mask.clear(i);
+        _writeback.wrote(offset, length);
+        for (uint16_t j=0; j<n; j++) {
+            _dirty_mask.clear(i+j);
+        }
         return;
     } 
 #endif
     
 #if STORAGE_USE_FLASH
     // save to storage backend
-    _flash_write(i);
+    _flash_write(i, n);
 #endif
 }
 
+void Storage::flush(void)
+{
+    _writeback.flush_now();
+    // each tick writes at least one line unless the write fails
+    for (uint16_t i=0; i<STORAGE_NUM_LINES && !_dirty_mask.empty(); i++) {
+        _timer_tick();
+    }
+}
+
 /*
   load all data from flash
  */
@@ -194,14 +224,16 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask. 
+  write n storage lines. This also updates _dirty_mask.
 */
-void Storage::_flash_write(uint16_t line)
+void Storage::_flash_write(uint16_t line, uint16_t n)
 {
 #if STORAGE_USE_FLASH
-    if (_flash.write(line*STORAGE_LINE_SIZE, STORAGE_LINE_SIZE)) {
-        // mark the line clean
-        _dirty_mask.clear(line);
+    if (_flash.write(line*STORAGE_LINE_SIZE, n*STORAGE_LINE_SIZE)) {
+        // mark the lines clean
+        for (uint16_t i=0; i<n; i++) {
+            _dirty_mask.clear(line+i);
+        }
     }
 #endif
 }
@@ -301,6 +333,9 @@ bool Storage::_flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *
 {
     size_t base_address = sitl_flash_getpageaddr(sector);
     bool ret = sitl_flash_write(base_address+offset, data, length);
+    if (ret) {
+        _writeback.wrote(base_address+offset, length);
+    }
     if (!ret && _flash_erase_ok()) {
         // we are getting flash write errors while disarmed. Try
         // re-writing all of flash
@@ -329,6 +364,7 @@ bool Storage::_flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, u
  */
 bool Storage::_flash_erase_sector(uint8_t sector)
 {
+    _writeback.erased();
     return sitl_flash_erasepage(sector);
 }
 
@@ -4,6 +4,7 @@
 #include <AP_Common/Bitmask.h>
 #include "AP_HAL_SITL_Namespace.h"
 #include <AP_FlashStorage/AP_FlashStorage.h>
+#include <AP_HAL/utility/StorageWriteback.h>
 
 // define which storage system to use. This allows us to test flash storage with --sitl-flash-storage
 // configure option
@@ -18,6 +19,9 @@
 #define STORAGE_LINE_SIZE (1<<STORAGE_LINE_SHIFT)
 #define STORAGE_NUM_LINES (HAL_STORAGE_SIZE/STORAGE_LINE_SIZE)
 
+// maximum number of consecutive dirty lines written back in one tick
+#define STORAGE_MAX_WRITE_LINES 8
+
 class HALSITL::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -26,6 +30,14 @@ public:
 
     void _timer_tick(void) override;
     bool healthy(void) override;
+    void storage_info(ExpandingString &str) override { _writeback.info(str); }
+
+    // stop writing changes back to the storage file, used by checkpoint
+    // branches so they don't change the state they branched from
+    void keep_in_memory(void) { _in_memory_only = true; }
+
+    // write back all dirty lines now, used before a reboot
+    void flush(void) override;
 
 private:
     volatile bool _initialised;
@@ -35,6 +47,7 @@ private:
     void _mark_dirty(uint16_t loc, uint16_t length);
     uint8_t _buffer[HAL_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<STORAGE_NUM_LINES> _dirty_mask;
+    StorageWriteback _writeback;
 
 #if STORAGE_USE_FLASH
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
@@ -44,6 +57,7 @@ private:
 #endif
 
     bool _flash_failed;
+    bool _in_memory_only;
     uint32_t _last_re_init_ms;
     uint32_t _last_empty_ms;
 
@@ -57,7 +71,7 @@ private:
 #endif
     
     void _flash_load(void);
-    void _flash_write(uint16_t line);
+    void _flash_write(uint16_t line, uint16_t n);
 
 #if STORAGE_USE_POSIX
     bool using_filesystem;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/SemaphoreProfiler.h>
 #include "AP_HAL_SITL_Namespace.h"
 #include "AP_HAL_SITL.h"
 #include "Semaphores.h"
@@ -76,6 +77,9 @@ public:
 #endif
     }
 
+    // request semaphore contention statistics per call site
+    void semaphore_info(ExpandingString &str) override { SemaphoreProfiler::info(str); }
+
     void init(int argc, char *const *argv) {
         saved_argc = argc;
         saved_argv = argv;
@@ -794,7 +794,10 @@ void AP_Logger_File::start_new_log(void)
     _last_write_ms = AP_HAL::millis();
     _open_error_ms = 0;
     _write_offset = 0;
-    _writebuf.clear();
+    // only the IO thread may move the read side of _writebuf, so leave
+    // it to drop what was queued for the old log
+    _writebuf_discard_mark = _writebuf.write_mark();
+    _writebuf_discard = true;
     write_fd_semaphore.give();
 
     // now update lastlog.txt with the new log number
@@ -916,6 +919,15 @@ void AP_Logger_File::io_timer(void)
         write_fd_semaphore.give();
         return;
     }
+    if (_writebuf_discard) {
+        // a new log has been started, the data before it belongs to
+        // the old one
+        _writebuf_discard = false;
+        _writebuf.discard_to(_writebuf_discard_mark);
+        write_fd_semaphore.give();
+        last_io_operation = "";
+        return;
+    }
     ssize_t nwritten = AP::FS().write(_write_fd, head, nbytes);
     last_io_operation = "";
     if (nwritten <= 0) {
@@ -95,9 +95,13 @@ private:
     bool file_exists(const char *filename) const;
     bool log_exists(const uint16_t lognum) const;
 
-    // write buffer
-    ByteBuffer _writebuf{0};
+    // write buffer, filled by the front end and drained by the IO thread
+    SPSCByteBuffer _writebuf{0};
     const uint16_t _writebuf_chunk = HAL_LOGGER_WRITE_CHUNK_SIZE;
+    // data written before a new log was opened, for the IO thread to
+    // discard. Protected by write_fd_semaphore
+    bool _writebuf_discard;
+    uint32_t _writebuf_discard_mark;
     uint32_t _last_write_time;
 
     /* construct a file name given a log number. Caller must free. */
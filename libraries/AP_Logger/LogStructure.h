@@ -704,6 +704,19 @@ struct PACKED log_Performance {
     uint32_t extra_loop_us;
 };
 
+struct PACKED log_Semaphore {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char site[64];
+    char owner[16];
+    uint32_t takes;
+    uint32_t contended;
+    uint64_t wait_total_us;
+    uint32_t wait_max_us;
+    uint64_t hold_total_us;
+    uint32_t hold_max_us;
+};
+
 struct PACKED log_SRTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -1326,6 +1339,18 @@ struct PACKED log_PSCZ {
 // @Field: TimeUS: Time since system startup
 // @Field: RXRSSI: RSSI
 
+// @LoggerMessage: SEM
+// @Description: Semaphore contention statistics for the call sites with the longest total wait
+// @Field: TimeUS: Time since system startup
+// @Field: Site: Call site, file and line or code address
+// @Field: Own: Thread which last took the semaphore at this site
+// @Field: Take: Number of times the semaphore was taken at this site
+// @Field: Cont: Number of takes which found the semaphore held by another site
+// @Field: WaitT: Total time spent waiting for the semaphore
+// @Field: MaxW: Longest wait for the semaphore
+// @Field: HoldT: Total time the semaphore was held
+// @Field: MaxH: Longest time the semaphore was held
+
 // @LoggerMessage: SIM
 // @Description: SITL simulator state
 // @Field: TimeUS: Time since system startup
@@ -1500,6 +1525,8 @@ LOG_STRUCTURE_FROM_CAMERA \
       "PRXR", "QBffffffff", "TimeUS,Layer,D0,D45,D90,D135,D180,D225,D270,D315", "s#mmmmmmmm", "F-00000000" }, \
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),                     \
       "PM",  "QHHIIHHIIIIII", "TimeUS,NLon,NLoop,MaxT,Mem,Load,ErrL,IntE,ErrC,SPIC,I2CC,I2CI,Ex", "s---b%------s", "F---0A------F" }, \
+    { LOG_SEMAPHORE_MSG, sizeof(log_Semaphore),                         \
+      "SEM",  "QZNIIQIQI", "TimeUS,Site,Own,Take,Cont,WaitT,MaxW,HoldT,MaxH", "s----ssss", "F----FFFF" }, \
     { LOG_SRTL_MSG, sizeof(log_SRTL), \
       "SRTL", "QBHHBfff", "TimeUS,Active,NumPts,MaxPts,Action,N,E,D", "s----mmm", "F----000" }, \
     { LOG_OA_BENDYRULER_MSG, sizeof(log_OABendyRuler), \
@@ -1682,6 +1709,7 @@ enum LogMessages : uint8_t {
     LOG_ISBH_MSG,
     LOG_ISBD_MSG,
     LOG_PERFORMANCE_MSG,
+    LOG_SEMAPHORE_MSG,
     LOG_OPTFLOW_MSG,
     LOG_EVENT_MSG,
     LOG_WHEELENCODER_MSG,
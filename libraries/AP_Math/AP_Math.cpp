@@ -82,6 +82,35 @@ template float safe_sqrt<short>(const short v);
 template float safe_sqrt<float>(const float v);
 template float safe_sqrt<double>(const double v);
 
+/*
+ * polynomial approximation of atan2. The ratio of the smaller to the
+ * larger magnitude argument is used so the polynomial only has to
+ * cover 0 to 1, then the octant is restored
+ */
+float fast_atan2f(float y, float x)
+{
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const float maxv = MAX(ax, ay);
+    if (maxv <= 0) {
+        return 0;
+    }
+    const float a = MIN(ax, ay) / maxv;
+    const float s = a * a;
+    // minimax coefficients for atan(a) on [0,1], max error 1.0e-5
+    float r = ((((-0.0117212f * s + 0.05265332f) * s - 0.11643287f) * s + 0.19354346f) * s - 0.33262347f) * s * a + 0.99997726f * a;
+    if (ay > ax) {
+        r = M_PI_2 - r;
+    }
+    if (x < 0) {
+        r = M_PI - r;
+    }
+    if (y < 0) {
+        r = -r;
+    }
+    return r;
+}
+
 /*
  * linear interpolation based on a variable in a range
  */
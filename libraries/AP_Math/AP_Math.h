@@ -82,6 +82,13 @@ float safe_asin(const T v);
 template <typename T>
 float safe_sqrt(const T v);
 
+/*
+ * A polynomial approximation of atan2f() for use in loops over many
+ * points. The maximum error is 1.0e-5 radians, and the result is in
+ * the range -PI to PI. atan2(0,0) returns 0
+ */
+float fast_atan2f(float y, float x);
+
 // matrix multiplication of two NxN matrices
 template <typename T>
 void mat_mul(const T *A, const T *B, T *C, uint16_t n);
@@ -90,6 +97,12 @@ void mat_mul(const T *A, const T *B, T *C, uint16_t n);
 template <typename T>
 bool mat_inverse(const T *x, T *y, uint16_t dim) WARN_IF_UNUSED;
 
+// matrix inverse with scratch space of MAT_INVERSE_WORK_SIZE(dim)
+// elements provided by the caller
+#define MAT_INVERSE_WORK_SIZE(dim) (5*(dim)*(dim))
+template <typename T>
+bool mat_inverse(const T *x, T *y, uint16_t dim, T *work) WARN_IF_UNUSED;
+
 // matrix identity
 template <typename T>
 void mat_identity(T *x, uint16_t dim);
@@ -5,6 +5,7 @@
 #pragma GCC optimize("O2")
 
 #include "matrixN.h"
+#include "AP_Math.h"
 
 
 // multiply two vectors to give a matrix, in-place
@@ -54,7 +55,25 @@ void MatrixN<T,N>::force_symmetry(void)
     }
 }
 
+// multiply by another matrix
+template <typename T, uint8_t N>
+MatrixN<T,N> MatrixN<T,N>::operator *(const MatrixN<T,N> &B) const
+{
+    MatrixN<T,N> ret;
+    mat_mul(&v[0][0], &B.v[0][0], &ret.v[0][0], N);
+    return ret;
+}
+
+// calculate the inverse, returning false if the matrix is singular
+template <typename T, uint8_t N>
+bool MatrixN<T,N>::inverse(MatrixN<T,N> &inv) const
+{
+    return mat_inverse(&v[0][0], &inv.v[0][0], N);
+}
+
 template void MatrixN<float,4>::mult(const VectorN<float,4> &A, const VectorN<float,4> &B);
 template MatrixN<float,4> &MatrixN<float,4>::operator -=(const MatrixN<float,4> &B);
 template MatrixN<float,4> &MatrixN<float,4>::operator +=(const MatrixN<float,4> &B);
 template void MatrixN<float,4>::force_symmetry(void);
+template MatrixN<float,4> MatrixN<float,4>::operator *(const MatrixN<float,4> &B) const;
+template bool MatrixN<float,4>::inverse(MatrixN<float,4> &inv) const;
@@ -43,6 +43,12 @@ public:
     // Matrix symmetry routine
     void force_symmetry(void);
 
+    // multiply by another matrix
+    MatrixN<T,N> operator *(const MatrixN<T,N> &B) const;
+
+    // calculate the inverse, returning false if the matrix is singular
+    bool inverse(MatrixN<T,N> &inv) const;
+
 private:
     T v[N][N];
 };
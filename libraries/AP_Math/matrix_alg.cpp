@@ -29,23 +29,21 @@
  *
  *    @param     A,           Matrix A
  *    @param     B,           Matrix B
+ *    @param     ret,         Output matrix, A*B
  *    @param     n,           dimemsion of square matrices
- *    @returns                multiplied matrix i.e. A*B
  */
 template<typename T>
-static T* matrix_multiply(const T *A, const T *B, uint16_t n)
+static inline void matrix_multiply(const T *A, const T *B, T *ret, uint16_t n)
 {
-    T* ret = new T[n*n];
-    memset(ret,0.0f,n*n*sizeof(T));
-
     for(uint16_t i = 0; i < n; i++) {
         for(uint16_t j = 0; j < n; j++) {
+            T sum = 0;
             for(uint16_t k = 0;k < n; k++) {
-                ret[i*n + j] += A[i*n + k] * B[k*n + j];
+                sum += A[i*n + k] * B[k*n + j];
             }
+            ret[i*n + j] = sum;
         }
     }
-    return ret;
 }
 
 template<typename T>
@@ -66,7 +64,7 @@ static inline void swap(T &a, T &b)
  *    @returns                false = matrix is Singular or non positive definite, true = matrix inversion successful
  */
 template<typename T>
-static void mat_pivot(const T* A, T* pivot, uint16_t n)
+static inline void mat_pivot(const T* A, T* pivot, uint16_t n)
 {
     for(uint16_t i = 0;i<n;i++){
         for(uint16_t j=0;j<n;j++) {
@@ -104,7 +102,7 @@ static void mat_pivot(const T* A, T* pivot, uint16_t n)
  *    @param     n,           dimension of matrix
  */
 template<typename T>
-static void mat_forward_sub(const T *L, T *out, uint16_t n)
+static inline void mat_forward_sub(const T *L, T *out, uint16_t n)
 {
     // Forward substitution solve LY = I
     for(int i = 0; i < n; i++) {
@@ -126,7 +124,7 @@ static void mat_forward_sub(const T *L, T *out, uint16_t n)
  *    @param     n,           dimension of matrix
  */
 template<typename T>
-static void mat_back_sub(const T *U, T *out, uint16_t n)
+static inline void mat_back_sub(const T *U, T *out, uint16_t n)
 {
     // Backward Substitution solve UY = I
     for(int i = n-1; i >= 0; i--) {
@@ -146,17 +144,18 @@ static void mat_back_sub(const T *U, T *out, uint16_t n)
  *    ref: http://rosettacode.org/wiki/LU_decomposition
  *    @param     U,           upper triangular matrix
  *    @param     out,         Output inverted upper triangular matrix
+ *    @param     APrime,      scratch space of n*n elements
  *    @param     n,           dimension of matrix
  */
 template<typename T>
-static void mat_LU_decompose(const T* A, T* L, T* U, T *P, uint16_t n)
+static inline void mat_LU_decompose(const T* A, T* L, T* U, T *P, T *APrime, uint16_t n)
 {
     memset(L,0,n*n*sizeof(T));
     memset(U,0,n*n*sizeof(T));
     memset(P,0,n*n*sizeof(T));
     mat_pivot(A,P,n);
 
-    T *APrime = matrix_multiply(P,A,n);
+    matrix_multiply(P,A,APrime,n);
     for(uint16_t i = 0; i < n; i++) {
         L[i*n + i] = 1;
     }
@@ -177,60 +176,79 @@ static void mat_LU_decompose(const T* A, T* L, T* U, T *P, uint16_t n)
             }
         }
     }
-    delete[] APrime;
 }
 
 /*
  *    matrix inverse code for any square matrix using LU decomposition
  *    inv = inv(U)*inv(L)*P, where L and U are triagular matrices and P the pivot matrix
  *    ref: http://www.cl.cam.ac.uk/teaching/1314/NumMethods/supporting/mcmaster-kiruba-ludecomp.pdf
- *    @param     m,           input 4x4 matrix
- *    @param     inv,      Output inverted 4x4 matrix
+ *    @param     m,           input nxn matrix
+ *    @param     inv,         Output inverted nxn matrix, may be the same as m
+ *    @param     work,        scratch space of MAT_INVERSE_WORK_SIZE(n) elements
  *    @param     n,           dimension of square matrix
  *    @returns                false = matrix is Singular, true = matrix inversion successful
  */
 template<typename T>
-static bool mat_inverseN(const T* A, T* inv, uint16_t n)
+static inline bool mat_inverseN(const T* A, T* inv, T *work, uint16_t n)
 {
-    T *L, *U, *P;
-    bool ret = true;
-    L = new T[n*n];
-    U = new T[n*n];
-    P = new T[n*n];
-    mat_LU_decompose(A,L,U,P,n);
-
-    T *L_inv = new T[n*n];
-    T *U_inv = new T[n*n];
-
-    memset(L_inv,0,n*n*sizeof(T));
+    const uint16_t nn = n*n;
+    T *L = &work[0];
+    T *U = &work[nn];
+    T *P = &work[2*nn];
+    T *L_inv = &work[3*nn];
+    T *U_inv = &work[4*nn];
+
+    // the product of P and A is only needed until the L and U
+    // matrices are formed, so it shares the space of L_inv. A is not
+    // read after this point, so inv may alias it
+    mat_LU_decompose(A,L,U,P,L_inv,n);
+
+    memset(L_inv,0,nn*sizeof(T));
     mat_forward_sub(L,L_inv,n);
 
-    memset(U_inv,0,n*n*sizeof(T));
+    memset(U_inv,0,nn*sizeof(T));
     mat_back_sub(U,U_inv,n);
 
-    // decomposed matrices no longer required
-    delete[] L;
-    delete[] U;
-
-    T *inv_unpivoted = matrix_multiply(U_inv,L_inv,n);
-    T *inv_pivoted = matrix_multiply(inv_unpivoted, P, n);
+    // decomposed matrices no longer required, re-use them for the
+    // intermediate product
+    T *inv_unpivoted = L;
+    matrix_multiply(U_inv,L_inv,inv_unpivoted,n);
+    matrix_multiply(inv_unpivoted, P, inv, n);
 
     //check sanity of results
-    for(uint16_t i = 0; i < n; i++) {
-        for(uint16_t j = 0; j < n; j++) {
-            if(isnan(inv_pivoted[i*n+j]) || isinf(inv_pivoted[i*n+j])){
-                ret = false;
-            }
+    bool ret = true;
+    for(uint16_t i = 0; i < nn; i++) {
+        if(isnan(inv[i]) || isinf(inv[i])){
+            ret = false;
         }
     }
-    memcpy(inv,inv_pivoted,n*n*sizeof(T));
-
-    //free memory
-    delete[] inv_pivoted;
-    delete[] inv_unpivoted;
-    delete[] P;
-    delete[] U_inv;
-    delete[] L_inv;
+    return ret;
+}
+
+/*
+ *    matrix inverse for a dimension known at compile time. The
+ *    scratch space lives on the stack and the loop bounds are constant,
+ *    allowing the compiler to unroll the small kernels
+ */
+template<typename T, uint16_t n>
+static bool mat_inverse_static(const T* A, T* inv)
+{
+    T work[MAT_INVERSE_WORK_SIZE(n)];
+    return mat_inverseN(A, inv, work, n);
+}
+
+/*
+ *    matrix inverse for larger matrices, with heap allocated scratch space
+ */
+template<typename T>
+static bool mat_inverse_dynamic(const T* A, T* inv, uint16_t n)
+{
+    T *work = new T[MAT_INVERSE_WORK_SIZE(n)];
+    if (work == nullptr) {
+        return false;
+    }
+    const bool ret = mat_inverseN(A, inv, work, n);
+    delete[] work;
     return ret;
 }
 
@@ -427,7 +445,8 @@ static bool inverse4x4(const T m[],T invOut[])
 }
 
 /*
- *    generic matrix inverse code
+ *    generic matrix inverse code. Matrices up to 9x9 are inverted
+ *    without heap allocation
  *
  *    @param     x,     input nxn matrix
  *    @param     y,     Output inverted nxn matrix
@@ -440,21 +459,39 @@ bool mat_inverse(const T x[], T y[], uint16_t dim)
     switch(dim){
     case 3: return inverse3x3(x,y);
     case 4: return inverse4x4(x,y);
-    default: return mat_inverseN(x,y,dim);
+    case 5: return mat_inverse_static<T,5>(x,y);
+    case 6: return mat_inverse_static<T,6>(x,y);
+    case 7: return mat_inverse_static<T,7>(x,y);
+    case 8: return mat_inverse_static<T,8>(x,y);
+    case 9: return mat_inverse_static<T,9>(x,y);
+    default: return mat_inverse_dynamic(x,y,dim);
+    }
+}
+
+/*
+ *    generic matrix inverse code with caller provided scratch space,
+ *    for callers that can't spare the stack
+ *
+ *    @param     x,     input nxn matrix
+ *    @param     y,     Output inverted nxn matrix
+ *    @param     n,     dimension of square matrix
+ *    @param     work,  scratch space of MAT_INVERSE_WORK_SIZE(n) elements
+ *    @returns          false = matrix is Singular, true = matrix inversion successful
+ */
+template<typename T>
+bool mat_inverse(const T x[], T y[], uint16_t dim, T work[])
+{
+    switch(dim){
+    case 3: return inverse3x3(x,y);
+    case 4: return inverse4x4(x,y);
+    default: return mat_inverseN(x,y,work,dim);
     }
 }
 
 template <typename T>
 void mat_mul(const T *A, const T *B, T *C, uint16_t n)
 {
-    memset(C, 0, sizeof(T)*n*n);
-    for(uint16_t i = 0; i < n; i++) {
-        for(uint16_t j = 0; j < n; j++) {
-            for(uint16_t k = 0;k < n; k++) {
-                C[i*n + j] += A[i*n + k] * B[k*n + j];
-            }
-        }
-    }
+    matrix_multiply(A, B, C, n);
 }
 
 template <typename T>
@@ -467,9 +504,11 @@ void mat_identity(T *A, uint16_t n)
 }
 
 template bool mat_inverse<float>(const float x[], float y[], uint16_t dim);
+template bool mat_inverse<float>(const float x[], float y[], uint16_t dim, float work[]);
 template void mat_mul<float>(const float *A, const float *B, float *C, uint16_t n);
 template void mat_identity<float>(float x[], uint16_t dim);
 
 template bool mat_inverse<double>(const double x[], double y[], uint16_t dim);
+template bool mat_inverse<double>(const double x[], double y[], uint16_t dim, double work[]);
 template void mat_mul<double>(const double *A, const double *B, double *C, uint16_t n);
 template void mat_identity<double>(double x[], uint16_t dim);
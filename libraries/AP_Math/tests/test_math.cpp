@@ -101,6 +101,20 @@ TEST(MathTest, IsEqual)
     EXPECT_TRUE(is_equal(1.f, (float)(1. + std::numeric_limits<double>::epsilon())));
 }
 
+TEST(MathTest, FastAtan2)
+{
+    const float radii[] { 1.0e-3f, 1.0f, 1.0e4f };
+    EXPECT_EQ(0.0f, fast_atan2f(0.0f, 0.0f));
+    for (int16_t i = -1800; i <= 1800; i++) {
+        const float angle = radians(i * 0.1f);
+        for (const float r : radii) {
+            const float y = r * sinf(angle);
+            const float x = r * cosf(angle);
+            EXPECT_NEAR(atan2f(y, x), fast_atan2f(y, x), 1.2e-5f);
+        }
+    }
+}
+
 TEST(MathTest, Square)
 {
     float sq_0 = sq(0);
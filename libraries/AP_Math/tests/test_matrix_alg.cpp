@@ -0,0 +1,97 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  fill a matrix with a well conditioned, non-symmetric test pattern
+ */
+static void fill_test_matrix(double *m, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        for (uint16_t j = 0; j < n; j++) {
+            m[i*n+j] = 1.0 / (1 + i + 2*j) + ((i == j) ? n : 0);
+        }
+    }
+}
+
+// check A * inv(A) is identity for each of the inverse code paths,
+// including the heap allocated fallback above 9x9
+TEST(MatrixAlgTest, Inverse)
+{
+    for (uint16_t n = 3; n <= 11; n++) {
+        double A[11*11], inv[11*11], prod[11*11];
+        fill_test_matrix(A, n);
+        EXPECT_TRUE(mat_inverse(A, inv, n));
+        mat_mul(A, inv, prod, n);
+        for (uint16_t i = 0; i < n; i++) {
+            for (uint16_t j = 0; j < n; j++) {
+                EXPECT_NEAR((i == j) ? 1.0 : 0.0, prod[i*n+j], 1.0e-12);
+            }
+        }
+    }
+}
+
+// the calibrators invert their normal matrices in place
+TEST(MatrixAlgTest, InverseInPlace)
+{
+    for (uint16_t n = 3; n <= 11; n++) {
+        double A[11*11], inv[11*11];
+        fill_test_matrix(A, n);
+        EXPECT_TRUE(mat_inverse(A, inv, n));
+        EXPECT_TRUE(mat_inverse(A, A, n));
+        for (uint16_t i = 0; i < n*n; i++) {
+            EXPECT_DOUBLE_EQ(inv[i], A[i]);
+        }
+    }
+}
+
+// the compass calibrator passes in scratch space to keep it off the
+// stack, which must give the same result
+TEST(MatrixAlgTest, InverseWithWork)
+{
+    for (uint16_t n = 3; n <= 11; n++) {
+        double A[11*11], inv[11*11], inv_work[11*11];
+        double work[MAT_INVERSE_WORK_SIZE(11)];
+        fill_test_matrix(A, n);
+        EXPECT_TRUE(mat_inverse(A, inv, n));
+        EXPECT_TRUE(mat_inverse(A, inv_work, n, work));
+        for (uint16_t i = 0; i < n*n; i++) {
+            EXPECT_DOUBLE_EQ(inv[i], inv_work[i]);
+        }
+    }
+}
+
+TEST(MatrixAlgTest, Singular)
+{
+    for (uint16_t n = 3; n <= 11; n++) {
+        float A[11*11] {};
+        float inv[11*11];
+        EXPECT_FALSE(mat_inverse(A, inv, n));
+    }
+}
+
+TEST(MatrixAlgTest, MatrixN)
+{
+    const float diag[4] { 2, 4, 5, 8 };
+    const MatrixN<float,4> A{diag};
+    MatrixN<float,4> inv;
+    EXPECT_TRUE(A.inverse(inv));
+    const MatrixN<float,4> prod = A * inv;
+    const float ident[4] { 1, 1, 1, 1 };
+    MatrixN<float,4> diff{ident};
+    diff -= prod;
+    VectorN<float,4> ones;
+    for (uint8_t i = 0; i < 4; i++) {
+        ones[i] = 1;
+    }
+    VectorN<float,4> res;
+    res.mult(diff, ones);
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_NEAR(0, res[i], 1.0e-6);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -60,6 +60,10 @@ void AP_Mission::init()
         clear();
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    init_cmd_cache();
+#endif
+
     _last_change_time_ms = AP_HAL::millis();
 }
 
@@ -661,6 +665,25 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    if (index < _cmd_cache_size) {
+        Mission_Command &cached = _cmd_cache[index];
+        if (cached.index != index) {
+            unpack_cmd_from_storage(index, cached);
+        }
+        cmd = cached;
+        return true;
+    }
+#endif
+
+    unpack_cmd_from_storage(index, cmd);
+    return true;
+}
+
+/// unpack_cmd_from_storage - unpack a command from storage, without
+///     checking it is within the mission
+void AP_Mission::unpack_cmd_from_storage(uint16_t index, Mission_Command& cmd) const
+{
     // ensure all bytes of cmd are zeroed
     cmd = {};
 
@@ -710,10 +733,29 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
 
     // set command's index to it's position in eeprom
     cmd.index = index;
+}
 
-    // return success
-    return true;
+#if AP_MISSION_CACHE_ENABLED
+/*
+  allocate the command cache and fill it with the stored mission, so
+  commands are already decoded when the mission runs
+ */
+void AP_Mission::init_cmd_cache()
+{
+    WITH_SEMAPHORE(_rsem);
+
+    const uint16_t size = num_commands_max();
+    _cmd_cache = new Mission_Command[size];
+    if (_cmd_cache == nullptr) {
+        return;
+    }
+    _cmd_cache_size = size;
+    const uint16_t total = MIN((unsigned)_cmd_total, _cmd_cache_size);
+    for (uint16_t i=AP_MISSION_FIRST_REAL_COMMAND; i<total; i++) {
+        unpack_cmd_from_storage(i, _cmd_cache[i]);
+    }
 }
+#endif
 
 bool AP_Mission::stored_in_location(uint16_t id)
 {
@@ -786,6 +828,18 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+#if AP_MISSION_GEOMETRY_ENABLED
+    _geometry.valid = false;
+#endif
+
+#if AP_MISSION_CACHE_ENABLED
+    if (index < _cmd_cache_size) {
+        // cache what storage now holds, which may differ from cmd in
+        // bytes that are not stored
+        unpack_cmd_from_storage(index, _cmd_cache[index]);
+    }
+#endif
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
 
@@ -1975,36 +2029,137 @@ uint16_t AP_Mission::num_commands_max(void) const
     return (_storage.size() - 4) / AP_MISSION_EEPROM_COMMAND_SIZE;
 }
 
-// find the nearest landing sequence starting point (DO_LAND_START) and
-// return its index.  Returns 0 if no appropriate DO_LAND_START point can
-// be found.
-uint16_t AP_Mission::get_landing_sequence_start() const
+#if AP_MISSION_GEOMETRY_ENABLED
+/*
+  rebuild the mission geometry if the mission has changed. Returns
+  false if there is no memory for it
+ */
+bool AP_Mission::update_geometry() const
 {
-    struct Location current_loc;
+    WITH_SEMAPHORE(_rsem);
 
-    if (!AP::ahrs().get_position(current_loc)) {
-        return 0;
+    const uint16_t total = _cmd_total;
+    if (_geometry.valid && _geometry.cmd_total == total) {
+        return true;
+    }
+    _geometry.valid = false;
+    if (total > _geometry.capacity) {
+        delete[] _geometry.points;
+        _geometry.points = new GeometryPoint[total];
+        if (_geometry.points == nullptr) {
+            _geometry.capacity = 0;
+            return false;
+        }
+        _geometry.capacity = total;
     }
 
-    uint16_t landing_start_index = 0;
-    float min_distance = -1;
+    _geometry.count = 0;
+    _geometry.path_m = 0;
+    bool have_prev = false;
+    bool have_origin = false;
+    Vector2f prev_ne;
+    for (uint16_t i=AP_MISSION_FIRST_REAL_COMMAND; i<total; i++) {
+        Mission_Command cmd;
+        if (!read_cmd_from_storage(i, cmd)) {
+            continue;
+        }
+        const Location &loc = cmd.content.location;
+        const bool located = !(loc.lat == 0 && loc.lng == 0);
+        const bool marker = (cmd.id == MAV_CMD_DO_LAND_START || cmd.id == MAV_CMD_DO_GO_AROUND);
+        const bool on_path = is_nav_cmd(cmd) && stored_in_location(cmd.id) && located;
+        if (!marker && !on_path) {
+            continue;
+        }
+        if (located && !have_origin) {
+            // markers are often left at 0,0, which would give the
+            // wrong longitude scale for the whole mission
+            _geometry.origin = loc;
+            have_origin = true;
+        }
+        GeometryPoint &p = _geometry.points[_geometry.count++];
+        p.index = i;
+        p.id = cmd.id;
+        p.located = located;
+        p.ne = located ? _geometry.origin.get_distance_NE(loc) : Vector2f();
+        if (on_path) {
+            if (have_prev) {
+                _geometry.path_m += (p.ne - prev_ne).length();
+            }
+            prev_ne = p.ne;
+            have_prev = true;
+        }
+        p.path_m = _geometry.path_m;
+    }
+
+    _geometry.cmd_total = total;
+    _geometry.valid = true;
+    return true;
+}
+#endif // AP_MISSION_GEOMETRY_ENABLED
+
+// index of the command with the given id closest to loc, 0 if none
+uint16_t AP_Mission::find_nearest_cmd(uint16_t id, const Location &loc) const
+{
+    uint16_t nearest_index = 0;
+    float min_distance = FLT_MAX;
+
+#if AP_MISSION_GEOMETRY_ENABLED
+    WITH_SEMAPHORE(_rsem);
+    if (update_geometry()) {
+        const Vector2f pos = _geometry.origin.get_distance_NE(loc);
+        // a marker with no location is only returned when no command
+        // with this id has one
+        uint16_t unlocated_index = 0;
+        for (uint16_t i = 0; i < _geometry.count; i++) {
+            const GeometryPoint &p = _geometry.points[i];
+            if (p.id != id) {
+                continue;
+            }
+            if (!p.located) {
+                if (unlocated_index == 0) {
+                    unlocated_index = p.index;
+                }
+                continue;
+            }
+            const float distance_sq = (p.ne - pos).length_squared();
+            if (distance_sq < min_distance) {
+                min_distance = distance_sq;
+                nearest_index = p.index;
+            }
+        }
+        return nearest_index != 0 ? nearest_index : unlocated_index;
+    }
+#endif
 
-    // Go through mission looking for nearest landing start command
     for (uint16_t i = 1; i < num_commands(); i++) {
         Mission_Command tmp;
         if (!read_cmd_from_storage(i, tmp)) {
             continue;
         }
-        if (tmp.id == MAV_CMD_DO_LAND_START) {
-            float tmp_distance = tmp.content.location.get_distance(current_loc);
-            if (min_distance < 0 || tmp_distance < min_distance) {
+        if (tmp.id == id) {
+            const float tmp_distance = tmp.content.location.get_distance(loc);
+            if (tmp_distance < min_distance) {
                 min_distance = tmp_distance;
-                landing_start_index = i;
+                nearest_index = i;
             }
         }
     }
 
-    return landing_start_index;
+    return nearest_index;
+}
+
+// find the nearest landing sequence starting point (DO_LAND_START) and
+// return its index.  Returns 0 if no appropriate DO_LAND_START point can
+// be found.
+uint16_t AP_Mission::get_landing_sequence_start() const
+{
+    struct Location current_loc;
+
+    if (!AP::ahrs().get_position(current_loc)) {
+        return 0;
+    }
+
+    return find_nearest_cmd(MAV_CMD_DO_LAND_START, current_loc);
 }
 
 /*
@@ -2038,21 +2193,7 @@ bool AP_Mission::jump_to_abort_landing_sequence(void)
 
     uint16_t abort_index = 0;
     if (AP::ahrs().get_position(current_loc)) {
-        float min_distance = FLT_MAX;
-
-        for (uint16_t i = 1; i < num_commands(); i++) {
-            Mission_Command tmp;
-            if (!read_cmd_from_storage(i, tmp)) {
-                continue;
-            }
-            if (tmp.id == MAV_CMD_DO_GO_AROUND) {
-                float tmp_distance = tmp.content.location.get_distance(current_loc);
-                if (tmp_distance < min_distance) {
-                    min_distance = tmp_distance;
-                    abort_index = i;
-                }
-            }
-        }
+        abort_index = find_nearest_cmd(MAV_CMD_DO_GO_AROUND, current_loc);
     }
 
     if (abort_index != 0 && set_current_cmd(abort_index)) {
@@ -2134,6 +2275,49 @@ bool AP_Mission::is_best_land_sequence(void)
     }
 }
 
+// get the horizontal distance from the vehicle along the remaining
+// mission legs to the last waypoint, not following DO_JUMPs
+bool AP_Mission::get_distance_remaining(float &distance_m) const
+{
+#if AP_MISSION_GEOMETRY_ENABLED
+    if (_flags.state != MISSION_RUNNING || !_flags.nav_cmd_loaded) {
+        return false;
+    }
+    Location current_loc;
+    if (!AP::ahrs().get_position(current_loc)) {
+        return false;
+    }
+
+    WITH_SEMAPHORE(_rsem);
+    if (!update_geometry()) {
+        return false;
+    }
+
+    // binary search for the first point at or after the current nav
+    // command, then skip landing and go around markers
+    uint16_t lo = 0;
+    uint16_t hi = _geometry.count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_geometry.points[mid].index < _nav_cmd.index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (; lo < _geometry.count; lo++) {
+        const GeometryPoint &p = _geometry.points[lo];
+        if (p.id == MAV_CMD_DO_LAND_START || p.id == MAV_CMD_DO_GO_AROUND) {
+            continue;
+        }
+        const Vector2f pos = _geometry.origin.get_distance_NE(current_loc);
+        distance_m = (p.ne - pos).length() + (_geometry.path_m - p.path_m);
+        return true;
+    }
+#endif
+    return false;
+}
+
 // Approximate the distance travelled to get to a landing.  DO_JUMP commands are observed in look forward.
 bool AP_Mission::distance_to_landing(uint16_t index, float &tot_distance, Location prev_loc)
 {
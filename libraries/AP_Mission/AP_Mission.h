@@ -44,6 +44,18 @@
 #define AP_MISSION_MAX_WP_HISTORY           7       // The maximum number of previous wp commands that will be stored from the active missions history
 #define LAST_WP_PASSED (AP_MISSION_MAX_WP_HISTORY-2)
 
+// keep a decoded copy of every command in RAM so that mission
+// lookahead and searches don't read and unpack storage
+#ifndef AP_MISSION_CACHE_ENABLED
+#define AP_MISSION_CACHE_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_1000)
+#endif
+
+// keep horizontal offsets and path lengths of the mission locations so
+// nearest landing and remaining distance queries don't scan the mission
+#ifndef AP_MISSION_GEOMETRY_ENABLED
+#define AP_MISSION_GEOMETRY_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
 /// @class    AP_Mission
 /// @brief    Object managing Mission
 class AP_Mission
@@ -502,6 +514,10 @@ public:
     ///     true is return if successful
     bool read_cmd_from_storage(uint16_t index, Mission_Command& cmd) const;
 
+    /// unpack_cmd_from_storage - unpack a command from storage, without
+    ///     checking it is within the mission
+    void unpack_cmd_from_storage(uint16_t index, Mission_Command& cmd) const;
+
     /// write_cmd_to_storage - write a command to storage
     ///     cmd.index is used to calculate the storage location
     ///     true is returned if successful
@@ -550,6 +566,12 @@ public:
     // check which is the shortest route to landing an RTL via a DO_LAND_START or continuing on the current mission plan
     bool is_best_land_sequence(void);
 
+    // get the horizontal distance in meters from the vehicle along the
+    // remaining mission legs to the last waypoint, not following
+    // DO_JUMPs. Returns false if the mission isn't running or there
+    // is no waypoint ahead
+    bool get_distance_remaining(float &distance_m) const;
+
     // set in_landing_sequence flag
     void set_in_landing_sequence_flag(bool flag)
     {
@@ -717,6 +739,43 @@ private:
     // const functions
     static HAL_Semaphore _rsem;
 
+#if AP_MISSION_GEOMETRY_ENABLED
+    // a nav command with a location, or a DO_LAND_START/DO_GO_AROUND
+    struct GeometryPoint {
+        uint16_t index;         // command index
+        uint16_t id;            // command id
+        Vector2f ne;            // offset from the geometry origin (m)
+        bool located;           // false for a marker with no location
+        float path_m;           // distance along nav legs from the first nav point (m)
+    };
+
+    // mission geometry in command order, rebuilt on first use after
+    // the mission changes. Protected by _rsem
+    mutable struct {
+        GeometryPoint *points;
+        uint16_t count;
+        uint16_t capacity;
+        uint16_t cmd_total;     // _cmd_total when built
+        bool valid;
+        Location origin;        // first point with a location
+        float path_m;           // length of all nav legs (m)
+    } _geometry;
+
+    bool update_geometry() const;
+#endif
+
+    // index of the command with the given id closest to loc, 0 if none
+    uint16_t find_nearest_cmd(uint16_t id, const Location &loc) const;
+
+#if AP_MISSION_CACHE_ENABLED
+    // decoded commands, entry i is valid when its index is i. Written
+    // through by write_cmd_to_storage() and protected by _rsem
+    Mission_Command *_cmd_cache;
+    uint16_t _cmd_cache_size;
+
+    void init_cmd_cache();
+#endif
+
     // mission items common to all vehicles:
     bool start_command_do_aux_function(const AP_Mission::Mission_Command& cmd);
     bool start_command_do_gripper(const AP_Mission::Mission_Command& cmd);
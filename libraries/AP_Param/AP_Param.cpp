@@ -24,6 +24,7 @@
 #include "AP_Param.h"
 
 #include <cmath>
+#include <ctype.h>
 #include <string.h>
 
 #include <AP_Common/AP_Common.h>
@@ -81,6 +82,15 @@ uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
 HAL_Semaphore AP_Param::_count_sem;
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+AP_Param::LookupIndex AP_Param::_lookup;
+#endif
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+AP_Param::StorageIndex AP_Param::_storage_index;
+HAL_Semaphore AP_Param::_storage_index_sem;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -152,6 +162,12 @@ void AP_Param::erase_all(void)
 
     // add a sentinal directly after the header
     write_sentinal(sizeof(struct EEPROM_header));
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    WITH_SEMAPHORE(_storage_index_sem);
+    storage_index_clear();
+    _storage_index.valid = true;
+#endif
 }
 
 /* the 'group_id' of a element of a group is the 18 bit identifier
@@ -341,6 +357,10 @@ bool AP_Param::setup(void)
             hdr2.magic[1] == k_EEPROM_magic1 &&
             hdr2.revision == k_EEPROM_revision &&
             _storage.copy_area(_storage_bak)) {
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+            WITH_SEMAPHORE(_storage_index_sem);
+            _storage_index.valid = false;
+#endif
             // restored from backup
             INTERNAL_ERROR(AP_InternalError::error_t::params_restored);
             return true;
@@ -720,6 +740,19 @@ bool AP_Param::is_sentinal(const Param_header &phdr)
 // if the sentinal isn't found either, the offset is set to 0xFFFF
 bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
 {
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_storage_index_sem);
+        if (_storage_index.valid || storage_index_build()) {
+            if (storage_index_find(*target, *pofs)) {
+                return true;
+            }
+            *pofs = sentinal_offset;
+            return false;
+        }
+    }
+#endif
+
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
     while (ofs < _storage.size()) {
@@ -744,6 +777,130 @@ bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
     return false;
 }
 
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+// a Param_header as a single value
+static uint32_t header_value(const void *phdr)
+{
+    uint32_t v;
+    memcpy(&v, phdr, sizeof(v));
+    return v;
+}
+
+static uint16_t header_hash(uint32_t v, uint16_t size)
+{
+    return (v * 2654435761U) >> 16 & (size - 1);
+}
+
+void AP_Param::storage_index_clear(void)
+{
+    if (_storage_index.headers != nullptr) {
+        memset(_storage_index.headers, 0, _storage_index.size * sizeof(uint32_t));
+    }
+    _storage_index.count = 0;
+    _storage_index.valid = false;
+}
+
+/*
+  add a parameter at storage offset ofs. As with scan() the first copy
+  of a parameter in storage is the one used. Must be called with
+  _storage_index_sem held
+ */
+bool AP_Param::storage_index_insert(const Param_header &phdr, uint16_t ofs)
+{
+    const uint32_t v = header_value(&phdr);
+
+    // keep the table at most half full
+    if (2*(_storage_index.count+1) > _storage_index.size) {
+        const uint16_t new_size = _storage_index.size ? _storage_index.size * 2 : 128;
+        uint32_t *headers = new uint32_t[new_size];
+        uint16_t *offsets = new uint16_t[new_size];
+        if (headers == nullptr || offsets == nullptr) {
+            delete[] headers;
+            delete[] offsets;
+            _storage_index.valid = false;
+            return false;
+        }
+        memset(headers, 0, new_size * sizeof(uint32_t));
+        for (uint16_t i=0; i<_storage_index.size; i++) {
+            const uint32_t h = _storage_index.headers[i];
+            if (h == 0) {
+                continue;
+            }
+            uint16_t slot = header_hash(h, new_size);
+            while (headers[slot] != 0) {
+                slot = (slot + 1) & (new_size - 1);
+            }
+            headers[slot] = h;
+            offsets[slot] = _storage_index.offsets[i];
+        }
+        delete[] _storage_index.headers;
+        delete[] _storage_index.offsets;
+        _storage_index.headers = headers;
+        _storage_index.offsets = offsets;
+        _storage_index.size = new_size;
+    }
+
+    uint16_t slot = header_hash(v, _storage_index.size);
+    while (_storage_index.headers[slot] != 0) {
+        if (_storage_index.headers[slot] == v) {
+            return true;
+        }
+        slot = (slot + 1) & (_storage_index.size - 1);
+    }
+    _storage_index.headers[slot] = v;
+    _storage_index.offsets[slot] = ofs;
+    _storage_index.count++;
+    return true;
+}
+
+/*
+  find the storage offset of a parameter. Must be called with
+  _storage_index_sem held and a valid index
+ */
+bool AP_Param::storage_index_find(const Param_header &phdr, uint16_t &ofs)
+{
+    const uint32_t v = header_value(&phdr);
+    if (_storage_index.size == 0 || is_sentinal(phdr)) {
+        return false;
+    }
+    for (uint16_t slot = header_hash(v, _storage_index.size);
+         _storage_index.headers[slot] != 0;
+         slot = (slot + 1) & (_storage_index.size - 1)) {
+        if (_storage_index.headers[slot] == v) {
+            ofs = _storage_index.offsets[slot];
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  build the index with a pass over storage up to the sentinal. Must be
+  called with _storage_index_sem held
+ */
+bool AP_Param::storage_index_build(void)
+{
+    storage_index_clear();
+
+    struct Param_header phdr;
+    uint16_t ofs = sizeof(AP_Param::EEPROM_header);
+    while (ofs < _storage.size()) {
+        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        if (is_sentinal(phdr)) {
+            sentinal_offset = ofs;
+            _storage_index.valid = true;
+            return true;
+        }
+        if (!storage_index_insert(phdr, ofs)) {
+            return false;
+        }
+        ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
+    }
+    // no sentinal, leave it to scan()
+    return false;
+}
+#endif // AP_PARAM_STORAGE_INDEX_ENABLED
+
 /**
  * add a _X, _Y, _Z suffix to the name of a Vector3f element
  * @param buffer
@@ -875,6 +1032,44 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
 {
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    /*
+      the index is rebuilt by count_parameters() on the IO thread,
+      rebuilding it here could make a run of find() calls between
+      invalidations slower than walking the tree. Don't wait for a
+      rebuild in progress either, walk the tree instead.
+
+      Names are matched case-sensitively here. The tree walk below
+      matches group prefixes case-sensitively but top level names
+      without case, so anything else is left to it to keep its
+      results unchanged
+     */
+    if (_count_sem.take_nonblocking()) {
+        const LookupEntry *e = lookup_index_valid() ? lookup_by_name(name, true, true) : nullptr;
+        _count_sem.give();
+        if (e != nullptr && _var_info[e->token.key].type == AP_PARAM_VECTOR3F) {
+            // the tree walk has no element names for top level vectors
+            e = nullptr;
+        }
+        if (e != nullptr) {
+            *ptype = (enum ap_var_type)e->type;
+            if (flags != nullptr) {
+                uint32_t group_element = 0;
+                const struct GroupInfo *ginfo;
+                struct GroupNesting group_nesting {};
+                uint8_t idx;
+                e->ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
+                if (ginfo != nullptr) {
+                    *flags = ginfo->flags;
+                }
+            }
+            return e->ap;
+        }
+    }
+    // not a visible scalar, it may be a whole vector, a group or a
+    // hidden parameter
+#endif
+
     for (uint16_t i=0; i<_num_vars; i++) {
         uint8_t type = _var_info[i].type;
         if (type == AP_PARAM_GROUP) {
@@ -915,11 +1110,29 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
     return nullptr;
 }
 
-// Find a variable by index. Note that this is quite slow.
+// Find a variable by index. Note that this is quite slow without the
+// lookup index.
 //
 AP_Param *
 AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
 {
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_count_sem);
+        if (lookup_index_update()) {
+            if (idx >= _lookup.count) {
+                return nullptr;
+            }
+            const LookupEntry &e = _lookup.entries[idx];
+            *token = e.token;
+            if (ptype != nullptr) {
+                *ptype = (enum ap_var_type)e.type;
+            }
+            return e.ap;
+        }
+    }
+#endif
+
     AP_Param *ap;
     uint16_t count=0;
     for (ap=AP_Param::first(token, ptype);
@@ -933,6 +1146,21 @@ AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token
 // by-name equivalent of find_by_index()
 AP_Param* AP_Param::find_by_name(const char* name, enum ap_var_type *ptype, ParamToken *token)
 {
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_count_sem);
+        if (lookup_index_update()) {
+            const LookupEntry *e = lookup_by_name(name, false, false);
+            if (e == nullptr) {
+                return nullptr;
+            }
+            *token = e->token;
+            *ptype = (enum ap_var_type)e->type;
+            return e->ap;
+        }
+    }
+#endif
+
     AP_Param *ap;
     uint16_t count = 0;
     for (ap = AP_Param::first(token, ptype);
@@ -1191,6 +1419,15 @@ void AP_Param::save_sync(bool force_save, bool send_to_gcs)
     eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(&phdr, ofs, sizeof(phdr));
 
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_storage_index_sem);
+        if (_storage_index.valid) {
+            storage_index_insert(phdr, ofs);
+        }
+    }
+#endif
+
     if (send_to_gcs) {
         send_parameter(name, (enum ap_var_type)phdr.type, idx);
     }
@@ -1488,14 +1725,29 @@ bool AP_Param::load_all()
         registered_save_handler = true;
         hal.scheduler->register_io_process(FUNCTOR_BIND((&save_dummy), &AP_Param::save_io_handler, void));
     }
-    
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    // build the storage index in the same pass
+    WITH_SEMAPHORE(_storage_index_sem);
+    storage_index_clear();
+    bool index_ok = true;
+#endif
+
     while (ofs < _storage.size()) {
         _storage.read_block(&phdr, ofs, sizeof(phdr));
         if (is_sentinal(phdr)) {
             // we've reached the sentinal
             sentinal_offset = ofs;
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+            _storage_index.valid = index_ok;
+#endif
             return true;
         }
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+        if (index_ok) {
+            index_ok = storage_index_insert(phdr, ofs);
+        }
+#endif
 
         const struct AP_Param::Info *info;
         void *ptr;
@@ -2401,6 +2653,14 @@ uint16_t AP_Param::count_parameters(void)
         _count_marker == _count_marker_done) {
         return _parameter_count;
     }
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    // count while building the lookup index
+    if (lookup_index_update()) {
+        _parameter_count = _lookup.count;
+        _count_marker_done = _lookup.marker;
+        return _parameter_count;
+    }
+#endif
     /*
       cope with another thread invalidating the count while we are
       counting
@@ -2425,6 +2685,138 @@ uint16_t AP_Param::count_parameters(void)
     return _parameter_count;
 }
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+/*
+  case insensitive FNV-1a hash of a parameter name
+ */
+uint16_t AP_Param::lookup_name_hash(const char *name)
+{
+    uint32_t h = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i]; i++) {
+        h ^= (uint8_t)toupper(name[i]);
+        h *= 16777619U;
+    }
+    return (h >> 16) ^ (h & 0xFFFF);
+}
+
+/*
+  make sure the lookup index matches the current parameter tree,
+  rebuilding it if the tree has changed. Must be called with _count_sem
+  held. Returns false if the index can't be used
+ */
+bool AP_Param::lookup_index_update(void)
+{
+    if (lookup_index_valid()) {
+        return true;
+    }
+    _lookup.valid = false;
+
+    const uint16_t marker = _count_marker;
+
+    AP_Param::ParamToken token {};
+    enum ap_var_type type;
+    uint16_t count = 0;
+    for (AP_Param *ap = AP_Param::first(&token, &type);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &type)) {
+        if (count == _lookup.capacity) {
+            const uint16_t new_capacity = _lookup.capacity ? _lookup.capacity * 2 : 256;
+            LookupEntry *entries = new LookupEntry[new_capacity];
+            if (entries == nullptr) {
+                return false;
+            }
+            if (_lookup.entries != nullptr) {
+                memcpy(entries, _lookup.entries, count * sizeof(LookupEntry));
+                delete[] _lookup.entries;
+            }
+            _lookup.entries = entries;
+            _lookup.capacity = new_capacity;
+        }
+        LookupEntry &e = _lookup.entries[count++];
+        e.ap = ap;
+        e.token = token;
+        e.type = type;
+        char name[AP_MAX_NAME_SIZE+1] {};
+        ap->copy_name_token(token, name, AP_MAX_NAME_SIZE, true);
+        e.name_hash = lookup_name_hash(name);
+    }
+    _lookup.count = count;
+
+    // keep the table at most half full
+    uint16_t table_size = 64;
+    while (table_size < 2*count) {
+        table_size *= 2;
+    }
+    if (table_size != _lookup.table_size) {
+        delete[] _lookup.table;
+        _lookup.table_size = 0;
+        _lookup.table = new uint16_t[table_size];
+        if (_lookup.table == nullptr) {
+            return false;
+        }
+        _lookup.table_size = table_size;
+    }
+    memset(_lookup.table, 0xFF, table_size * sizeof(uint16_t));
+    for (uint16_t i=0; i<count; i++) {
+        uint16_t slot = _lookup.entries[i].name_hash & (table_size-1);
+        while (_lookup.table[slot] != 0xFFFF) {
+            slot = (slot + 1) & (table_size-1);
+        }
+        _lookup.table[slot] = i;
+    }
+
+    _lookup.marker = marker;
+    _lookup.valid = true;
+    return true;
+}
+
+/*
+  find a scalar parameter in a valid lookup index. Entries are hashed
+  by their element name, e.g. INS_ACCOFFS_X. With force_scalar false
+  names are matched the way copy_name_token() gives them by default,
+  where the X element of a vector has no suffix. The hash ignores
+  case, so both kinds of match probe the same slots. Must be called
+  with _count_sem held
+ */
+const AP_Param::LookupEntry *AP_Param::lookup_by_name(const char *name, bool case_sensitive, bool force_scalar)
+{
+    const LookupEntry *e = lookup_probe(name, lookup_name_hash(name), case_sensitive, force_scalar);
+    const size_t len = strnlen(name, AP_MAX_NAME_SIZE);
+    if (e == nullptr && !force_scalar && len + 2 <= AP_MAX_NAME_SIZE) {
+        // may be the X element of a vector, hashed with its suffix
+        char xname[AP_MAX_NAME_SIZE+1] {};
+        memcpy(xname, name, len);
+        xname[len] = '_';
+        xname[len+1] = 'X';
+        e = lookup_probe(name, lookup_name_hash(xname), case_sensitive, force_scalar);
+    }
+    return e;
+}
+
+/*
+  probe the lookup index slots for hash, comparing name against the
+  entry names given by copy_name_token()
+ */
+const AP_Param::LookupEntry *AP_Param::lookup_probe(const char *name, uint16_t hash, bool case_sensitive, bool force_scalar)
+{
+    const uint16_t mask = _lookup.table_size - 1;
+    for (uint16_t slot = hash & mask; _lookup.table[slot] != 0xFFFF; slot = (slot + 1) & mask) {
+        const LookupEntry &e = _lookup.entries[_lookup.table[slot]];
+        if (e.name_hash != hash) {
+            continue;
+        }
+        char buf[AP_MAX_NAME_SIZE+1] {};
+        e.ap->copy_name_token(e.token, buf, AP_MAX_NAME_SIZE, force_scalar);
+        const int cmp = case_sensitive ? strncmp(name, buf, AP_MAX_NAME_SIZE) :
+            strncasecmp(name, buf, AP_MAX_NAME_SIZE);
+        if (cmp == 0) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+#endif // AP_PARAM_LOOKUP_INDEX_ENABLED
+
 /*
   invalidate parameter count cache
  */
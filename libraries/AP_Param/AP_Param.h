@@ -46,6 +46,22 @@
 #endif
 #endif
 
+/*
+  keep an index of all scalar parameters for constant time lookup by
+  name and by index
+ */
+#ifndef AP_PARAM_LOOKUP_INDEX_ENABLED
+#define AP_PARAM_LOOKUP_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+/*
+  keep the storage offset of each saved parameter in RAM so saves and
+  loads don't scan storage
+ */
+#ifndef AP_PARAM_STORAGE_INDEX_ENABLED
+#define AP_PARAM_STORAGE_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
 /*
   flags for variables in var_info and group tables
  */
@@ -650,6 +666,26 @@ private:
     static bool                 scan(
                                     const struct Param_header *phdr,
                                     uint16_t *pofs);
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    /*
+      offsets of saved parameters keyed by their header, built by one
+      pass over storage and updated as parameters are appended
+     */
+    struct StorageIndex {
+        // header of each slot, zero for an empty slot
+        uint32_t *headers;
+        uint16_t *offsets;
+        uint16_t size;
+        uint16_t count;
+        bool valid;
+    };
+    static StorageIndex         _storage_index;
+    static HAL_Semaphore        _storage_index_sem;
+    static void                 storage_index_clear(void);
+    static bool                 storage_index_insert(const Param_header &phdr, uint16_t ofs);
+    static bool                 storage_index_find(const Param_header &phdr, uint16_t &ofs);
+    static bool                 storage_index_build(void);
+#endif
     static void                 eeprom_write_check(
                                     const void *ptr,
                                     uint16_t ofs,
@@ -697,6 +733,38 @@ private:
     static HAL_Semaphore        _count_sem;
     static const struct Info *  _var_info;
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    /*
+      scalar parameters in enumeration order, with an open addressing
+      hash table of their names. Built on first use and rebuilt when
+      the parameter count is invalidated
+     */
+    struct LookupEntry {
+        AP_Param *ap;
+        ParamToken token;
+        uint16_t name_hash;
+        uint8_t type;
+    };
+    struct LookupIndex {
+        LookupEntry *entries;
+        uint16_t count;
+        uint16_t capacity;
+        // index into entries, 0xFFFF for an empty slot
+        uint16_t *table;
+        uint16_t table_size;
+        uint16_t marker;
+        bool valid;
+    };
+    static LookupIndex          _lookup;
+    static uint16_t             lookup_name_hash(const char *name);
+    static bool                 lookup_index_valid(void) {
+        return _lookup.valid && _lookup.marker == _count_marker;
+    }
+    static bool                 lookup_index_update(void);
+    static const LookupEntry *  lookup_by_name(const char *name, bool case_sensitive, bool force_scalar);
+    static const LookupEntry *  lookup_probe(const char *name, uint16_t hash, bool case_sensitive, bool force_scalar);
+#endif
+
     /*
       list of overridden values from load_defaults_file()
     */
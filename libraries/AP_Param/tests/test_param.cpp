@@ -0,0 +1,126 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class TestGroup {
+public:
+    AP_Float gain;
+    AP_Vector3f offs;
+    AP_Int8 mode;
+
+    static const struct AP_Param::GroupInfo var_info[];
+};
+
+const AP_Param::GroupInfo TestGroup::var_info[] = {
+    AP_GROUPINFO("GAIN", 1, TestGroup, gain, 0.5f),
+    AP_GROUPINFO("OFFS", 2, TestGroup, offs, 0),
+    AP_GROUPINFO("MODE", 3, TestGroup, mode, 1),
+    AP_GROUPEND
+};
+
+static AP_Int16 test_scalar;
+static AP_Vector3f test_vector;
+static TestGroup test_group;
+
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_INT16, "TSCALAR", 0, &test_scalar, {def_value : 3} },
+    { AP_PARAM_VECTOR3F, "TVEC", 1, &test_vector, {def_value : 0} },
+    { AP_PARAM_GROUP, "TST_", 2, &test_group, {group_info : TestGroup::var_info} },
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+static const char *test_names[] {
+    "TSCALAR", "tscalar", "TVEC", "TVEC_X", "TVEC_Y",
+    "TST_GAIN", "TST_gain", "tst_GAIN", "TST_OFFS", "TST_OFFS_X",
+    "TST_OFFS_Y", "TST_OFFS_Z", "TST_offs_x", "TST_MODE", "TST_", "TST_NONE",
+};
+
+struct FindResult {
+    AP_Param *ap;
+    enum ap_var_type type;
+};
+
+static FindResult find_result(const char *name)
+{
+    FindResult r {};
+    r.type = AP_PARAM_NONE;
+    r.ap = AP_Param::find(name, &r.type);
+    return r;
+}
+
+/*
+  find() gives the same results with the lookup index as without it,
+  including whole vectors looked up by name
+ */
+TEST(AP_Param, FindMatchesTreeWalk)
+{
+    FindResult walked[ARRAY_SIZE(test_names)];
+
+    // the index is only built by count_parameters()
+    AP_Param::invalidate_count();
+    for (uint8_t i=0; i<ARRAY_SIZE(test_names); i++) {
+        walked[i] = find_result(test_names[i]);
+    }
+
+    EXPECT_EQ(AP_Param::count_parameters(), 1U + 3U + 5U);
+
+    for (uint8_t i=0; i<ARRAY_SIZE(test_names); i++) {
+        const FindResult r = find_result(test_names[i]);
+        EXPECT_EQ(r.ap, walked[i].ap) << test_names[i];
+        EXPECT_EQ(r.type, walked[i].type) << test_names[i];
+    }
+}
+
+TEST(AP_Param, FindVector)
+{
+    AP_Param::count_parameters();
+
+    FindResult r = find_result("TST_OFFS");
+    EXPECT_EQ(r.ap, (AP_Param *)&test_group.offs);
+    EXPECT_EQ(r.type, AP_PARAM_VECTOR3F);
+
+    r = find_result("TVEC");
+    EXPECT_EQ(r.ap, (AP_Param *)&test_vector);
+    EXPECT_EQ(r.type, AP_PARAM_VECTOR3F);
+
+    r = find_result("TST_OFFS_X");
+    EXPECT_EQ(r.ap, (AP_Param *)&test_group.offs);
+    EXPECT_EQ(r.type, AP_PARAM_FLOAT);
+
+    r = find_result("TST_OFFS_Z");
+    EXPECT_EQ(r.ap, (AP_Param *)(((uint8_t *)&test_group.offs) + 2*sizeof(float)));
+    EXPECT_EQ(r.type, AP_PARAM_FLOAT);
+}
+
+/*
+  find_by_name() uses the default element names, where the X element
+  of a vector has no suffix
+ */
+TEST(AP_Param, FindByName)
+{
+    AP_Param::count_parameters();
+
+    AP_Param::ParamToken token {};
+    enum ap_var_type type;
+
+    AP_Param *ap = AP_Param::find_by_name("TST_OFFS", &type, &token);
+    EXPECT_EQ(ap, (AP_Param *)&test_group.offs);
+    EXPECT_EQ(type, AP_PARAM_FLOAT);
+
+    ap = AP_Param::find_by_name("tst_offs_y", &type, &token);
+    EXPECT_EQ(ap, (AP_Param *)(((uint8_t *)&test_group.offs) + sizeof(float)));
+    EXPECT_EQ(type, AP_PARAM_FLOAT);
+
+    EXPECT_EQ(AP_Param::find_by_name("TST_OFFS_X", &type, &token), nullptr);
+
+    ap = AP_Param::find_by_name("tscalar", &type, &token);
+    EXPECT_EQ(ap, (AP_Param *)&test_scalar);
+    EXPECT_EQ(type, AP_PARAM_INT16);
+}
+
+AP_GTEST_MAIN()
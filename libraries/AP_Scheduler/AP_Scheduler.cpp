@@ -27,6 +27,7 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <AP_InternalError/AP_InternalError.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_HAL/utility/SemaphoreProfiler.h>
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #include <SITL/SITL.h>
@@ -210,7 +211,9 @@ void AP_Scheduler::run(uint32_t time_available)
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         fill_nanf_stack();
 #endif
+        hal.util->trace_begin(task.name);
         task.function();
+        hal.util->trace_end(task.name);
         if (_debug > 1 && _perf_counters && _perf_counters[i]) {
             hal.util->perf_end(_perf_counters[i]);
         }
@@ -283,7 +286,9 @@ void AP_Scheduler::loop()
     // wait for an INS sample
     hal.util->persistent_data.scheduler_task = -3;
     _rsem.give();
+    hal.util->trace_begin("wait_for_sample");
     AP::ins().wait_for_sample();
+    hal.util->trace_end("wait_for_sample");
     _rsem.take_blocking();
     hal.util->persistent_data.scheduler_task = -1;
 
@@ -300,7 +305,9 @@ void AP_Scheduler::loop()
     // ---------------------
     if (_fastloop_fn) {
         hal.util->persistent_data.scheduler_task = -2;
+        hal.util->trace_begin("fast_loop");
         _fastloop_fn();
+        hal.util->trace_end("fast_loop");
         hal.util->persistent_data.scheduler_task = -1;
     }
 
@@ -376,6 +383,7 @@ void AP_Scheduler::update_logging()
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+        Log_Write_Semaphores();
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
@@ -410,6 +418,37 @@ void AP_Scheduler::Log_Write_Performance()
     AP::logger().WriteCriticalBlock(&pkt, sizeof(pkt));
 }
 
+// Write semaphore contention statistics, if they are being collected
+void AP_Scheduler::Log_Write_Semaphores()
+{
+#if HAL_SEMAPHORE_PROFILE_ENABLED
+    if (!SemaphoreProfiler::enabled()) {
+        return;
+    }
+    SemaphoreProfiler::Stats stats[5];
+    const uint16_t n = SemaphoreProfiler::get_worst(stats, ARRAY_SIZE(stats));
+    const uint64_t now = AP_HAL::micros64();
+    for (uint16_t i = 0; i < n; i++) {
+        const SemaphoreProfiler::Stats &s = stats[i];
+        struct log_Semaphore pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_SEMAPHORE_MSG),
+            time_us       : now,
+            site          : {},
+            owner         : {},
+            takes         : s.takes,
+            contended     : s.contended,
+            wait_total_us : s.wait_total_us,
+            wait_max_us   : s.wait_max_us,
+            hold_total_us : s.hold_total_us,
+            hold_max_us   : s.hold_max_us,
+        };
+        strncpy(pkt.site, s.name, sizeof(pkt.site));
+        strncpy(pkt.owner, s.owner, sizeof(pkt.owner));
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+#endif
+}
+
 // display task statistics as text buffer for @SYS/tasks.txt
 void AP_Scheduler::task_info(ExpandingString &str)
 {
@@ -96,6 +96,9 @@ public:
     // write out PERF message to logger
     void Log_Write_Performance();
 
+    // write out SEM messages for the most contended semaphore sites
+    void Log_Write_Semaphores();
+
     // call when one tick has passed
     void tick(void);
 
@@ -41,7 +41,7 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping at least 12 grid squares in memory (more on boards with memory to spare) with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
     // @Units: m
     // @Increment: 1
     // @User: Advanced
@@ -108,6 +108,33 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
     // find the grid
     const struct grid_block &grid = find_grid_cache(info).grid;
 
+    if (!interpolate_height(grid, info, height, nullptr)) {
+        return false;
+    }
+
+    if (loc.lat == ahrs.get_home().lat &&
+        loc.lng == ahrs.get_home().lng) {
+        // remember home altitude as a special case
+        home_height = height;
+        home_loc = loc;
+    }
+
+    // apply correction which assumes home altitude is at terrain altitude
+    if (corrected) {
+        height += (ahrs.get_home().alt * 0.01f) - home_height;
+    }
+
+    return true;
+}
+
+
+/*
+  interpolate the height and optionally the slope at a location
+  within a grid block
+ */
+bool AP_Terrain::interpolate_height(const struct grid_block &grid, const struct grid_info &info,
+                                    float &height, Vector2f *slope)
+{
     /*
       note that we rely on the one square overlap to ensure these
       calculations don't go past the end of the arrays
@@ -141,19 +168,136 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
 
     height = avg;
 
-    if (loc.lat == ahrs.get_home().lat &&
-        loc.lng == ahrs.get_home().lng) {
-        // remember home altitude as a special case
-        home_height = height;
-        home_loc = loc;
+    if (slope != nullptr) {
+        // gradient of the same interpolation
+        slope->x = ((1.0f-info.frac_y) * (h10 - h00) + info.frac_y * (h11 - h01)) / grid_spacing;
+        slope->y = (avg2 - avg1) / grid_spacing;
     }
 
-    // apply correction which assumes home altitude is at terrain altitude
-    if (corrected) {
-        height += (ahrs.get_home().alt * 0.01f) - home_height;
+    return true;
+}
+
+/*
+  find the height at a location, reusing the grid block of the
+  previous lookup in a batch when the location is in the same block.
+  Unless the batch loads missing blocks, only blocks already in the
+  cache are used and a block that isn't there is reported as missing,
+  so a query far from the vehicle can't evict the blocks around it
+ */
+bool AP_Terrain::batch_height(const Location &loc, struct batch_lookup &state,
+                              float &height, Vector2f *slope)
+{
+    struct grid_info info;
+    calculate_grid_idx(loc, info);
+
+    if (!state.searched ||
+        info.lat_degrees != state.lat_degrees ||
+        info.lon_degrees != state.lon_degrees ||
+        info.grid_idx_x != state.grid_idx_x ||
+        info.grid_idx_y != state.grid_idx_y) {
+        calculate_grid_corner(info);
+        if (state.load_missing) {
+            state.gcache = &find_grid_cache(info);
+        } else {
+            const int16_t idx = find_cache_idx(info.grid_lat, info.grid_lon, grid_spacing);
+            state.gcache = idx != -1 ? &cache[idx] : nullptr;
+        }
+        state.searched = true;
+        state.lat_degrees = info.lat_degrees;
+        state.lon_degrees = info.lon_degrees;
+        state.grid_idx_x = info.grid_idx_x;
+        state.grid_idx_y = info.grid_idx_y;
     }
 
-    return true;
+    if (state.gcache == nullptr) {
+        return false;
+    }
+    return interpolate_height(state.gcache->grid, info, height, slope);
+}
+
+/*
+  return terrain heights in meters above sea level for an array of
+  locations, sharing grid lookups between neighbouring locations
+ */
+uint16_t AP_Terrain::height_amsl_batch(const Location *locs, uint16_t count,
+                                       float *heights, bool *valid, Vector2f *slopes)
+{
+    if (!allocate() || grid_spacing <= 0) {
+        for (uint16_t i=0; i<count; i++) {
+            valid[i] = false;
+        }
+        return 0;
+    }
+
+    struct batch_lookup state {};
+    uint16_t num_valid = 0;
+    for (uint16_t i=0; i<count; i++) {
+        valid[i] = batch_height(locs[i], state, heights[i], slopes != nullptr ? &slopes[i] : nullptr);
+        if (valid[i]) {
+            num_valid++;
+        }
+    }
+    return num_valid;
+}
+
+/*
+  sample terrain heights along a polyline
+ */
+bool AP_Terrain::height_profile(const Location *path, uint16_t path_len, float spacing,
+                                float *heights, float *slopes, uint16_t max_samples,
+                                uint16_t &num_samples)
+{
+    num_samples = 0;
+    if (!allocate() || grid_spacing <= 0 || path_len == 0 || !is_positive(spacing)) {
+        return false;
+    }
+
+    struct batch_lookup state {};
+    bool all_valid = true;
+
+    // distance along the current leg of the next sample, and the
+    // direction of the leg. The final vertex keeps the direction of
+    // the last leg for its slope
+    float leg_pos = 0;
+    Vector2f dir;
+    for (uint16_t i=0; i<path_len; i++) {
+        const bool last = (i == path_len-1);
+        float leg_length = 0;
+        if (last) {
+            leg_pos = 0;
+        } else {
+            const Vector2f leg = path[i].get_distance_NE(path[i+1]);
+            leg_length = leg.length();
+            if (is_positive(leg_length)) {
+                dir = leg / leg_length;
+            }
+        }
+
+        while (last || leg_pos < leg_length) {
+            if (num_samples >= max_samples) {
+                return false;
+            }
+            Location loc = path[i];
+            loc.offset(dir.x * leg_pos, dir.y * leg_pos);
+            Vector2f slope;
+            if (!batch_height(loc, state, heights[num_samples], &slope)) {
+                all_valid = false;
+                heights[num_samples] = 0;
+                slope.zero();
+            }
+            if (slopes != nullptr) {
+                slopes[num_samples] = slope * dir;
+            }
+            num_samples++;
+            if (last) {
+                break;
+            }
+            leg_pos += spacing;
+        }
+        leg_pos -= leg_length;
+    }
+
+    return all_valid;
 }
 
 
@@ -278,13 +422,17 @@ float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
     float climb = 0;
     float lookahead_estimate = 0;
 
-    // check for terrain at grid spacing intervals
+    // check for terrain at grid spacing intervals, reusing the grid
+    // block while the steps stay within it. This is the path we are
+    // flying, so load blocks that are missing
+    struct batch_lookup state {};
+    state.load_missing = true;
     while (distance > 0) {
         loc.offset_bearing(bearing, grid_spacing);
         climb += climb_ratio * grid_spacing;
         distance -= grid_spacing;
         float height;
-        if (height_amsl(loc, height, false)) {
+        if (batch_height(loc, state, height, nullptr)) {
             float rise = (height - base_height) - climb;
             if (rise > lookahead_estimate) {
                 lookahead_estimate = rise;
@@ -328,6 +476,9 @@ void AP_Terrain::update(void)
     // check for pending rally data
     update_rally_data();
 
+    // load grids ahead of the vehicle
+    update_prefetch();
+
     // update capabilities and status
     if (allocate()) {
         if (!pos_valid) {
@@ -390,13 +541,33 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
+
+    // use up to half the free memory, so a route's worth of grids
+    // can be held on boards which have the memory to spare
+    uint32_t n = (hal.util->available_memory() / 2) / sizeof(cache[0]);
+    n = constrain_int32(n, TERRAIN_GRID_BLOCK_CACHE_SIZE, TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX);
+    while (true) {
+        cache = (struct grid_cache *)calloc(n, sizeof(cache[0]));
+        if (cache != nullptr || n == TERRAIN_GRID_BLOCK_CACHE_SIZE) {
+            break;
+        }
+        n = MAX(n/2, uint32_t(TERRAIN_GRID_BLOCK_CACHE_SIZE));
+    }
     if (cache == nullptr) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         memory_alloc_failed = true;
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    cache_size = n;
+
+    // hash table at most half full. If this fails find_cache_idx()
+    // falls back to a linear search
+    cache_hash_size = 1;
+    while (cache_hash_size < 2*cache_size) {
+        cache_hash_size <<= 1;
+    }
+    cache_hash = (uint8_t *)malloc(cache_hash_size);
+    rebuild_cache_hash();
     return true;
 }
 
@@ -51,9 +51,40 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// minimum number of grid_blocks in the LRU memory cache
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
 
+// maximum number of grid_blocks in the LRU memory cache. The cache is
+// sized to half the free memory within these limits
+#ifndef TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX 128
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX 48
+#else
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX TERRAIN_GRID_BLOCK_CACHE_SIZE
+#endif
+#endif
+
+// grids ahead of the vehicle are only prefetched with a cache of at
+// least this size, as smaller caches would thrash
+#define TERRAIN_PREFETCH_MIN_CACHE 24
+
+// seconds of flight along the velocity vector to prefetch grids for
+#define TERRAIN_PREFETCH_TIME_S 60
+
+// on Linux the degree files are memory mapped, so io_timer() copies a
+// batch of grid blocks from the page cache for each disk read
+#ifndef AP_TERRAIN_MMAP_ENABLED
+#define AP_TERRAIN_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// number of degree files kept mapped
+#define TERRAIN_MMAP_FILES 4
+
+// blocks copied from a mapped file along with each disk read
+#define TERRAIN_MMAP_BATCH 8
+
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
@@ -126,6 +157,40 @@ public:
      */
     bool height_amsl(const Location &loc, float &height, bool corrected);
 
+    /*
+      find the terrain heights in meters above sea level for an array
+      of locations, and optionally the terrain slope at each as the
+      rise per meter north and east. Heights are not corrected for
+      home. The grid lookup is shared between consecutive locations in
+      the same grid block, so this is much cheaper than calling
+      height_amsl() for each point along a path.
+
+      Only grid blocks already in the cache are used. Unlike
+      height_amsl() a missing block is not loaded, so the blocks
+      around the vehicle are never evicted for a query elsewhere.
+
+      valid[i] is false where terrain data is not available. Returns
+      the number of locations with terrain data
+     */
+    uint16_t height_amsl_batch(const Location *locs, uint16_t count,
+                               float *heights, bool *valid, Vector2f *slopes = nullptr);
+
+    /*
+      sample terrain heights above sea level every spacing meters
+      along a polyline, starting at path[0] and ending at the last
+      vertex, and optionally the slope along the path in rise per
+      meter. At most max_samples samples are taken, with num_samples
+      set to the number taken.
+
+      Like height_amsl_batch() only cached grid blocks are used.
+
+      return false if the samples do not reach the end of the path or
+      terrain data is missing for any of them
+     */
+    bool height_profile(const Location *path, uint16_t path_len, float spacing,
+                        float *heights, float *slopes, uint16_t max_samples,
+                        uint16_t &num_samples);
+
     /* 
        find difference between home terrain height and the terrain
        height at the current location in meters. A positive result
@@ -255,6 +320,13 @@ private:
 
         // the last time access was requested to this block, used for LRU
         uint32_t last_access_ms;
+
+        // grid_lat, grid_lon and spacing this entry was set up for,
+        // used as the cache_hash key. Unlike grid these are not
+        // changed by a disk read
+        int32_t key_lat;
+        int32_t key_lon;
+        uint16_t key_spacing;
     };
 
     /*
@@ -288,11 +360,39 @@ private:
 
     // given a location, fill a grid_info structure
     void calculate_grid_info(const Location &loc, struct grid_info &info) const;
+    void calculate_grid_idx(const Location &loc, struct grid_info &info) const;
+    void calculate_grid_corner(struct grid_info &info) const;
+
+    /*
+      interpolate the height and optionally slope at a location in a
+      grid block
+     */
+    bool interpolate_height(const struct grid_block &grid, const struct grid_info &info,
+                            float &height, Vector2f *slope);
+
+    /*
+      state shared between the lookups of a batch height query, so
+      consecutive locations in one grid block skip the cache search.
+      gcache is nullptr when the block of the last search isn't cached
+     */
+    struct batch_lookup {
+        bool load_missing;
+        bool searched;
+        const struct grid_cache *gcache;
+        int8_t lat_degrees;
+        int16_t lon_degrees;
+        uint16_t grid_idx_x;
+        uint16_t grid_idx_y;
+    };
+    bool batch_height(const Location &loc, struct batch_lookup &state,
+                      float &height, Vector2f *slope);
 
     /*
       find a grid structure given a grid_info
     */
     struct grid_cache &find_grid_cache(const struct grid_info &info);
+    int16_t find_cache_idx(int32_t grid_lat, int32_t grid_lon, uint16_t spacing) const;
+    void rebuild_cache_hash(void);
 
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
@@ -335,6 +435,18 @@ private:
     uint32_t east_blocks(struct grid_block &block) const;
     void write_block(void);
     void read_block(void);
+    bool disk_block_valid(struct grid_block &block, int32_t lat, int32_t lon);
+
+#if AP_TERRAIN_MMAP_ENABLED
+    /*
+      memory mapped access to degree files
+     */
+    void mmap_file(void);
+    void queue_mmap_batch(uint16_t first_idx);
+    void read_mmap_batch(void);
+    void apply_mmap_batch(void);
+    bool mmap_read(struct grid_block &grid);
+#endif
 
     /*
       check for missing mission terrain data
@@ -346,6 +458,12 @@ private:
      */
     void update_rally_data(void);
 
+    /*
+      load grids ahead of the vehicle
+     */
+    void update_prefetch(void);
+    void prefetch_leg(const Location &from, const Location &to, uint8_t &budget);
+
 
     // parameters
     AP_Int8  enable;
@@ -364,6 +482,13 @@ private:
     uint8_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
+    // open addressing hash of cache slots by grid, 0xFF when empty
+    uint8_t *cache_hash = nullptr;
+    uint16_t cache_hash_size;
+
+    // last time grids ahead of the vehicle were prefetched
+    uint32_t last_prefetch_ms;
+
     // a grid_cache block waiting for disk IO
     enum DiskIoState {
         DiskIoIdle      = 0,
@@ -430,6 +555,24 @@ private:
 
     char *file_path = nullptr;
 
+#if AP_TERRAIN_MMAP_ENABLED
+    // degree files mapped read-only, whole blocks only. Only used by
+    // the IO thread
+    struct mapped_file {
+        const uint8_t *base;
+        uint32_t length;
+        int8_t lat_degrees;
+        int16_t lon_degrees;
+        uint32_t last_use_ms;
+    } mapped_files[TERRAIN_MMAP_FILES];
+
+    // blocks read from the mapped file along with disk_block, owned
+    // like disk_block through disk_io_state
+    union grid_io_block mmap_batch[TERRAIN_MMAP_BATCH];
+    bool mmap_batch_read[TERRAIN_MMAP_BATCH];
+    uint8_t mmap_batch_count;
+#endif
+
     // status
     enum TerrainStatus system_status = TerrainStatusDisabled;
 
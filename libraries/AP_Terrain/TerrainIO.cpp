@@ -38,6 +38,9 @@ void AP_Terrain::check_disk_read(void)
     for (uint16_t i=0; i<cache_size; i++) {
         if (cache[i].state == GRID_CACHE_DISKWAIT) {
             disk_block.block = cache[i].grid;
+#if AP_TERRAIN_MMAP_ENABLED
+            queue_mmap_batch(i);
+#endif
             disk_io_state = DiskIoWaitRead;
             return;
         }
@@ -93,6 +96,10 @@ void AP_Terrain::schedule_disk_io(void)
             cache[cache_idx].state = GRID_CACHE_VALID;
             cache[cache_idx].last_access_ms = AP_HAL::millis();
         }
+#if AP_TERRAIN_MMAP_ENABLED
+        // and the blocks copied from the mapped file with it
+        apply_mmap_batch();
+#endif
         disk_io_state = DiskIoIdle;
         break;
     }
@@ -300,12 +307,7 @@ void AP_Terrain::read_block(void)
 
     ssize_t ret = AP::FS().read(fd, &disk_block, sizeof(disk_block));
     if (ret != sizeof(disk_block) || 
-        !TERRAIN_LATLON_EQUAL(disk_block.block.lat,lat) ||
-        !TERRAIN_LATLON_EQUAL(disk_block.block.lon,lon) ||
-        disk_block.block.bitmap == 0 ||
-        disk_block.block.spacing != grid_spacing ||
-        disk_block.block.version != TERRAIN_GRID_FORMAT_VERSION ||
-        disk_block.block.crc != get_block_crc(disk_block.block)) {
+        !disk_block_valid(disk_block.block, lat, lon)) {
 #if TERRAIN_DEBUG
         printf("read empty block at %ld %ld ret=%d (%ld %ld %u 0x%08lx) 0x%04x:0x%04x\n",
                (long)lat,
@@ -336,6 +338,19 @@ void AP_Terrain::read_block(void)
     disk_io_state = DiskIoDoneRead;
 }
 
+/*
+  check a block read from disk is the one we asked for, and is intact
+ */
+bool AP_Terrain::disk_block_valid(struct grid_block &block, int32_t lat, int32_t lon)
+{
+    return TERRAIN_LATLON_EQUAL(block.lat,lat) &&
+        TERRAIN_LATLON_EQUAL(block.lon,lon) &&
+        block.bitmap != 0 &&
+        block.spacing == grid_spacing &&
+        block.version == TERRAIN_GRID_FORMAT_VERSION &&
+        block.crc == get_block_crc(block);
+}
+
 /*
   timer called to do disk IO
  */
@@ -364,6 +379,10 @@ void AP_Terrain::io_timer(void)
         if (fd == -1) {
             return;
         }
+#if AP_TERRAIN_MMAP_ENABLED
+        // map the file, or remap it if earlier writes grew it
+        mmap_file();
+#endif
         write_block();
         break;
 
@@ -373,6 +392,14 @@ void AP_Terrain::io_timer(void)
         if (fd == -1) {
             return;
         }
+#if AP_TERRAIN_MMAP_ENABLED
+        mmap_file();
+        read_mmap_batch();
+        if (mmap_read(disk_block.block)) {
+            disk_io_state = DiskIoDoneRead;
+            break;
+        }
+#endif
         read_block();
         break;
     }
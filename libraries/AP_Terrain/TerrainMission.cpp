@@ -24,6 +24,7 @@
 #include <GCS_MAVLink/GCS.h>
 #include "AP_Terrain.h"
 #include <AP_GPS/AP_GPS.h>
+#include <AP_AHRS/AP_AHRS.h>
 
 #if AP_TERRAIN_AVAILABLE
 
@@ -164,4 +165,105 @@ void AP_Terrain::update_rally_data(void)
     }
 }
 
+/*
+  touch the grids ahead of the vehicle, along the velocity vector and
+  the next mission legs, so they are read from disk or requested from
+  the GCS before they are needed
+ */
+void AP_Terrain::update_prefetch(void)
+{
+    if (cache_size < TERRAIN_PREFETCH_MIN_CACHE) {
+        // the cache is only big enough for the grids around us
+        return;
+    }
+    const uint32_t now = AP_HAL::millis();
+    if (now - last_prefetch_ms < 1000) {
+        return;
+    }
+    last_prefetch_ms = now;
+
+    const AP_AHRS &ahrs = AP::ahrs();
+    Location loc;
+    if (!ahrs.get_position(loc)) {
+        return;
+    }
+
+    // leave most of the cache for the current location, home and
+    // the mission and rally checks
+    uint8_t budget = cache_size / 3;
+
+    Vector3f vel;
+    if (ahrs.get_velocity_NED(vel)) {
+        const Vector2f vel_ne{vel.x, vel.y};
+        if (vel_ne.length() > 1) {
+            Location ahead = loc;
+            ahead.offset(vel.x * TERRAIN_PREFETCH_TIME_S, vel.y * TERRAIN_PREFETCH_TIME_S);
+            prefetch_leg(loc, ahead, budget);
+        }
+    }
+
+    if (mission.state() != AP_Mission::MISSION_RUNNING) {
+        return;
+    }
+
+    // the leg we are flying and the one after it. Don't look at more
+    // than 20 commands at a time, to prevent too much CPU usage
+    Location from = loc;
+    uint16_t index = mission.get_current_nav_index();
+    uint8_t legs = 0;
+    for (uint8_t i=0; i<20 && index != 0 && legs < 2 && budget > 0; i++, index++) {
+        AP_Mission::Mission_Command cmd;
+        if (!mission.read_cmd_from_storage(index, cmd)) {
+            break;
+        }
+        if (!AP_Mission::is_nav_cmd(cmd) ||
+            (cmd.content.location.lat == 0 && cmd.content.location.lng == 0)) {
+            continue;
+        }
+        prefetch_leg(from, cmd.content.location, budget);
+        from = cmd.content.location;
+        legs++;
+    }
+}
+
+/*
+  touch the grids along a line, nearest first, using at most budget
+  new grid lookups
+ */
+void AP_Terrain::prefetch_leg(const Location &from, const Location &to, uint8_t &budget)
+{
+    const Vector2f ofs = from.get_distance_NE(to);
+    const float length = ofs.length();
+    if (length < 1) {
+        return;
+    }
+
+    // half a grid block, so no block along the line is skipped
+    const float step = 0.5 * MIN(TERRAIN_GRID_BLOCK_SPACING_X, TERRAIN_GRID_BLOCK_SPACING_Y) * grid_spacing;
+    if (step <= 0) {
+        return;
+    }
+
+    int32_t last_lat = 0, last_lon = 0;
+    for (float d = step; budget > 0; d += step) {
+        d = MIN(d, length);
+        Location p = from;
+        p.offset(ofs.x * d / length, ofs.y * d / length);
+
+        struct grid_info info;
+        calculate_grid_info(p, info);
+        if (info.grid_lat != last_lat || info.grid_lon != last_lon) {
+            // a new grid is marked for disk read, after which
+            // send_cache_request() asks the GCS for any missing data
+            find_grid_cache(info);
+            last_lat = info.grid_lat;
+            last_lon = info.grid_lon;
+            budget--;
+        }
+        if (d >= length) {
+            break;
+        }
+    }
+}
+
 #endif // AP_TERRAIN_AVAILABLE
@@ -0,0 +1,211 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  memory mapped access to the terrain degree files on Linux. Blocks
+  already on disk, for example from a bulk import with
+  tools/create_terrain.py, are copied from the mapped file by the IO
+  thread, a batch of them per disk read, rather than one block per
+  io_timer() tick
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include "AP_Terrain.h"
+
+#if AP_TERRAIN_AVAILABLE && AP_TERRAIN_MMAP_ENABLED
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  map the degree file of disk_block, or remap it if its size has
+  changed. The file is stat'ed on every call, so a file truncated by
+  another process is shrunk or unmapped before we copy from it rather
+  than faulting on pages past its end. Called from the IO thread after
+  open_file()
+ */
+void AP_Terrain::mmap_file(void)
+{
+    const struct grid_block &block = disk_block.block;
+
+    // reuse the entry for this file, or the least recently used one
+    uint8_t idx = 0;
+    bool found = false;
+    for (uint8_t i=0; i<TERRAIN_MMAP_FILES; i++) {
+        const struct mapped_file &m = mapped_files[i];
+        if (m.base != nullptr &&
+            m.lat_degrees == block.lat_degrees &&
+            m.lon_degrees == block.lon_degrees) {
+            idx = i;
+            found = true;
+            break;
+        }
+        if (m.last_use_ms < mapped_files[idx].last_use_ms) {
+            idx = i;
+        }
+    }
+    struct mapped_file &m = mapped_files[idx];
+
+    struct stat st;
+    uint32_t length = 0;
+    if (::stat(file_path, &st) == 0) {
+        // whole blocks only
+        length = MIN(uint64_t(st.st_size), uint64_t(UINT32_MAX)) & ~uint32_t(sizeof(union grid_io_block)-1);
+    }
+    if (found && m.length == length) {
+        // already mapped
+        return;
+    }
+    if (found || length != 0) {
+        // drop the old mapping, which may now extend past the end of
+        // the file
+        if (m.base != nullptr) {
+            ::munmap((void *)m.base, m.length);
+        }
+        m.base = nullptr;
+        m.length = 0;
+    }
+    if (length == 0) {
+        return;
+    }
+
+    const int mfd = ::open(file_path, O_RDONLY|O_CLOEXEC);
+    if (mfd == -1) {
+        return;
+    }
+    void *base = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, mfd, 0);
+    // the mapping holds its own reference to the file
+    ::close(mfd);
+    if (base == MAP_FAILED) {
+        return;
+    }
+    // ask the kernel to start reading the file in now, so later
+    // copies rarely wait on a page fault
+    ::madvise(base, length, MADV_WILLNEED);
+
+    m.base = (const uint8_t *)base;
+    m.length = length;
+    m.lat_degrees = block.lat_degrees;
+    m.lon_degrees = block.lon_degrees;
+    m.last_use_ms = AP_HAL::millis();
+}
+
+/*
+  queue the other blocks of the degree file of disk_block that are
+  waiting for a disk read, so the IO thread can copy them from the
+  mapped file along with disk_block. Called from the main thread before
+  handing disk_block to the IO thread
+ */
+void AP_Terrain::queue_mmap_batch(uint16_t first_idx)
+{
+    const struct grid_block &block = disk_block.block;
+    mmap_batch_count = 0;
+    for (uint16_t i=first_idx+1; i<cache_size && mmap_batch_count<TERRAIN_MMAP_BATCH; i++) {
+        const struct grid_block &grid = cache[i].grid;
+        if (cache[i].state == GRID_CACHE_DISKWAIT &&
+            grid.lat_degrees == block.lat_degrees &&
+            grid.lon_degrees == block.lon_degrees) {
+            mmap_batch[mmap_batch_count].block = grid;
+            mmap_batch_read[mmap_batch_count] = false;
+            mmap_batch_count++;
+        }
+    }
+}
+
+/*
+  copy the queued batch from the mapped file. Blocks that are not in
+  the mapping stay waiting for a normal disk read. Called from the IO
+  thread
+ */
+void AP_Terrain::read_mmap_batch(void)
+{
+    for (uint8_t i=0; i<mmap_batch_count; i++) {
+        mmap_batch_read[i] = mmap_read(mmap_batch[i].block);
+    }
+}
+
+/*
+  give the blocks copied by read_mmap_batch() to the cache entries
+  waiting for them. Called from the main thread on DiskIoDoneRead
+ */
+void AP_Terrain::apply_mmap_batch(void)
+{
+    for (uint8_t i=0; i<mmap_batch_count; i++) {
+        if (!mmap_batch_read[i]) {
+            continue;
+        }
+        const struct grid_block &block = mmap_batch[i].block;
+        for (uint16_t j=0; j<cache_size; j++) {
+            struct grid_cache &gcache = cache[j];
+            if (gcache.state == GRID_CACHE_DISKWAIT &&
+                TERRAIN_LATLON_EQUAL(block.lat, gcache.grid.lat) &&
+                TERRAIN_LATLON_EQUAL(block.lon, gcache.grid.lon)) {
+                if (block.bitmap != 0) {
+                    // when bitmap is zero we read an empty block
+                    gcache.grid = block;
+                }
+                gcache.state = GRID_CACHE_VALID;
+                gcache.last_access_ms = AP_HAL::millis();
+                break;
+            }
+        }
+    }
+    mmap_batch_count = 0;
+}
+
+/*
+  fill a block from a mapped file, with the same result as
+  read_block(). Returns false if the block is not in a mapped file.
+  Called from the IO thread after mmap_file()
+ */
+bool AP_Terrain::mmap_read(struct grid_block &grid)
+{
+    for (uint8_t i=0; i<TERRAIN_MMAP_FILES; i++) {
+        struct mapped_file &m = mapped_files[i];
+        if (m.base == nullptr ||
+            m.lat_degrees != grid.lat_degrees ||
+            m.lon_degrees != grid.lon_degrees) {
+            continue;
+        }
+        const uint32_t blocknum = east_blocks(grid) * grid.grid_idx_x + grid.grid_idx_y;
+        const uint32_t file_offset = blocknum * sizeof(union grid_io_block);
+        if (file_offset >= m.length) {
+            // past the mapped end, read_block() decides
+            return false;
+        }
+        m.last_use_ms = AP_HAL::millis();
+
+        const int32_t lat = grid.lat;
+        const int32_t lon = grid.lon;
+        memcpy(&grid, &m.base[file_offset], sizeof(grid));
+        if (!disk_block_valid(grid, lat, lon)) {
+            // as for a disk read, an invalid block gives an empty grid
+            // to be filled from the GCS
+            memset(&grid, 0, sizeof(grid));
+            grid.lat = lat;
+            grid.lon = lon;
+            grid.bitmap = 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+#endif // AP_TERRAIN_AVAILABLE && AP_TERRAIN_MMAP_ENABLED
@@ -59,6 +59,16 @@ bool AP_Terrain::check_bitmap(const struct grid_block &grid, uint8_t idx_x, uint
   grid indices
 */
 void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info) const
+{
+    calculate_grid_idx(loc, info);
+    calculate_grid_corner(info);
+}
+
+/*
+  fill in the grid_info indexes for a location, without the block
+  corner
+ */
+void AP_Terrain::calculate_grid_idx(const Location &loc, struct grid_info &info) const
 {
     // grids start on integer degrees. This makes storing terrain data
     // on the SD card a bit easier
@@ -91,34 +101,41 @@ void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info
     info.frac_x = (offset.x - idx_x * grid_spacing) / grid_spacing;
     info.frac_y = (offset.y - idx_y * grid_spacing) / grid_spacing;
 
-    // calculate lat/lon of SW corner of 32*28 grid_block
-    ref.offset(info.grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * (float)grid_spacing,
-               info.grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y * (float)grid_spacing);
-    info.grid_lat = ref.lat;
-    info.grid_lon = ref.lng;
-
     ASSERT_RANGE(info.idx_x,0,TERRAIN_GRID_BLOCK_SPACING_X-1);
     ASSERT_RANGE(info.idx_y,0,TERRAIN_GRID_BLOCK_SPACING_Y-1);
     ASSERT_RANGE(info.frac_x,0,1);
     ASSERT_RANGE(info.frac_y,0,1);
 }
 
+/*
+  calculate lat/lon of SW corner of the 32*28 grid_block of a grid_info
+ */
+void AP_Terrain::calculate_grid_corner(struct grid_info &info) const
+{
+    Location ref;
+    ref.lat = info.lat_degrees*10*1000*1000L;
+    ref.lng = info.lon_degrees*10*1000*1000L;
+    ref.offset(info.grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * (float)grid_spacing,
+               info.grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y * (float)grid_spacing);
+    info.grid_lat = ref.lat;
+    info.grid_lon = ref.lng;
+}
+
 
 /*
   find a grid structure given a grid_info
  */
 AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
 {
-    uint16_t oldest_i = 0;
-
     // see if we have that grid
-    for (uint16_t i=0; i<cache_size; i++) {
-        if (TERRAIN_LATLON_EQUAL(cache[i].grid.lat,info.grid_lat) &&
-            TERRAIN_LATLON_EQUAL(cache[i].grid.lon,info.grid_lon) &&
-            cache[i].grid.spacing == grid_spacing) {
-            cache[i].last_access_ms = AP_HAL::millis();
-            return cache[i];
-        }
+    const int16_t idx = find_cache_idx(info.grid_lat, info.grid_lon, grid_spacing);
+    if (idx != -1) {
+        cache[idx].last_access_ms = AP_HAL::millis();
+        return cache[idx];
+    }
+
+    uint16_t oldest_i = 0;
+    for (uint16_t i=1; i<cache_size; i++) {
         if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
             oldest_i = i;
         }
@@ -138,13 +155,77 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     grid.grid.lon_degrees = info.lon_degrees;
     grid.grid.version = TERRAIN_GRID_FORMAT_VERSION;
     grid.last_access_ms = AP_HAL::millis();
+    grid.key_lat = info.grid_lat;
+    grid.key_lon = info.grid_lon;
+    grid.key_spacing = grid_spacing;
 
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
 
+    // a slot changed its key, evictions are rare enough to rebuild
+    rebuild_cache_hash();
+
     return grid;
 }
 
+/*
+  hash a grid key into cache_hash
+ */
+static inline uint16_t cache_hash_start(int32_t grid_lat, int32_t grid_lon, uint16_t spacing, uint16_t hash_size)
+{
+    uint32_t h = (uint32_t(grid_lat) * 0x9E3779B1U) ^ (uint32_t(grid_lon) * 0x85EBCA77U) ^ spacing;
+    h ^= h >> 16;
+    return h & (hash_size - 1);
+}
+
+/*
+  find the cache slot set up for a grid, or -1
+ */
+int16_t AP_Terrain::find_cache_idx(int32_t grid_lat, int32_t grid_lon, uint16_t spacing) const
+{
+    if (cache_hash == nullptr) {
+        for (uint16_t i=0; i<cache_size; i++) {
+            const struct grid_cache &c = cache[i];
+            if (c.key_spacing == spacing && c.key_lat == grid_lat && c.key_lon == grid_lon) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    uint16_t h = cache_hash_start(grid_lat, grid_lon, spacing, cache_hash_size);
+    while (cache_hash[h] != 0xFF) {
+        const struct grid_cache &c = cache[cache_hash[h]];
+        if (c.key_spacing == spacing && c.key_lat == grid_lat && c.key_lon == grid_lon) {
+            return cache_hash[h];
+        }
+        h = (h + 1) & (cache_hash_size - 1);
+    }
+    return -1;
+}
+
+/*
+  rebuild cache_hash from the slot keys
+ */
+void AP_Terrain::rebuild_cache_hash(void)
+{
+    if (cache_hash == nullptr) {
+        return;
+    }
+    memset(cache_hash, 0xFF, cache_hash_size);
+    for (uint16_t i=0; i<cache_size; i++) {
+        const struct grid_cache &c = cache[i];
+        if (c.key_spacing == 0) {
+            // never used
+            continue;
+        }
+        uint16_t h = cache_hash_start(c.key_lat, c.key_lon, c.key_spacing, cache_hash_size);
+        while (cache_hash[h] != 0xFF) {
+            h = (h + 1) & (cache_hash_size - 1);
+        }
+        cache_hash[h] = i;
+    }
+}
+
 /*
   find cache index of disk_block
  */
@@ -3,10 +3,15 @@
 create ardupilot terrain database files
 '''
 
-from MAVProxy.modules.mavproxy_map import srtm
-import math, struct, os, sys
+import math, struct, os, sys, array
 import crc16, time, struct
 
+try:
+    from MAVProxy.modules.mavproxy_map import srtm
+except ImportError:
+    # only needed when downloading, not with --dem-dir
+    srtm = None
+
 # avoid annoying crc16 DeprecationWarning
 import warnings
 warnings.filterwarnings("ignore", category=DeprecationWarning)
@@ -166,6 +171,63 @@ class GridBlock(object):
         stride = east_blocks(self.lat_degrees*1e7, self.lon_degrees*1e7)
         return stride * self.grid_idx_x + self.grid_idx_y
 
+class DEMOceanTile(object):
+    '''a DEM tile missing from the DEM directory, taken as sea level'''
+    def getAltitudeFromLatLon(self, lat, lon):
+        return 0
+
+class DEMTile(object):
+    '''a one degree SRTM .hgt DEM tile. These are square grids of big
+    endian int16 heights in meters, rows running north to south, with
+    the edges shared with the neighbouring tiles'''
+    def __init__(self, filename, lat_int, lon_int):
+        self.lat_int = lat_int
+        self.lon_int = lon_int
+        self.heights = array.array('h')
+        with open(filename, 'rb') as f:
+            self.heights.frombytes(f.read())
+        if sys.byteorder == 'little':
+            self.heights.byteswap()
+        self.size = int(math.sqrt(len(self.heights)))
+        if self.size * self.size != len(self.heights) or self.size < 2:
+            raise ValueError("bad DEM tile size in %s" % filename)
+
+    def height(self, row, col):
+        '''height at a row and column, with voids taken as sea level'''
+        h = self.heights[row*self.size + col]
+        if h == -32768:
+            return 0
+        return h
+
+    def getAltitudeFromLatLon(self, lat, lon):
+        '''bilinear interpolated height for a position within the tile'''
+        x = (lon - self.lon_int) * (self.size - 1)
+        y = (self.lat_int + 1 - lat) * (self.size - 1)
+        col = min(max(int(x), 0), self.size - 2)
+        row = min(max(int(y), 0), self.size - 2)
+        fx = min(max(x - col, 0.0), 1.0)
+        fy = min(max(y - row, 0.0), 1.0)
+        return (self.height(row, col) * (1-fx) * (1-fy) +
+                self.height(row, col+1) * fx * (1-fy) +
+                self.height(row+1, col) * (1-fx) * fy +
+                self.height(row+1, col+1) * fx * fy)
+
+class DEMDirectory(object):
+    '''source of DEM tiles from a local directory of SRTM .hgt files
+    named like N47E008.hgt, for creating terrain files offline'''
+    def __init__(self, directory):
+        self.directory = directory
+
+    def getTile(self, lat_int, lon_int):
+        name = "%c%02u%c%03u" % ('S' if lat_int < 0 else 'N', abs(lat_int),
+                                 'W' if lon_int < 0 else 'E', abs(lon_int))
+        for fname in [name + ".hgt", name.lower() + ".hgt", name + ".HGT"]:
+            path = os.path.join(self.directory, fname)
+            if os.path.exists(path):
+                return DEMTile(path, lat_int, lon_int)
+        print("No DEM tile %s, using sea level" % name)
+        return DEMOceanTile()
+
 class TerrainError:
     '''represent errors from testing a degree file'''
     def __init__(self):
@@ -399,7 +461,8 @@ def create_degree(lat, lon):
                     if waited:
                         print("downloaded %d,%d" % (lat2_int, lon2_int))
                     tiles[tile_idx] = tile
-                if isinstance(tile, srtm.SRTMOceanTile):
+                tile = tiles[tile_idx]
+                if isinstance(tile, DEMOceanTile) or (srtm is not None and isinstance(tile, srtm.SRTMOceanTile)):
                      # shortcut ocean tile creation
                      break
                 altitude = tiles[tile_idx].getAltitudeFromLatLon(lat_e7*1.0e-7, lon_e7*1.0e-7)
@@ -492,14 +555,21 @@ parser.add_argument("--pos-range", default=None, help="show position range for a
 parser.add_argument("--test", action='store_true', help="test altitudes instead of writing them")
 parser.add_argument("--test-threshold", default=2.0, type=float, help="test altitude threshold")
 parser.add_argument("--directory", default="terrain", help="directory to use")
+parser.add_argument("--dem-dir", default=None, help="create from local SRTM .hgt DEM tiles in this directory instead of downloading")
 args = parser.parse_args()
 
 if args.pos_range is not None:
     print(pos_range(args.pos_range))
     sys.exit(0)
 
-downloader = srtm.SRTMDownloader(debug=args.debug)
-downloader.loadFileList()
+if args.dem_dir is not None:
+    downloader = DEMDirectory(args.dem_dir)
+elif srtm is None:
+    print("MAVProxy is needed to download terrain, or use --dem-dir")
+    sys.exit(1)
+else:
+    downloader = srtm.SRTMDownloader(debug=args.debug)
+    downloader.loadFileList()
 
 GRID_SPACING = args.spacing
 
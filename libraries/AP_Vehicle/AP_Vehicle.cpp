@@ -332,8 +332,9 @@ void AP_Vehicle::reboot(bool hold_in_bootloader)
     // force safety on
     hal.rcout->force_safety_on();
 
-    // flush pending parameter writes
+    // flush pending parameter writes, and start writing back storage
     AP_Param::flush();
+    hal.storage->flush();
 
     // do not process incoming mavlink messages while we delay:
     hal.scheduler->register_delay_callback(nullptr, 5);
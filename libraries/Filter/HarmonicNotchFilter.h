@@ -29,7 +29,6 @@
 template <class T>
 class HarmonicNotchFilter {
 public:
-    ~HarmonicNotchFilter();
     // allocate a bank of notch filters for this harmonic notch filter
     void allocate_filters(uint8_t harmonics, bool double_notch);
     // initialize the underlying filters using the provided filter parameters
@@ -44,8 +43,8 @@ public:
     void reset();
 
 private:
-    // underlying bank of notch filters
-    NotchFilter<T>*  _filters;
+    // underlying bank of notch filters, one signal per element of T
+    NotchFilterCascade _filters;
     // sample frequency for each filter
     float _sample_freq_hz;
     // base double notch bandwidth for each filter
@@ -29,6 +29,25 @@ void NotchFilter<T>::calculate_A_and_Q(float center_freq_hz, float bandwidth_hz,
     }
 }
 
+/*
+  calculate the biquad coefficients of a notch
+ */
+bool NotchFilterCoeffs::calculate(float sample_freq_hz, float center_freq_hz, float A, float Q)
+{
+    if ((center_freq_hz > 0.0) && (center_freq_hz < 0.5 * sample_freq_hz) && (Q > 0.0)) {
+        float omega = 2.0 * M_PI * center_freq_hz / sample_freq_hz;
+        float alpha = sinf(omega) / (2 * Q);
+        const float a0_inv =  1.0/(1.0 + alpha);
+        b0 = (1.0 + alpha*sq(A)) * a0_inv;
+        b1 = (-2.0 * cosf(omega)) * a0_inv;
+        b2 = (1.0 - alpha*sq(A)) * a0_inv;
+        a1 = b1;
+        a2 = (1.0 - alpha) * a0_inv;
+        return true;
+    }
+    return false;
+}
+
 /*
   initialise filter
  */
@@ -48,51 +67,56 @@ void NotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float band
 template <class T>
 void NotchFilter<T>::init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q)
 {
-    if ((center_freq_hz > 0.0) && (center_freq_hz < 0.5 * sample_freq_hz) && (Q > 0.0)) {
-        float omega = 2.0 * M_PI * center_freq_hz / sample_freq_hz;
-        float alpha = sinf(omega) / (2 * Q);
-        b0 =  1.0 + alpha*sq(A);
-        b1 = -2.0 * cosf(omega);
-        b2 =  1.0 - alpha*sq(A);
-        a0_inv =  1.0/(1.0 + alpha);
-        a1 = b1;
-        a2 =  1.0 - alpha;
-        initialised = true;
-    } else {
-        initialised = false;
-    }
+    initialised = c.calculate(sample_freq_hz, center_freq_hz, A, Q);
 }
 
-/*
-  apply a new input sample, returning new output
- */
 template <class T>
-T NotchFilter<T>::apply(const T &sample)
+void NotchFilter<T>::reset()
+{
+    ntchsig2 = ntchsig1 = T();
+    signal2 = signal1 = T();
+}
+
+NotchFilterCascade::~NotchFilterCascade()
 {
-    if (!initialised) {
-        // if we have not been initialised when return the input
-        // sample as output and update delayed samples
-        ntchsig2 = ntchsig1;
-        ntchsig1 = ntchsig;
-        ntchsig = sample;
-        signal2 = signal1;
-        signal1 = sample;
-        return sample;
+    delete[] _stages;
+}
+
+bool NotchFilterCascade::allocate(uint8_t num_stages)
+{
+    delete[] _stages;
+    _num_stages = 0;
+    _stages = new Stage[num_stages];
+    if (_stages == nullptr) {
+        return false;
     }
-    ntchsig2 = ntchsig1;
-    ntchsig1 = ntchsig;
-    ntchsig = sample;
-    T output = (ntchsig*b0 + ntchsig1*b1 + ntchsig2*b2 - signal1*a1 - signal2*a2) * a0_inv;
-    signal2 = signal1;
-    signal1 = output;
-    return output;
+    _num_stages = num_stages;
+    return true;
 }
 
-template <class T>
-void NotchFilter<T>::reset()
+void NotchFilterCascade::init_with_A_and_Q(uint8_t stage, float sample_freq_hz, float center_freq_hz, float A, float Q)
 {
-    ntchsig2 = ntchsig1 = T();
-    signal2 = signal1 = T();
+    if (stage >= _num_stages) {
+        return;
+    }
+    NotchFilterCoeffs &c = _stages[stage].c;
+    if (!c.calculate(sample_freq_hz, center_freq_hz, A, Q)) {
+        // this gives the same output and delayed samples as an
+        // uninitialised NotchFilter
+        c.b0 = 1;
+        c.b1 = c.b2 = c.a1 = c.a2 = 0;
+    }
+}
+
+void NotchFilterCascade::reset()
+{
+    for (uint8_t s = 0; s < _num_stages; s++) {
+        Stage &st = _stages[s];
+        for (uint8_t i = 0; i < NOTCH_CASCADE_LANES; i++) {
+            st.ntchsig1[i] = st.ntchsig2[i] = 0;
+            st.signal1[i] = st.signal2[i] = 0;
+        }
+    }
 }
 
 // table of user settable parameters
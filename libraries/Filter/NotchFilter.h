@@ -25,6 +25,16 @@
 #include <inttypes.h>
 #include <AP_Param/AP_Param.h>
 
+/*
+  biquad coefficients of a notch filter, normalised by a0
+ */
+struct NotchFilterCoeffs {
+    float b0, b1, b2, a1, a2;
+
+    // calculate the coefficients, returning false if the notch is
+    // out of range
+    bool calculate(float sample_freq_hz, float center_freq_hz, float A, float Q);
+};
 
 template <class T>
 class NotchFilter {
@@ -32,7 +42,25 @@ public:
     // set parameters
     void init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
     void init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q);
-    T apply(const T &sample);
+    // apply a new input sample, returning new output. This is inline
+    // so that the harmonic notch cascade compiles to a single loop
+    T apply(const T &sample) {
+        if (!initialised) {
+            // if we have not been initialised when return the input
+            // sample as output and update delayed samples
+            ntchsig2 = ntchsig1;
+            ntchsig1 = sample;
+            signal2 = signal1;
+            signal1 = sample;
+            return sample;
+        }
+        const T output = sample*c.b0 + ntchsig1*c.b1 + ntchsig2*c.b2 - signal1*c.a1 - signal2*c.a2;
+        ntchsig2 = ntchsig1;
+        ntchsig1 = sample;
+        signal2 = signal1;
+        signal1 = output;
+        return output;
+    }
     void reset();
 
     // calculate attenuation and quality from provided center frequency and bandwidth
@@ -41,8 +69,53 @@ public:
 private:
 
     bool initialised;
-    float b0, b1, b2, a1, a2, a0_inv;
-    T ntchsig, ntchsig1, ntchsig2, signal2, signal1;
+    NotchFilterCoeffs c;
+    T ntchsig1, ntchsig2, signal2, signal1;
+};
+
+#define NOTCH_CASCADE_LANES 4
+
+/*
+  a cascade of notch filters applied to up to NOTCH_CASCADE_LANES
+  signals at once. The state of each stage is held as arrays across
+  the signals, so a stage runs as one vector operation
+ */
+class NotchFilterCascade {
+public:
+    ~NotchFilterCascade();
+    // allocate the stages, returning false on failure
+    bool allocate(uint8_t num_stages);
+    uint8_t num_stages(void) const { return _num_stages; }
+    // set the notch of a stage. A stage that is out of range passes
+    // its input through
+    void init_with_A_and_Q(uint8_t stage, float sample_freq_hz, float center_freq_hz, float A, float Q);
+    // apply the first num_stages stages in turn to one sample of
+    // each signal, replacing the samples with the outputs
+    void apply(float sample[NOTCH_CASCADE_LANES], uint8_t num_stages) {
+        for (uint8_t s = 0; s < num_stages; s++) {
+            Stage &st = _stages[s];
+            for (uint8_t i = 0; i < NOTCH_CASCADE_LANES; i++) {
+                const float output = sample[i]*st.c.b0 + st.ntchsig1[i]*st.c.b1 + st.ntchsig2[i]*st.c.b2 - st.signal1[i]*st.c.a1 - st.signal2[i]*st.c.a2;
+                st.ntchsig2[i] = st.ntchsig1[i];
+                st.ntchsig1[i] = sample[i];
+                st.signal2[i] = st.signal1[i];
+                st.signal1[i] = output;
+                sample[i] = output;
+            }
+        }
+    }
+    void reset();
+
+private:
+    struct Stage {
+        float ntchsig1[NOTCH_CASCADE_LANES];
+        float ntchsig2[NOTCH_CASCADE_LANES];
+        float signal1[NOTCH_CASCADE_LANES];
+        float signal2[NOTCH_CASCADE_LANES];
+        NotchFilterCoeffs c;
+    };
+    Stage *_stages;
+    uint8_t _num_stages;
 };
 
 /*
@@ -0,0 +1,100 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SlidingDFT.h"
+
+// calculate all of the tracked bins directly from a complete window of samples
+void SlidingDFT::seed(const float* window, uint16_t window_size)
+{
+    for (uint8_t i = 0; i < SDFT_NUM_BINS; i++) {
+        seed_bin(i, window, window_size);
+    }
+    _seeded = true;
+}
+
+// calculate a single tracked bin directly from a complete window of samples
+void SlidingDFT::seed_bin(uint8_t idx, const float* window, uint16_t window_size)
+{
+    const float theta = 2.0f * M_PI * (_center_bin + idx - SDFT_NUM_BINS / 2) / window_size;
+    _twiddle_re[idx] = cosf(theta);
+    _twiddle_im[idx] = sinf(theta);
+
+    // X[k] = sum(x[n] * e^(-j * theta * n)), rotating the phasor rather than evaluating it for every sample
+    float re = 0.0f, im = 0.0f;
+    float phasor_re = 1.0f, phasor_im = 0.0f;
+    for (uint16_t n = 0; n < window_size; n++) {
+        re += window[n] * phasor_re;
+        im += window[n] * phasor_im;
+        const float r = phasor_re * _twiddle_re[idx] + phasor_im * _twiddle_im[idx];
+        phasor_im = phasor_im * _twiddle_re[idx] - phasor_re * _twiddle_im[idx];
+        phasor_re = r;
+    }
+    _re[idx] = re;
+    _im[idx] = im;
+}
+
+// power of a tracked bin after applying the Hanning window, which is a three-tap convolution in the frequency domain
+float SlidingDFT::windowed_power(uint8_t idx) const
+{
+    const float re = 0.5f * _re[idx] - 0.25f * (_re[idx - 1] + _re[idx + 1]);
+    const float im = 0.5f * _im[idx] - 0.25f * (_im[idx - 1] + _im[idx + 1]);
+    return sq(re) + sq(im);
+}
+
+// follow the peak into a neighbouring bin if required and return its interpolated position in bins
+float SlidingDFT::find_peak(const float* window, uint16_t window_size, uint16_t min_bin, uint16_t max_bin, float& power)
+{
+    const uint8_t c = SDFT_NUM_BINS / 2;
+    float lower = windowed_power(c - 1);
+    float center = windowed_power(c);
+    float upper = windowed_power(c + 1);
+
+    // the peak has moved into a neighbouring bin, shift the tracked bins along and calculate the new outer bin directly
+    if (lower > center && lower >= upper && _center_bin > min_bin) {
+        for (uint8_t i = SDFT_NUM_BINS - 1; i > 0; i--) {
+            _re[i] = _re[i - 1];
+            _im[i] = _im[i - 1];
+            _twiddle_re[i] = _twiddle_re[i - 1];
+            _twiddle_im[i] = _twiddle_im[i - 1];
+        }
+        _center_bin--;
+        seed_bin(0, window, window_size);
+    } else if (upper > center && upper > lower && _center_bin < max_bin) {
+        for (uint8_t i = 0; i < SDFT_NUM_BINS - 1; i++) {
+            _re[i] = _re[i + 1];
+            _im[i] = _im[i + 1];
+            _twiddle_re[i] = _twiddle_re[i + 1];
+            _twiddle_im[i] = _twiddle_im[i + 1];
+        }
+        _center_bin++;
+        seed_bin(SDFT_NUM_BINS - 1, window, window_size);
+    }
+
+    lower = windowed_power(c - 1);
+    center = windowed_power(c);
+    upper = windowed_power(c + 1);
+    power = center;
+
+    // interpolate the peak using the Hanning window magnitude estimator
+    const float mag_lower = sqrtf(lower);
+    const float mag_center = sqrtf(center);
+    const float mag_upper = sqrtf(upper);
+    const float divider = mag_lower + 2.0f * mag_center + mag_upper;
+    if (is_zero(divider)) {
+        return _center_bin;
+    }
+
+    return _center_bin + constrain_float(2.0f * (mag_upper - mag_lower) / divider, -0.5f, 0.5f);
+}
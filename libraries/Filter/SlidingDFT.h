@@ -0,0 +1,61 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  sliding DFT over the handful of bins around a tracked noise peak,
+  advanced one sample at a time. Used by AP_GyroFFT to follow a peak
+  found by the FFT between FFT frames
+  see https://www.comm.utoronto.ca/~dimitris/ece431/slidingdft.pdf
+ */
+class SlidingDFT {
+public:
+    SlidingDFT() { }
+
+    // track the bins around center_bin, the bins are seeded from the next window
+    void reset(uint16_t center_bin) { _center_bin = center_bin; _seeded = false; }
+    uint16_t get_center_bin() const { return _center_bin; }
+    bool is_seeded() const { return _seeded; }
+    // calculate the tracked bins directly from a complete window of samples
+    void seed(const float* window, uint16_t window_size);
+    // slide the window along by one sample
+    void update(float oldest, float newest) {
+        const float delta = newest - oldest;
+        for (uint8_t i = 0; i < SDFT_NUM_BINS; i++) {
+            const float re = _re[i] + delta;
+            _re[i] = re * _twiddle_re[i] - _im[i] * _twiddle_im[i];
+            _im[i] = re * _twiddle_im[i] + _im[i] * _twiddle_re[i];
+        }
+    }
+    // follow the peak into a neighbouring bin if required and return its interpolated position in bins
+    float find_peak(const float* window, uint16_t window_size, uint16_t min_bin, uint16_t max_bin, float& power);
+
+private:
+    // the center bin plus two either side, enough to apply the Hanning window to the center bin and its neighbours
+    static const uint8_t SDFT_NUM_BINS = 5;
+    // calculate a single tracked bin directly from a complete window of samples
+    void seed_bin(uint8_t idx, const float* window, uint16_t window_size);
+    // power of a tracked bin after applying the Hanning window in the frequency domain
+    float windowed_power(uint8_t idx) const;
+
+    float _re[SDFT_NUM_BINS];
+    float _im[SDFT_NUM_BINS];
+    float _twiddle_re[SDFT_NUM_BINS];
+    float _twiddle_im[SDFT_NUM_BINS];
+    uint16_t _center_bin;
+    bool _seeded;
+};
@@ -0,0 +1,174 @@
+#include <AP_gtest.h>
+
+#include <Filter/Filter.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/HarmonicNotchFilter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  return the peak output of a notch filter over the last second of a
+  two second unit amplitude sine wave
+ */
+static float notch_peak_output(NotchFilterFloat &filter, float sample_freq, float test_freq)
+{
+    float peak = 0;
+    const uint32_t samples = 2 * sample_freq;
+    for (uint32_t i = 0; i < samples; i++) {
+        const float input = sinf(2 * M_PI * test_freq * i / sample_freq);
+        const float output = filter.apply(input);
+        if (i >= samples/2) {
+            peak = MAX(peak, fabsf(output));
+        }
+    }
+    return peak;
+}
+
+TEST(NotchFilterTest, Attenuation)
+{
+    const float sample_freq = 1000;
+    NotchFilterFloat filter {};
+
+    // 40dB attenuation at the center frequency
+    filter.init(sample_freq, 80, 20, 40);
+    EXPECT_NEAR(0.01, notch_peak_output(filter, sample_freq, 80), 0.005);
+
+    // frequencies well away from the notch pass unchanged
+    filter.reset();
+    EXPECT_NEAR(1.0, notch_peak_output(filter, sample_freq, 10), 0.01);
+    filter.reset();
+    EXPECT_NEAR(1.0, notch_peak_output(filter, sample_freq, 250), 0.01);
+}
+
+TEST(NotchFilterTest, Uninitialised)
+{
+    NotchFilterFloat filter {};
+    filter.init(1000, 0, 20, 40);
+    EXPECT_FLOAT_EQ(0.5, filter.apply(0.5));
+    EXPECT_FLOAT_EQ(-0.25, filter.apply(-0.25));
+}
+
+/*
+  a harmonic notch built from scalar notch filters, one chain per axis
+ */
+class ScalarHarmonicNotch {
+public:
+    NotchFilterFloat filters[3][HNF_MAX_HARMONICS*2];
+    uint8_t num_filters;
+
+    // set the chain to notches at the given centers, keeping the
+    // state of each stage as the harmonic notch does
+    void update(float sample_freq, const float centers[], uint8_t num_centers, float A, float Q) {
+        num_filters = num_centers;
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            for (uint8_t i = 0; i < num_centers; i++) {
+                filters[axis][i].init_with_A_and_Q(sample_freq, centers[i], A, Q);
+            }
+        }
+    }
+    Vector3f apply(const Vector3f &sample) {
+        Vector3f output = sample;
+        for (uint8_t i = 0; i < num_filters; i++) {
+            output.x = filters[0][i].apply(output.x);
+            output.y = filters[1][i].apply(output.y);
+            output.z = filters[2][i].apply(output.z);
+        }
+        return output;
+    }
+};
+
+/*
+  a signal with different content on each axis, near to the notches
+ */
+static Vector3f test_sample(uint32_t i, float sample_freq)
+{
+    const float t = i / sample_freq;
+    return Vector3f(sinf(2 * M_PI * 80 * t) + 0.3 * sinf(2 * M_PI * 7 * t),
+                    0.5 * sinf(2 * M_PI * 165 * t) + cosf(2 * M_PI * 240 * t),
+                    sinf(2 * M_PI * 310 * t) - 0.2);
+}
+
+static void expect_same_output(HarmonicNotchFilterVector3f &harmonic, ScalarHarmonicNotch &scalar,
+                               float sample_freq, uint32_t &sample)
+{
+    for (uint32_t n = 0; n < 500; n++, sample++) {
+        const Vector3f input = test_sample(sample, sample_freq);
+        const Vector3f expected = scalar.apply(input);
+        const Vector3f output = harmonic.apply(input);
+        EXPECT_NEAR(expected.x, output.x, 1e-5) << "sample " << sample;
+        EXPECT_NEAR(expected.y, output.y, 1e-5) << "sample " << sample;
+        EXPECT_NEAR(expected.z, output.z, 1e-5) << "sample " << sample;
+    }
+}
+
+/*
+  the harmonic notch filters all axes through one cascade, which must
+  give the same output as separate scalar notch filters on each axis,
+  including when the notches move and some go above nyquist
+ */
+TEST(NotchFilterTest, HarmonicMatchesScalar)
+{
+    const float sample_freq = 1000;
+    const float bandwidth = 40;
+    const float attenuation = 40;
+
+    // single notches on the first four harmonics
+    {
+        HarmonicNotchFilterVector3f harmonic {};
+        harmonic.allocate_filters(0x0F, false);
+        harmonic.init(sample_freq, 80, bandwidth, attenuation);
+
+        float A, Q;
+        NotchFilterFloat::calculate_A_and_Q(80, bandwidth, attenuation, A, Q);
+        ScalarHarmonicNotch scalar {};
+        const float centers[] { 80, 160, 240, 320 };
+        scalar.update(sample_freq, centers, 4, A, Q);
+
+        uint32_t sample = 0;
+        expect_same_output(harmonic, scalar, sample_freq, sample);
+
+        // the fourth harmonic is now above the limit of 480Hz
+        harmonic.update(150);
+        const float centers2[] { 150, 300, 450 };
+        scalar.update(sample_freq, centers2, 3, A, Q);
+        expect_same_output(harmonic, scalar, sample_freq, sample);
+
+        // individually placed notches
+        const float dynamic[] { 95, 170, 260 };
+        harmonic.update(3, dynamic);
+        scalar.update(sample_freq, dynamic, 3, A, Q);
+        expect_same_output(harmonic, scalar, sample_freq, sample);
+    }
+
+    // double notches on the first three harmonics
+    {
+        HarmonicNotchFilterVector3f harmonic {};
+        harmonic.allocate_filters(0x07, true);
+        harmonic.init(sample_freq, 80, bandwidth, attenuation);
+
+        float A, Q;
+        NotchFilterFloat::calculate_A_and_Q(80, bandwidth * 0.5, attenuation, A, Q);
+        const float spread = bandwidth / (32 * 80);
+        float centers[6];
+        for (uint8_t i = 0; i < 3; i++) {
+            centers[i*2] = 80 * (i+1) * (1.0 - spread);
+            centers[i*2+1] = 80 * (i+1) * (1.0 + spread);
+        }
+        ScalarHarmonicNotch scalar {};
+        scalar.update(sample_freq, centers, 6, A, Q);
+
+        uint32_t sample = 0;
+        expect_same_output(harmonic, scalar, sample_freq, sample);
+
+        // reset clears the state of every stage
+        harmonic.reset();
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            for (uint8_t i = 0; i < 6; i++) {
+                scalar.filters[axis][i].reset();
+            }
+        }
+        expect_same_output(harmonic, scalar, sample_freq, sample);
+    }
+}
+
+AP_GTEST_MAIN()
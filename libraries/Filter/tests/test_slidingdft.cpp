@@ -0,0 +1,180 @@
+#include <AP_gtest.h>
+
+#include <Filter/SlidingDFT.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t window_size = 64;
+static const uint16_t min_bin = 2;
+static const uint16_t max_bin = window_size / 2 - 2;
+
+/*
+  power of every bin of a Hanning windowed DFT, the reference the
+  sliding DFT is checked against
+ */
+static void full_dft_power(const float *window, double *power)
+{
+    for (uint16_t k = 0; k <= window_size / 2; k++) {
+        double re = 0, im = 0;
+        for (uint16_t n = 0; n < window_size; n++) {
+            const double w = 0.5 - 0.5 * cos(2 * M_PI * n / window_size);
+            const double theta = 2 * M_PI * k * n / window_size;
+            re += window[n] * w * cos(theta);
+            im -= window[n] * w * sin(theta);
+        }
+        power[k] = re * re + im * im;
+    }
+}
+
+static uint16_t full_dft_peak(const double *power)
+{
+    uint16_t peak = min_bin;
+    for (uint16_t k = min_bin; k <= max_bin; k++) {
+        if (power[k] > power[peak]) {
+            peak = k;
+        }
+    }
+    return peak;
+}
+
+/*
+  a tone, in bins of the window, whose frequency can be stepped while
+  keeping the phase continuous
+ */
+class TestTone {
+public:
+    TestTone(float bin) : _bin(bin), _phase(0) {}
+    void set_bin(float bin) { _bin = bin; }
+    float next() {
+        const float sample = sinf(_phase) + 0.1f;
+        _phase = wrap_2PI(_phase + 2 * M_PI * _bin / window_size);
+        return sample;
+    }
+
+private:
+    float _bin;
+    float _phase;
+};
+
+/*
+  gyro samples in a ring as the FFT sees them, copied out oldest first
+  for the sliding DFT
+ */
+class TestRing {
+public:
+    void push(float sample) {
+        _samples[_next] = sample;
+        _next = (_next + 1) % window_size;
+    }
+    float oldest() const { return _samples[_next]; }
+    void copy(float *window) const {
+        for (uint16_t i = 0; i < window_size; i++) {
+            window[i] = _samples[(_next + i) % window_size];
+        }
+    }
+
+private:
+    float _samples[window_size];
+    uint16_t _next;
+};
+
+// a freshly seeded window gives the same power as the full DFT
+TEST(SlidingDFTTest, Seed)
+{
+    TestTone tone {10.3f};
+    float window[window_size];
+    for (uint16_t i = 0; i < window_size; i++) {
+        window[i] = tone.next();
+    }
+    double power[window_size / 2 + 1];
+    full_dft_power(window, power);
+
+    SlidingDFT sdft {};
+    sdft.reset(10);
+    sdft.seed(window, window_size);
+    float peak_power;
+    const float peak_bin = sdft.find_peak(window, window_size, min_bin, max_bin, peak_power);
+
+    EXPECT_EQ(sdft.get_center_bin(), full_dft_peak(power));
+    EXPECT_NEAR(power[10], peak_power, power[10] * 1.0e-4);
+    EXPECT_NEAR(10.3f, peak_bin, 0.1f);
+}
+
+// sliding the window many times over, with the ring wrapping around,
+// keeps matching the full DFT of the current window
+TEST(SlidingDFTTest, Slide)
+{
+    TestTone tone {10.3f};
+    TestRing ring {};
+    float window[window_size];
+    for (uint16_t i = 0; i < window_size; i++) {
+        ring.push(tone.next());
+    }
+    ring.copy(window);
+
+    SlidingDFT sdft {};
+    sdft.reset(10);
+    sdft.seed(window, window_size);
+
+    const uint16_t hop = window_size / 4;
+    for (uint16_t i = 0; i < 8 * window_size / hop; i++) {
+        for (uint16_t j = 0; j < hop; j++) {
+            const float oldest = ring.oldest();
+            const float newest = tone.next();
+            ring.push(newest);
+            sdft.update(oldest, newest);
+        }
+        ring.copy(window);
+        double power[window_size / 2 + 1];
+        full_dft_power(window, power);
+
+        float peak_power;
+        const float peak_bin = sdft.find_peak(window, window_size, min_bin, max_bin, peak_power);
+        ASSERT_EQ(sdft.get_center_bin(), 10U);
+        EXPECT_NEAR(power[10], peak_power, power[10] * 1.0e-3) << "hop " << i;
+        EXPECT_NEAR(10.3f, peak_bin, 0.1f) << "hop " << i;
+    }
+}
+
+// when the tone moves the tracked bins follow it, one bin per output,
+// and end up on the peak of the full DFT
+TEST(SlidingDFTTest, FollowPeak)
+{
+    for (const float end_bin : { 13.2f, 7.4f }) {
+        TestTone tone {10.3f};
+        TestRing ring {};
+        float window[window_size];
+        for (uint16_t i = 0; i < window_size; i++) {
+            ring.push(tone.next());
+        }
+        ring.copy(window);
+
+        SlidingDFT sdft {};
+        sdft.reset(10);
+        sdft.seed(window, window_size);
+
+        tone.set_bin(end_bin);
+        const uint16_t hop = window_size / 4;
+        double power[window_size / 2 + 1];
+        float peak_power;
+        float peak_bin = 0;
+        for (uint16_t i = 0; i < 4 * window_size / hop; i++) {
+            for (uint16_t j = 0; j < hop; j++) {
+                const float oldest = ring.oldest();
+                const float newest = tone.next();
+                ring.push(newest);
+                sdft.update(oldest, newest);
+            }
+            ring.copy(window);
+            peak_bin = sdft.find_peak(window, window_size, min_bin, max_bin, peak_power);
+        }
+        full_dft_power(window, power);
+
+        const uint16_t bin = sdft.get_center_bin();
+        EXPECT_EQ(bin, full_dft_peak(power)) << "end " << end_bin;
+        EXPECT_NEAR(power[bin], peak_power, power[bin] * 1.0e-3) << "end " << end_bin;
+        EXPECT_NEAR(end_bin, peak_bin, 0.1f) << "end " << end_bin;
+    }
+}
+
+AP_GTEST_MAIN()
@@ -211,6 +211,34 @@ void Aircraft::time_advance()
     if (use_time_sync) {
         sync_frame_time();
     }
+    if (speedup_report_interval_us != 0) {
+        report_speedup();
+    }
+}
+
+/*
+  report simulated seconds per wall clock second, in total and over the
+  last interval, in a form easily parsed by test farm runners
+ */
+void Aircraft::report_speedup(void)
+{
+    const uint64_t now_wall_us = get_wall_time_us();
+    if (speedup_report_start_wall_us == 0) {
+        speedup_report_start_wall_us = last_speedup_report_wall_us = now_wall_us;
+        speedup_report_start_sim_us = last_speedup_report_sim_us = time_now_us;
+        return;
+    }
+    const uint64_t dt_wall_us = now_wall_us - last_speedup_report_wall_us;
+    if (dt_wall_us < speedup_report_interval_us) {
+        return;
+    }
+    const double sim_s = (time_now_us - speedup_report_start_sim_us) * 1.0e-6;
+    const double wall_s = (now_wall_us - speedup_report_start_wall_us) * 1.0e-6;
+    const double interval_speedup = double(time_now_us - last_speedup_report_sim_us) / dt_wall_us;
+    ::printf("SITL speedup: sim=%.3fs wall=%.3fs speedup=%.2f last=%.2f\n",
+             sim_s, wall_s, sim_s / wall_s, interval_speedup);
+    last_speedup_report_wall_us = now_wall_us;
+    last_speedup_report_sim_us = time_now_us;
 }
 
 /* setup the frame step time */
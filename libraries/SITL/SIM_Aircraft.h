@@ -52,6 +52,19 @@ public:
     void set_speedup(float speedup);
     float get_speedup() const { return target_speedup; }
 
+    /*
+      run free of the wall clock, stepping as fast as the host allows
+     */
+    void set_free_run(void) { use_time_sync = false; }
+
+    /*
+      print the achieved simulated seconds per wall second every
+      interval_s wall clock seconds
+     */
+    void set_speedup_report(float interval_s) {
+        speedup_report_interval_us = interval_s * 1.0e6f;
+    }
+
     /*
       set instance number
      */
@@ -267,6 +280,9 @@ protected:
        into account desired speedup */
     void sync_frame_time(void);
 
+    /* print achieved speedup if enabled with set_speedup_report() */
+    void report_speedup(void);
+
     /* add noise based on throttle level (from 0..1) */
     void add_noise(float throttle);
 
@@ -298,6 +314,13 @@ protected:
 
 private:
     uint64_t last_time_us;
+
+    // achieved speedup reporting
+    uint64_t speedup_report_interval_us;
+    uint64_t speedup_report_start_wall_us;
+    uint64_t speedup_report_start_sim_us;
+    uint64_t last_speedup_report_wall_us;
+    uint64_t last_speedup_report_sim_us;
     uint32_t frame_counter;
     uint32_t last_ground_contact_ms;
 #if defined(__CYGWIN__) || defined(__CYGWIN64__)
@@ -62,7 +62,11 @@ JSON::JSON(const char *frame_str) :
 
     const char *colon = strchr(frame_str, ':');
     if (colon) {
-        target_ip = colon+1;
+        if (strcmp(colon+1, "shm") == 0) {
+            use_shm = true;
+        } else {
+            target_ip = colon+1;
+        }
     }
 
     for (uint8_t i=0; i<ARRAY_SIZE(sim_defaults); i++) {
@@ -90,6 +94,18 @@ void JSON::set_interface_ports(const char* address, const int port_in, const int
     }
     control_port = port_out;
 
+    if (use_shm) {
+        // the port keeps the name unique per instance
+        char name[32];
+        snprintf(name, sizeof(name), "/ardupilot_json_%u", control_port);
+        if (shm.open(name, SharedMemoryLink::Role::AUTOPILOT)) {
+            printf("JSON control interface set to shared memory %s\n", name);
+            return;
+        }
+        printf("JSON shared memory unavailable, falling back to UDP\n");
+        use_shm = false;
+    }
+
     printf("JSON control interface set to %s:%u\n", target_ip, control_port);
 }
 
@@ -105,6 +121,13 @@ void JSON::output_servos(const struct sitl_input &input)
         pkt.pwm[i] = input.servos[i];
     }
 
+    if (use_shm) {
+        // fails until the simulator drains the link, which is fine as
+        // servos are resent while we wait for sensor data
+        shm.send(&pkt, sizeof(pkt));
+        return;
+    }
+
     size_t send_ret = sock.sendto(&pkt, sizeof(pkt), target_ip, control_port);
     if (send_ret != sizeof(pkt)) {
         if (send_ret <= 0) {
@@ -200,10 +223,10 @@ uint16_t JSON::parse_sensors(const char *json)
 }
 
 /*
-    Receive new sensor data from simulator
-    This is a blocking function
+    Receive a line of JSON sensor data over UDP into state
+    Returns the bitmask of the fields received, or 0 if there is no complete line
 */
-void JSON::recv_fdm(const struct sitl_input &input)
+uint16_t JSON::recv_json(const struct sitl_input &input)
 {
     // Receive sensor packet
     ssize_t ret = sock.recv(&sensor_buffer[sensor_buffer_len], sizeof(sensor_buffer)-sensor_buffer_len, UDP_TIMEOUT_MS);
@@ -228,18 +251,80 @@ void JSON::recv_fdm(const struct sitl_input &input)
 
     const uint8_t *p2 = (const uint8_t *)memrchr(sensor_buffer, 0, sensor_buffer_len);
     if (p2 == nullptr || p2 == sensor_buffer) {
-        return;
+        return 0;
     }
 
     const uint8_t *p1 = (const uint8_t *)memrchr(sensor_buffer, 0, p2 - sensor_buffer);
     if (p1 == nullptr) {
-        return;
+        return 0;
     }
 
     const uint16_t received_bitmask = parse_sensors((const char *)(p1+1));
+
+    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
+    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
+
     if (received_bitmask == 0) {
         // did not receve one of the mandatory fields
         printf("Did not contain all mandatory fields\n");
+    }
+    return received_bitmask;
+}
+
+/*
+    Receive a binary sensor packet over shared memory into state
+    Returns the bitmask of the fields received, or 0 on a bad packet
+*/
+uint16_t JSON::recv_shm(const struct sitl_input &input)
+{
+    fdm_packet pkt;
+    ssize_t ret = shm.recv(&pkt, sizeof(pkt), UDP_TIMEOUT_MS);
+    uint32_t wait_ms = UDP_TIMEOUT_MS;
+    while (ret < 0) {
+        ret = shm.recv(&pkt, sizeof(pkt), UDP_TIMEOUT_MS);
+        wait_ms += UDP_TIMEOUT_MS;
+        // as for UDP, resend servos in case the simulator has restarted
+        if (wait_ms > 1000) {
+            wait_ms = 0;
+            printf("No JSON sensor message received, resending servos\n");
+            output_servos(input);
+        }
+    }
+
+    if (ret != sizeof(pkt) || pkt.magic != FDM_PACKET_MAGIC) {
+        printf("Bad JSON shared memory packet of %ld bytes\n", (long)ret);
+        return 0;
+    }
+
+    const uint16_t required = TIMESTAMP | GYRO | ACCEL_BODY | POSITION | VELOCITY;
+    if ((pkt.fields & required) != required) {
+        printf("Did not contain all mandatory fields\n");
+        return 0;
+    }
+
+    state.timestamp_s = pkt.timestamp_s;
+    state.imu.gyro = Vector3f(pkt.gyro[0], pkt.gyro[1], pkt.gyro[2]);
+    state.imu.accel_body = Vector3f(pkt.accel_body[0], pkt.accel_body[1], pkt.accel_body[2]);
+    state.position = Vector3f(pkt.position[0], pkt.position[1], pkt.position[2]);
+    state.attitude = Vector3f(pkt.attitude[0], pkt.attitude[1], pkt.attitude[2]);
+    state.quaternion = Quaternion(pkt.quaternion[0], pkt.quaternion[1], pkt.quaternion[2], pkt.quaternion[3]);
+    state.velocity = Vector3f(pkt.velocity[0], pkt.velocity[1], pkt.velocity[2]);
+    memcpy(state.rng, pkt.rng, sizeof(state.rng));
+    state.wind_vane_apparent.direction = pkt.windvane_direction;
+    state.wind_vane_apparent.speed = pkt.windvane_speed;
+    state.airspeed = pkt.airspeed;
+
+    return pkt.fields;
+}
+
+/*
+    Receive new sensor data from simulator
+    This is a blocking function
+*/
+void JSON::recv_fdm(const struct sitl_input &input)
+{
+    const uint16_t received_bitmask = use_shm ? recv_shm(input) : recv_json(input);
+    if (received_bitmask == 0) {
         return;
     }
 
@@ -267,9 +352,6 @@ void JSON::recv_fdm(const struct sitl_input &input)
     }
     last_received_bitmask = received_bitmask;
 
-    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
-    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
-
     accel_body = state.imu.accel_body;
     gyro = state.imu.gyro;
     velocity_ef = state.velocity;
@@ -16,6 +16,7 @@
 
 #include <AP_HAL/utility/Socket.h>
 #include "SIM_Aircraft.h"
+#include "SIM_SharedMemory.h"
 
 namespace SITL {
 
@@ -43,6 +44,24 @@ private:
         uint16_t pwm[16];
     };
 
+    // binary sensor data used over the shared memory link
+    struct PACKED fdm_packet {
+        uint16_t magic;         // FDM_PACKET_MAGIC
+        uint16_t fields;        // DataKey bitmask of the fields present
+        double timestamp_s;
+        float gyro[3];
+        float accel_body[3];
+        float position[3];
+        float attitude[3];
+        float quaternion[4];
+        float velocity[3];
+        float rng[6];
+        float windvane_direction;
+        float windvane_speed;
+        float airspeed;
+    };
+    static const uint16_t FDM_PACKET_MAGIC = 29569;
+
     // default connection_info_.ip_address
     const char *target_ip = "127.0.0.1";
 
@@ -51,11 +70,17 @@ private:
 
     SocketAPM sock;
 
+    // used instead of sock with a model of JSON:shm
+    SharedMemoryLink shm;
+    bool use_shm;
+
     uint32_t frame_counter;
     double last_timestamp_s;
 
     void output_servos(const struct sitl_input &input);
     void recv_fdm(const struct sitl_input &input);
+    uint16_t recv_json(const struct sitl_input &input);
+    uint16_t recv_shm(const struct sitl_input &input);
 
     uint16_t parse_sensors(const char *json);
 
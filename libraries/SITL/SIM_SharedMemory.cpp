@@ -0,0 +1,192 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  shared memory link between SITL and a physics simulator
+*/
+
+#include "SIM_SharedMemory.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace SITL;
+
+// number of polls of the ring before sleeping on the futex
+#define SPIN_COUNT 2000
+
+bool SharedMemoryLink::open(const char *name, Role role)
+{
+    close();
+
+    _owner = (role == Role::AUTOPILOT);
+    snprintf(_name, sizeof(_name), "%s", name);
+
+    int fd = shm_open(_name, _owner ? O_RDWR | O_CREAT : O_RDWR, 0600);
+    if (fd == -1) {
+        printf("SharedMemoryLink: shm_open(%s) failed: %s\n", _name, strerror(errno));
+        return false;
+    }
+    if (_owner && ftruncate(fd, sizeof(Layout)) == -1) {
+        printf("SharedMemoryLink: ftruncate(%s) failed: %s\n", _name, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        printf("SharedMemoryLink: mmap(%s) failed: %s\n", _name, strerror(errno));
+        return false;
+    }
+    Layout *layout = (Layout *)p;
+
+    if (_owner) {
+        // start from empty rings. Nothing tells a simulator still
+        // attached from a previous run about this, it has to open the
+        // link again to get back in step
+        memset(p, 0, sizeof(Layout));
+        layout->version = VERSION;
+        std::atomic_thread_fence(std::memory_order_release);
+        layout->magic = MAGIC;
+    } else if (layout->magic != MAGIC || layout->version != VERSION) {
+        printf("SharedMemoryLink: %s is not a version %u link\n", _name, unsigned(VERSION));
+        munmap(p, sizeof(Layout));
+        return false;
+    }
+
+    _layout = layout;
+    _tx = _owner ? &layout->to_simulator : &layout->to_autopilot;
+    _rx = _owner ? &layout->to_autopilot : &layout->to_simulator;
+    return true;
+}
+
+void SharedMemoryLink::close()
+{
+    if (_layout == nullptr) {
+        return;
+    }
+    munmap(_layout, sizeof(Layout));
+    if (_owner) {
+        shm_unlink(_name);
+    }
+    _layout = nullptr;
+    _tx = nullptr;
+    _rx = nullptr;
+}
+
+bool SharedMemoryLink::send(const void *data, uint16_t len)
+{
+    if (_tx == nullptr || len > MAX_RECORD) {
+        return false;
+    }
+    const uint32_t head = _tx->head.load(std::memory_order_relaxed);
+    if (head - _tx->tail.load(std::memory_order_acquire) >= NUM_SLOTS) {
+        return false;
+    }
+
+    Slot &slot = _tx->slots[head % NUM_SLOTS];
+    memcpy(slot.data, data, len);
+    slot.len = len;
+
+    // the store of head and the load of reader_waiting must not be
+    // reordered against the reader's store of reader_waiting and
+    // re-check of head, or a wakeup can be lost
+    _tx->head.store(head + 1, std::memory_order_seq_cst);
+    if (_tx->reader_waiting.load(std::memory_order_seq_cst)) {
+        _wake(*_tx);
+    }
+    return true;
+}
+
+ssize_t SharedMemoryLink::recv(void *data, uint16_t maxlen, uint32_t timeout_ms)
+{
+    if (_rx == nullptr) {
+        return -1;
+    }
+    const uint32_t tail = _rx->tail.load(std::memory_order_relaxed);
+
+    uint32_t head = _rx->head.load(std::memory_order_acquire);
+    for (uint16_t i = 0; head == tail && i < SPIN_COUNT; i++) {
+        head = _rx->head.load(std::memory_order_acquire);
+    }
+
+    if (head == tail) {
+        struct timespec start, now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (true) {
+            _rx->reader_waiting.store(1, std::memory_order_seq_cst);
+            head = _rx->head.load(std::memory_order_seq_cst);
+            if (head != tail) {
+                break;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            const int64_t elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 +
+                (now.tv_nsec - start.tv_nsec) / 1000000;
+            if (elapsed_ms >= int64_t(timeout_ms)) {
+                break;
+            }
+            _wait(*_rx, head, timeout_ms - elapsed_ms);
+        }
+        _rx->reader_waiting.store(0, std::memory_order_relaxed);
+        if (head == tail) {
+            return -1;
+        }
+    }
+
+    const Slot &slot = _rx->slots[tail % NUM_SLOTS];
+    const uint16_t len = slot.len < maxlen ? slot.len : maxlen;
+    memcpy(data, slot.data, len);
+
+    _rx->tail.store(tail + 1, std::memory_order_release);
+    return len;
+}
+
+/*
+  sleep until head moves away from @head or the timeout expires
+ */
+void SharedMemoryLink::_wait(Ring &ring, uint32_t head, uint32_t timeout_ms)
+{
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+    // the word is shared with another process, so no FUTEX_PRIVATE_FLAG
+    syscall(SYS_futex, (uint32_t *)&ring.head, FUTEX_WAIT, head, &ts, nullptr, 0);
+#else
+    (void)ring;
+    (void)head;
+    (void)timeout_ms;
+    usleep(100);
+#endif
+}
+
+void SharedMemoryLink::_wake(Ring &ring)
+{
+#ifdef __linux__
+    syscall(SYS_futex, (uint32_t *)&ring.head, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)ring;
+#endif
+}
@@ -0,0 +1,106 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  shared memory link between SITL and a physics simulator on the same
+  machine.
+
+  The link is a POSIX shared memory object holding one single-producer
+  single-consumer ring of records in each direction. A reader with
+  nothing to read spins briefly and then sleeps on a futex, which the
+  writer only wakes when the reader is actually asleep, so a lock-step
+  exchange normally needs no system calls at all.
+
+  This file and SIM_SharedMemory.cpp only depend on the C++ standard
+  library and POSIX so that simulators can build them too.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace SITL {
+
+class SharedMemoryLink {
+public:
+    enum class Role {
+        // creates the link, sends servo outputs and receives FDM state
+        AUTOPILOT,
+        // attaches to the link, sends FDM state and receives servo outputs
+        SIMULATOR,
+    };
+
+    static const uint32_t MAGIC = 0x41505348; // "APSH"
+    static const uint32_t VERSION = 1;
+    static const uint16_t NUM_SLOTS = 8;
+    static const uint16_t MAX_RECORD = 1024;
+
+    ~SharedMemoryLink() { close(); }
+
+    /*
+      create or attach to the shared memory object @name, e.g.
+      "/ardupilot_json_9002"
+     */
+    bool open(const char *name, Role role);
+    void close();
+    bool is_open() const { return _layout != nullptr; }
+
+    /*
+      queue a record for the peer. Returns false if the record is too
+      large or the peer has not consumed NUM_SLOTS records
+     */
+    bool send(const void *data, uint16_t len);
+
+    /*
+      receive the next record from the peer into @data, waiting up to
+      @timeout_ms for one to arrive. Returns the record length, or -1 on
+      timeout. Records longer than @maxlen are truncated
+     */
+    ssize_t recv(void *data, uint16_t maxlen, uint32_t timeout_ms);
+
+private:
+    struct Slot {
+        uint16_t len;
+        uint8_t data[MAX_RECORD];
+    };
+
+    // counters are free running, each on its own cache line
+    struct Ring {
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        // set by a reader before it sleeps on head
+        alignas(64) std::atomic<uint32_t> reader_waiting;
+        alignas(64) Slot slots[NUM_SLOTS];
+    };
+
+    struct Layout {
+        uint32_t magic;
+        uint32_t version;
+        Ring to_simulator;
+        Ring to_autopilot;
+    };
+
+    static void _wait(Ring &ring, uint32_t head, uint32_t timeout_ms);
+    static void _wake(Ring &ring);
+
+    Layout *_layout = nullptr;
+    Ring *_tx = nullptr;
+    Ring *_rx = nullptr;
+    char _name[64];
+    bool _owner;
+};
+
+}
@@ -0,0 +1,260 @@
+#include <AP_gtest.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <SITL/SIM_SharedMemory.h>
+
+using namespace SITL;
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint32_t timeout_ms = 2000;
+
+/*
+  a link name unique to this test run, fixed before any simulator
+  process is forked
+ */
+static const char *link_name()
+{
+    static char name[64];
+    if (name[0] == '\0') {
+        snprintf(name, sizeof(name), "/ap_test_shm_%d", int(getpid()));
+    }
+    return name;
+}
+
+/*
+  a record of varying length with a sequence number and a pattern
+  depending on it, so that reordered, lost or torn records show up
+ */
+static uint16_t make_record(uint32_t seq, uint8_t *buf)
+{
+    const uint16_t len = sizeof(seq) + seq * 37 % (SharedMemoryLink::MAX_RECORD - sizeof(seq) + 1);
+    memcpy(buf, &seq, sizeof(seq));
+    for (uint16_t i = sizeof(seq); i < len; i++) {
+        buf[i] = uint8_t(seq + i);
+    }
+    return len;
+}
+
+static bool check_record(uint32_t seq, const uint8_t *buf, ssize_t len)
+{
+    uint8_t expected[SharedMemoryLink::MAX_RECORD];
+    const uint16_t expected_len = make_record(seq, expected);
+    return len == expected_len && memcmp(buf, expected, len) == 0;
+}
+
+static uint64_t now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+/*
+  run @fn in a child process attached as the simulator, returning its
+  pid. The child exits with status 0 if @fn returns true
+ */
+template <typename F>
+static pid_t run_simulator(F fn)
+{
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        SharedMemoryLink link;
+        const bool ok = link.open(link_name(), SharedMemoryLink::Role::SIMULATOR) && fn(link);
+        link.close();
+        fflush(stdout);
+        _exit(ok ? 0 : 1);
+    }
+    return pid;
+}
+
+static bool simulator_ok(pid_t pid)
+{
+    int status;
+    return pid > 0 && waitpid(pid, &status, 0) == pid &&
+        WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/*
+  stream records both ways through many laps of the rings, with each
+  side sometimes stalling so the other fills its ring or sleeps on the
+  futex
+ */
+TEST(SharedMemoryLink, Stream)
+{
+    const uint32_t num_records = 20000;
+
+    SharedMemoryLink link;
+    ASSERT_TRUE(link.open(link_name(), SharedMemoryLink::Role::AUTOPILOT));
+
+    const pid_t pid = run_simulator([](SharedMemoryLink &sim) {
+        uint8_t buf[SharedMemoryLink::MAX_RECORD];
+        for (uint32_t seq = 0; seq < num_records; seq++) {
+            const ssize_t len = sim.recv(buf, sizeof(buf), timeout_ms);
+            if (!check_record(seq, buf, len)) {
+                printf("simulator: bad record %u len %d\n", unsigned(seq), int(len));
+                return false;
+            }
+            if (seq % 1000 == 999) {
+                // let the autopilot fill the ring
+                usleep(20000);
+            }
+            // echo the record back
+            while (!sim.send(buf, len)) {
+                usleep(100);
+            }
+        }
+        return true;
+    });
+
+    uint8_t buf[SharedMemoryLink::MAX_RECORD];
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint32_t full = 0;
+    while (received < num_records) {
+        // send more than the simulator's ring holds
+        while (sent < num_records && sent - received < 2 * SharedMemoryLink::NUM_SLOTS) {
+            const uint16_t len = make_record(sent, buf);
+            if (!link.send(buf, len)) {
+                full++;
+                break;
+            }
+            sent++;
+        }
+        if (received % 1500 == 1499) {
+            // let the simulator sleep waiting for us
+            usleep(20000);
+        }
+        const ssize_t len = link.recv(buf, sizeof(buf), timeout_ms);
+        ASSERT_TRUE(check_record(received, buf, len)) << "record " << received;
+        received++;
+    }
+
+    EXPECT_TRUE(simulator_ok(pid));
+    // the autopilot found the ring full while the simulator stalled
+    EXPECT_GT(full, 0U);
+}
+
+/*
+  a full ring refuses records until the reader frees a slot, and a
+  reader asleep on the futex is woken by the next record rather than
+  timing out
+ */
+TEST(SharedMemoryLink, FullRing)
+{
+    SharedMemoryLink link;
+    ASSERT_TRUE(link.open(link_name(), SharedMemoryLink::Role::AUTOPILOT));
+
+    uint8_t buf[SharedMemoryLink::MAX_RECORD];
+    for (uint32_t seq = 0; seq < SharedMemoryLink::NUM_SLOTS; seq++) {
+        ASSERT_TRUE(link.send(buf, make_record(seq, buf)));
+    }
+    EXPECT_FALSE(link.send(buf, make_record(SharedMemoryLink::NUM_SLOTS, buf)));
+    // too large for a slot
+    EXPECT_FALSE(link.send(buf, SharedMemoryLink::MAX_RECORD + 1));
+
+    const pid_t pid = run_simulator([](SharedMemoryLink &sim) {
+        uint8_t rbuf[SharedMemoryLink::MAX_RECORD];
+        // free one slot and tell the autopilot
+        if (!check_record(0, rbuf, sim.recv(rbuf, sizeof(rbuf), timeout_ms))) {
+            return false;
+        }
+        const uint8_t freed = 1;
+        if (!sim.send(&freed, sizeof(freed))) {
+            return false;
+        }
+        // the rest arrive in order, including the one sent into the
+        // freed slot, and nothing else
+        for (uint32_t seq = 1; seq <= SharedMemoryLink::NUM_SLOTS; seq++) {
+            if (!check_record(seq, rbuf, sim.recv(rbuf, sizeof(rbuf), timeout_ms))) {
+                printf("simulator: bad record %u\n", unsigned(seq));
+                return false;
+            }
+        }
+        if (sim.recv(rbuf, sizeof(rbuf), 10) != -1) {
+            return false;
+        }
+        // sleep on the futex until the autopilot sends the last record
+        const uint8_t drained = 2;
+        if (!sim.send(&drained, sizeof(drained))) {
+            return false;
+        }
+        const uint64_t start_ms = now_ms();
+        if (sim.recv(rbuf, sizeof(rbuf), timeout_ms) != 1 || rbuf[0] != 3) {
+            return false;
+        }
+        return now_ms() - start_ms < timeout_ms / 2;
+    });
+
+    ASSERT_EQ(link.recv(buf, sizeof(buf), timeout_ms), 1);
+    EXPECT_EQ(buf[0], 1);
+    EXPECT_TRUE(link.send(buf, make_record(SharedMemoryLink::NUM_SLOTS, buf)));
+
+    ASSERT_EQ(link.recv(buf, sizeof(buf), timeout_ms), 1);
+    EXPECT_EQ(buf[0], 2);
+    // long past the reader's spin, so it is asleep
+    usleep(100000);
+    const uint8_t last = 3;
+    EXPECT_TRUE(link.send(&last, sizeof(last)));
+
+    EXPECT_TRUE(simulator_ok(pid));
+}
+
+/*
+  a simulator can detach and another attach in its place and carry on
+  where it left off, while re-creating the link starts from empty rings
+ */
+TEST(SharedMemoryLink, Reattach)
+{
+    SharedMemoryLink sim;
+    EXPECT_FALSE(sim.open(link_name(), SharedMemoryLink::Role::SIMULATOR));
+
+    SharedMemoryLink link;
+    ASSERT_TRUE(link.open(link_name(), SharedMemoryLink::Role::AUTOPILOT));
+
+    uint8_t buf[SharedMemoryLink::MAX_RECORD];
+    for (uint32_t seq = 0; seq < 4; seq++) {
+        ASSERT_TRUE(link.send(buf, make_record(seq, buf)));
+    }
+
+    // each simulator takes two records and replies with the next one
+    for (uint32_t first = 0; first < 4; first += 2) {
+        const pid_t pid = run_simulator([first](SharedMemoryLink &s) {
+            uint8_t rbuf[SharedMemoryLink::MAX_RECORD];
+            for (uint32_t seq = first; seq < first + 2; seq++) {
+                if (!check_record(seq, rbuf, s.recv(rbuf, sizeof(rbuf), timeout_ms))) {
+                    printf("simulator: bad record %u\n", unsigned(seq));
+                    return false;
+                }
+            }
+            return s.send(rbuf, make_record(first + 2, rbuf));
+        });
+        EXPECT_TRUE(simulator_ok(pid));
+        EXPECT_TRUE(check_record(first + 2, buf, link.recv(buf, sizeof(buf), timeout_ms)));
+    }
+
+    // records queued before the link is re-created are gone
+    ASSERT_TRUE(link.send(buf, make_record(100, buf)));
+    link.close();
+    ASSERT_TRUE(link.open(link_name(), SharedMemoryLink::Role::AUTOPILOT));
+    ASSERT_TRUE(link.send(buf, make_record(0, buf)));
+    const pid_t pid = run_simulator([](SharedMemoryLink &s) {
+        uint8_t rbuf[SharedMemoryLink::MAX_RECORD];
+        return check_record(0, rbuf, s.recv(rbuf, sizeof(rbuf), timeout_ms)) &&
+            s.recv(rbuf, sizeof(rbuf), 10) == -1;
+    });
+    EXPECT_TRUE(simulator_ok(pid));
+
+    // the link is removed when the autopilot closes it
+    link.close();
+    EXPECT_FALSE(sim.open(link_name(), SharedMemoryLink::Role::SIMULATOR));
+}
+
+AP_GTEST_MAIN()